@@ -0,0 +1,49 @@
+#include "../src/trig_plugin.h"
+
+// Example plugin: Bhaskara I's rational sine approximation and its error
+// against sinf, both folded into [0, 2pi) first. Build with tools.sh/tools.bat.
+
+#include <math.h>
+
+#define BHASKARA_PI 3.14159265358979323846f
+
+static float bhaskara_sin(float x) {
+    x = fmodf(x, 2 * BHASKARA_PI);
+    if (x < 0) {
+        x += 2 * BHASKARA_PI;
+    }
+    float sign = 1;
+    if (x > BHASKARA_PI) {
+        x -= BHASKARA_PI;
+        sign = -1;
+    }
+    float p = x * (BHASKARA_PI - x);
+    return sign * 16 * p / (5 * BHASKARA_PI * BHASKARA_PI - 4 * p);
+}
+
+static void bhaskara_sin_batch(const float *x, float *out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = bhaskara_sin(x[i]);
+    }
+}
+
+static void bhaskara_error_batch(const float *x, float *out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = (bhaskara_sin(x[i]) - sinf(x[i])) * 1000;
+    }
+}
+
+static const TrigPluginFunction bhaskara_functions[] = {
+    { "bhaskara", 0x00c0c0ff, -1, 1, bhaskara_sin_batch },
+    { "err x1000", 0xff4040ff, -2, 2, bhaskara_error_batch },
+};
+
+static const TrigPlugin bhaskara_plugin = {
+    .abi_version = TRIG_PLUGIN_ABI_VERSION,
+    .function_count = sizeof(bhaskara_functions) / sizeof(bhaskara_functions[0]),
+    .functions = bhaskara_functions,
+};
+
+TRIG_PLUGIN_EXPORT const TrigPlugin *trig_plugin_describe(void) {
+    return &bhaskara_plugin;
+}
@@ -51,6 +51,7 @@ gcc ^
     -lraylib ^
     -lopengl32 ^
     -lgdi32 ^
+    -lpthread ^
     -lwinmm
 if not %errorlevel% equ 0 (
     echo compilation of main.exe failed
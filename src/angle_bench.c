@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.c"
+#include "trig.c"
+
+// Compares the ways of turning a position into an angle around a center:
+// the asin/acos quadrant route the unit circle used to take, libm's atan2f,
+// and trig_angle (trig_atan2 wrapped to a full turn) one at a time and in
+// batches. Positions are pointer-like (whole pixels in a square around the
+// center, the center itself included) or sub-pixel sensor readings. One JSON
+// object per method is printed with the error against a double atan2 and
+// the best time of a few runs.
+
+#define ANGLE_BENCH_RUNS 5
+
+typedef enum AngleBenchMethod {
+    ANGLE_BENCH_LEGACY,
+    ANGLE_BENCH_ATAN2F,
+    ANGLE_BENCH_TRIG_ANGLE,
+    ANGLE_BENCH_TRIG_ANGLE_BATCH,
+    ANGLE_BENCH_METHOD_COUNT,
+} AngleBenchMethod;
+
+static const char *const angle_bench_method_names[ANGLE_BENCH_METHOD_COUNT] = {
+    "legacy", "atan2f", "trig_angle", "trig_angle_batch",
+};
+
+// The unit circle's previous angle resolution, kept as the baseline.
+static float angle_bench_legacy(float opp, float adj) {
+    const float hyp = sqrtf(powf(adj,2) + powf(opp,2));
+    const bool right = adj > 0;
+    const bool top = opp > 0;
+    if (top) {
+        return right ? asinf(opp/hyp) : (float)(TRIG_PI/2) + acosf(opp/hyp);
+    } else if (!right) {
+        return (float)TRIG_PI + asinf(-(opp/hyp));
+    }
+    return (float)(TRIG_PI*1.5) + acosf(-(opp/hyp));
+}
+
+static inline float angle_bench_wrap(float rad) {
+    return (rad < 0) ? rad + (float)(TRIG_PI*2) : rad;
+}
+
+static void angle_bench_run(AngleBenchMethod method, const float *opp, const float *adj, float *rad, int count) {
+    switch (method) {
+    case ANGLE_BENCH_LEGACY:
+        for (int i = 0; i < count; i++) {
+            rad[i] = angle_bench_legacy(opp[i], adj[i]);
+        }
+        break;
+    case ANGLE_BENCH_ATAN2F:
+        for (int i = 0; i < count; i++) {
+            rad[i] = angle_bench_wrap(atan2f(opp[i], adj[i]));
+        }
+        break;
+    case ANGLE_BENCH_TRIG_ANGLE:
+        for (int i = 0; i < count; i++) {
+            rad[i] = trig_angle(opp[i], adj[i]);
+        }
+        break;
+    default:
+        trig_angle_batch(opp, adj, rad, count);
+        break;
+    }
+}
+
+static void angle_bench_usage(const char *program) {
+    printf("%s [Options]\n", program);
+    printf("Options:\n");
+    printf("   -n <count>         positions (1000000)\n");
+    printf("   -r <radius>        half the side of the square around the center (400)\n");
+    printf("   -sensor            sub-pixel positions instead of whole pixels\n");
+    printf("   -seed <seed>       random seed (1)\n");
+}
+
+int main(int argc, char **argv) {
+    int count = 1000000;
+    double radius = 400;
+    bool sensor = false;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "-sensor") == 0) {
+            sensor = true;
+            continue;
+        }
+        if (value == NULL || strcmp(arg, "-h") == 0) {
+            angle_bench_usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "-n") == 0) {
+            count = atoi(value);
+        } else if (strcmp(arg, "-r") == 0) {
+            radius = atof(value);
+        } else if (strcmp(arg, "-seed") == 0) {
+            seed = (unsigned)strtoul(value, NULL, 10);
+        } else {
+            angle_bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (count < 1 || !(radius > 0)) {
+        angle_bench_usage(argv[0]);
+        return 1;
+    }
+
+    float *opp = malloc(sizeof(float) * (size_t)count);
+    float *adj = malloc(sizeof(float) * (size_t)count);
+    float *rad = malloc(sizeof(float) * (size_t)count);
+    srand(seed);
+    for (int i = 0; i < count; i++) {
+        double u = (rand() / (double)RAND_MAX * 2 - 1) * radius;
+        double v = (rand() / (double)RAND_MAX * 2 - 1) * radius;
+        adj[i] = (float)(sensor ? u : round(u));
+        opp[i] = (float)(sensor ? v : round(v));
+    }
+    // A pointer resting on the center, where the old route divided by zero.
+    adj[0] = 0;
+    opp[0] = 0;
+
+    for (int m = 0; m < ANGLE_BENCH_METHOD_COUNT; m++) {
+        double best = INFINITY;
+        for (int run = 0; run < ANGLE_BENCH_RUNS; run++) {
+            double start = platform_time_seconds();
+            angle_bench_run((AngleBenchMethod)m, opp, adj, rad, count);
+            double seconds = platform_time_seconds() - start;
+            best = (seconds < best) ? seconds : best;
+        }
+
+        double max_error = 0, sum_error = 0;
+        int nan_count = 0, compared = 0;
+        for (int i = 0; i < count; i++) {
+            if (adj[i] == 0 && opp[i] == 0) {
+                nan_count += isnan(rad[i]);
+                continue;
+            }
+            if (isnan(rad[i])) {
+                nan_count++;
+                continue;
+            }
+            double exact = atan2(opp[i], adj[i]);
+            double error = fabs(rad[i] - (exact + ((exact < 0) ? TRIG_PI*2 : 0)));
+            error = (error > TRIG_PI) ? TRIG_PI*2 - error : error;
+            max_error = (error > max_error) ? error : max_error;
+            sum_error += error;
+            compared++;
+        }
+        printf("{\"method\":\"%s\",\"positions\":%d,\"sensor\":%s", angle_bench_method_names[m], count, sensor ? "true" : "false");
+        printf(",\"max_error_rad\":%.3g,\"mean_error_rad\":%.3g", max_error, (compared > 0) ? sum_error / compared : 0.0);
+        printf(",\"nan_outputs\":%d,\"ns_per_position\":%.4f}\n", nan_count, best * 1e9 / count);
+    }
+    free(opp);
+    free(adj);
+    free(rad);
+    return 0;
+}
@@ -0,0 +1,565 @@
+#include "main.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+// Approximation lab: cheap sin/cos/tan kernels of the kind firmware uses,
+// overlaid on the built-in panels together with their error, and timed on a
+// background thread so a benchmark never stalls a frame.
+//
+// Every approximant only knows sin on [-pi/2, pi/2]. The argument is reduced
+// mod 2pi and folded into that interval in double, so the folding adds no
+// error of its own; cos(x) is sin(pi/2 - |x|) and tan is their quotient.
+
+#define APPROXIMANT_PI TRIG_PI
+#define APPROXIMANT_TABLE_MAX 4096
+#define APPROXIMANT_CORDIC_MAX 24
+#define APPROXIMANT_ERROR_DECADES 8 // error curves span 1e-8 (panel bottom) to 1 (top)
+#define APPROXIMANT_BENCH_SIZE 4096
+#define APPROXIMANT_BENCH_MAX_TIMINGS 64
+#define APPROXIMANT_BENCH_RUN_SECONDS 0.002
+#define APPROXIMANT_BENCH_RUNS 5
+#define APPROXIMANT_LABEL_SPACING 1.5f // between label lines, in small label offsets
+
+typedef struct ApproximantInfo {
+    const char *name;
+    int min_order;
+    int max_order;
+    int default_order;
+} ApproximantInfo;
+
+static const ApproximantInfo approximant_infos[APPROXIMANT_KIND_COUNT] = {
+    [APPROXIMANT_NONE] = { "none", 0, 0, 0 },
+    [APPROXIMANT_TAYLOR] = { "taylor", 1, 15, 7 },
+    [APPROXIMANT_BHASKARA] = { "bhaskara", 0, 0, 0 },
+    [APPROXIMANT_MINIMAX] = { "minimax", 3, 9, 5 },
+    [APPROXIMANT_TABLE] = { "table", 4, APPROXIMANT_TABLE_MAX, 64 },
+    [APPROXIMANT_CORDIC] = { "cordic", 1, APPROXIMANT_CORDIC_MAX, 12 },
+    [APPROXIMANT_CORDIC_Q15] = { "cordic q15", 1, CORDIC_Q15_ITERATIONS, CORDIC_Q15_ITERATIONS },
+    [APPROXIMANT_CORDIC_Q31] = { "cordic q31", 1, CORDIC_Q31_ITERATIONS, CORDIC_Q31_ITERATIONS },
+};
+
+// 1/(n(n+1)) for n = 2, 4, ..., the ratio of consecutive Taylor terms of sin.
+static const float approximant_taylor_ratios[] = {
+    1.0f/(2*3), 1.0f/(4*5), 1.0f/(6*7), 1.0f/(8*9), 1.0f/(10*11), 1.0f/(12*13), 1.0f/(14*15),
+};
+
+// Odd polynomials with the least absolute error against sin on [-pi/2, pi/2]
+// (Remez exchange), for degrees 3, 5, 7 and 9.
+static const float approximant_minimax_coefficients[4][5] = {
+    { 9.855295430e-01f, -1.425667265e-01f },
+    { 9.996967731e-01f, -1.656730793e-01f, 7.514377180e-03f },
+    { 9.999966159e-01f, -1.666482838e-01f, 8.306325227e-03f, -1.836365398e-04f },
+    { 9.999999766e-01f, -1.666664763e-01f, 8.332899823e-03f, -1.980089776e-04f, 2.590488501e-06f },
+};
+
+// atan(2^-i) and the gain prod 1/sqrt(1 + 2^-2j) for j <= i.
+static const float approximant_cordic_angles[APPROXIMANT_CORDIC_MAX] = {
+    7.853981634e-01f, 4.636476090e-01f, 2.449786631e-01f, 1.243549945e-01f, 6.241881000e-02f, 3.123983343e-02f,
+    1.562372862e-02f, 7.812341060e-03f, 3.906230132e-03f, 1.953122516e-03f, 9.765621896e-04f, 4.882812112e-04f,
+    2.441406201e-04f, 1.220703119e-04f, 6.103515617e-05f, 3.051757812e-05f, 1.525878906e-05f, 7.629394531e-06f,
+    3.814697266e-06f, 1.907348633e-06f, 9.536743164e-07f, 4.768371582e-07f, 2.384185791e-07f, 1.192092896e-07f,
+};
+static const float approximant_cordic_gains[APPROXIMANT_CORDIC_MAX] = {
+    7.071067812e-01f, 6.324555320e-01f, 6.135719911e-01f, 6.088339125e-01f, 6.076482563e-01f, 6.073517701e-01f,
+    6.072776441e-01f, 6.072591123e-01f, 6.072544793e-01f, 6.072533211e-01f, 6.072530315e-01f, 6.072529591e-01f,
+    6.072529410e-01f, 6.072529365e-01f, 6.072529354e-01f, 6.072529351e-01f, 6.072529350e-01f, 6.072529350e-01f,
+    6.072529350e-01f, 6.072529350e-01f, 6.072529350e-01f, 6.072529350e-01f, 6.072529350e-01f, 6.072529350e-01f,
+};
+
+// sin at APPROXIMANT_TABLE_MAX + 1 points over [0, pi/2]; a table of n
+// entries is every (APPROXIMANT_TABLE_MAX/n)th of them.
+static float approximant_sine_table[APPROXIMANT_TABLE_MAX + 1];
+static pthread_once_t approximant_sine_table_once = PTHREAD_ONCE_INIT;
+
+static void approximant_sine_table_build(void) {
+    for (int i = 0; i <= APPROXIMANT_TABLE_MAX; i++) {
+        approximant_sine_table[i] = (float)sin(APPROXIMANT_PI / 2 * i / APPROXIMANT_TABLE_MAX);
+    }
+}
+
+static float approximant_taylor(float r, int degree) {
+    float r2 = r * r;
+    float sum = 1;
+    for (int n = (degree - 1) / 2; n >= 1; n--) {
+        sum = 1 - r2 * approximant_taylor_ratios[n - 1] * sum;
+    }
+    return r * sum;
+}
+
+static float approximant_bhaskara(float r) {
+    float a = fabsf(r);
+    float p = a * ((float)APPROXIMANT_PI - a);
+    float s = 16 * p / (5 * (float)(APPROXIMANT_PI * APPROXIMANT_PI) - 4 * p);
+    return (r < 0) ? -s : s;
+}
+
+static float approximant_minimax(float r, int degree) {
+    const float *c = approximant_minimax_coefficients[(degree - 3) / 2];
+    float r2 = r * r;
+    float sum = 0;
+    for (int k = (degree - 1) / 2; k >= 0; k--) {
+        sum = sum * r2 + c[k];
+    }
+    return r * sum;
+}
+
+static float approximant_table(float r, int size) {
+    int stride = APPROXIMANT_TABLE_MAX / size;
+    float t = fabsf(r) * (float)(size / (APPROXIMANT_PI / 2));
+    int i = (int)t;
+    i = (i < 0) ? 0 : (i >= size) ? size - 1 : i; // NaN converts to INT_MIN
+    float low = approximant_sine_table[i * stride];
+    float high = approximant_sine_table[(i + 1) * stride];
+    float s = low + (t - i) * (high - low);
+    return (r < 0) ? -s : s;
+}
+
+// Rotation mode: turns (gain, 0) by +-atan(2^-i) towards the angle.
+static float approximant_cordic(float r, int iterations) {
+    float x = approximant_cordic_gains[iterations - 1];
+    float y = 0;
+    float z = r;
+    float power = 1;
+    for (int i = 0; i < iterations; i++) {
+        // Directions from the sign bit, a branch here would be mispredicted half the time.
+        float d = copysignf(power, z);
+        float next_x = x - d * y;
+        y += d * x;
+        x = next_x;
+        z -= copysignf(approximant_cordic_angles[i], z);
+        power *= 0.5f;
+    }
+    return y + 0 * r; // NaN in, NaN out
+}
+
+// Folds a chunk of arguments to s and c in [-pi/2, pi/2] with sin(x) = sin(s)
+// and cos(x) = sin(c). Non-finite arguments fold to NaN.
+static void approximant_fold(const float *x, float *s, float *c, int count) {
+    for (int i = 0; i < count; i++) {
+        // Adding and removing 1.5*2^52 rounds to an integer without rint, so the loop vectorizes.
+        double k = (x[i] / (2 * APPROXIMANT_PI) + 0x1.8p52) - 0x1.8p52;
+        double t = x[i] - 2 * APPROXIMANT_PI * k;
+        s[i] = (float)((t > APPROXIMANT_PI / 2) ? APPROXIMANT_PI - t : (t < -APPROXIMANT_PI / 2) ? -APPROXIMANT_PI - t : t);
+        c[i] = (float)(APPROXIMANT_PI / 2 - fabs(t));
+    }
+}
+
+// The kind is switched on once per chunk, so each kernel runs in its own loop.
+static void approximant_sin_folded(const Approximant *a, const float *r, float *out, int count) {
+    switch (a->kind) {
+    case APPROXIMANT_TAYLOR:
+        for (int i = 0; i < count; i++) {
+            out[i] = approximant_taylor(r[i], a->order);
+        }
+        break;
+    case APPROXIMANT_BHASKARA:
+        for (int i = 0; i < count; i++) {
+            out[i] = approximant_bhaskara(r[i]);
+        }
+        break;
+    case APPROXIMANT_MINIMAX:
+        for (int i = 0; i < count; i++) {
+            out[i] = approximant_minimax(r[i], a->order);
+        }
+        break;
+    case APPROXIMANT_TABLE:
+        for (int i = 0; i < count; i++) {
+            out[i] = approximant_table(r[i], a->order);
+        }
+        break;
+    case APPROXIMANT_CORDIC: {
+        // Each micro-rotation depends on the previous one, four lanes at once hide the latency.
+        int i = 0;
+#ifdef __SSE__
+        __m128 sign_mask = _mm_set1_ps(-0.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 z = _mm_loadu_ps(r + i);
+            __m128 x = _mm_set1_ps(approximant_cordic_gains[a->order - 1]);
+            __m128 y = _mm_setzero_ps();
+            float power = 1;
+            for (int k = 0; k < a->order; k++) {
+                __m128 sign = _mm_and_ps(z, sign_mask);
+                __m128 d = _mm_xor_ps(_mm_set1_ps(power), sign);
+                __m128 next_x = _mm_sub_ps(x, _mm_mul_ps(d, y));
+                y = _mm_add_ps(y, _mm_mul_ps(d, x));
+                x = next_x;
+                z = _mm_sub_ps(z, _mm_xor_ps(_mm_set1_ps(approximant_cordic_angles[k]), sign));
+                power *= 0.5f;
+            }
+            _mm_storeu_ps(out + i, _mm_add_ps(y, _mm_mul_ps(_mm_setzero_ps(), _mm_loadu_ps(r + i))));
+        }
+#endif
+        for (; i < count; i++) {
+            out[i] = approximant_cordic(r[i], a->order);
+        }
+        break;
+    }
+    case APPROXIMANT_CORDIC_Q15:
+        for (int i = 0; i < count; i++) {
+            int16_t s, c;
+            cordic_sincos_q15(isfinite(r[i]) ? cordic_angle_q15_from_radians(r[i]) : 0, a->order, &s, &c);
+            out[i] = isfinite(r[i]) ? s / 32768.0f : NAN;
+        }
+        break;
+    case APPROXIMANT_CORDIC_Q31:
+        for (int i = 0; i < count; i++) {
+            int32_t s, c;
+            cordic_sincos_q31(isfinite(r[i]) ? cordic_angle_q31_from_radians(r[i]) : 0, a->order, &s, &c);
+            out[i] = isfinite(r[i]) ? (float)(s / 2147483648.0) : NAN;
+        }
+        break;
+    default:
+        for (int i = 0; i < count; i++) {
+            out[i] = sinf(r[i]);
+        }
+        break;
+    }
+}
+
+void approximant_evaluate_batch(const Approximant *a, TrigKind kind, const float *x, float *out, int count) {
+    enum { CHUNK = 256 };
+    float s[CHUNK], c[CHUNK], cos_out[CHUNK];
+    pthread_once(&approximant_sine_table_once, approximant_sine_table_build);
+    for (int start = 0; start < count; start += CHUNK) {
+        int n = (count - start < CHUNK) ? count - start : CHUNK;
+        approximant_fold(x + start, s, c, n);
+        if (kind == TRIG_COS) {
+            approximant_sin_folded(a, c, out + start, n);
+            continue;
+        }
+        approximant_sin_folded(a, s, out + start, n);
+        if (kind == TRIG_TAN) {
+            approximant_sin_folded(a, c, cos_out, n);
+            for (int i = 0; i < n; i++) {
+                out[start + i] /= cos_out[i];
+            }
+        }
+    }
+}
+
+const char *approximant_name(const Approximant *a) {
+    const ApproximantInfo *info = &approximant_infos[a->kind];
+    return (info->max_order == 0) ? info->name : TextFormat("%s %d", info->name, a->order);
+}
+
+// The kind of the built-in kernel a panel plots, -1 for expressions and plugins.
+static int approximant_panel_kind(const TrigonometricFunction *tf) {
+    for (int k = 0; k < TRIG_KIND_COUNT; k++) {
+        if (tf->expression == NULL && tf->evaluate_batch == NULL && tf->function == trig_functions[k]) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+// Adds the kind after the selected one to the set and selects it, so
+// repeated adds line up different kernels side by side.
+void approximant_add(TrigonometricFunction *tf) {
+    ApproximantSet *set = &tf->approximants;
+    if (approximant_panel_kind(tf) < 0 || set->count == APPROXIMANT_SET_MAX) {
+        return;
+    }
+    ApproximantKind kind = (set->count > 0) ? set->shown[set->selected].kind : APPROXIMANT_NONE;
+    kind = (kind + 1) % APPROXIMANT_KIND_COUNT;
+    kind = (kind == APPROXIMANT_NONE) ? APPROXIMANT_NONE + 1 : kind;
+    set->selected = set->count++;
+    set->shown[set->selected] = (Approximant){kind, approximant_infos[kind].default_order};
+}
+
+// Switches the selected approximant of a built-in panel to the next kind,
+// dropping it from the set after the last one.
+void approximant_cycle(TrigonometricFunction *tf) {
+    ApproximantSet *set = &tf->approximants;
+    if (approximant_panel_kind(tf) < 0) {
+        return;
+    }
+    if (set->count == 0) {
+        approximant_add(tf);
+        return;
+    }
+    Approximant *a = &set->shown[set->selected];
+    a->kind = (a->kind + 1) % APPROXIMANT_KIND_COUNT;
+    a->order = approximant_infos[a->kind].default_order;
+    if (a->kind == APPROXIMANT_NONE) {
+        // Overlays of the entries moved down are resampled on the next draw.
+        memmove(a, a + 1, (set->count - set->selected - 1) * sizeof(*a));
+        set->count--;
+        set->selected = (set->count > 0) ? set->count - 1 : 0;
+    }
+}
+
+// Degrees step by 2 (odd only), table sizes by powers of two, CORDIC by one micro-rotation.
+void approximant_step_order(TrigonometricFunction *tf, int direction) {
+    if (tf->approximants.count == 0) {
+        return;
+    }
+    Approximant *a = &tf->approximants.shown[tf->approximants.selected];
+    const ApproximantInfo *info = &approximant_infos[a->kind];
+    int order = a->order;
+    switch (a->kind) {
+    case APPROXIMANT_TAYLOR:
+    case APPROXIMANT_MINIMAX: order += 2 * direction; break;
+    case APPROXIMANT_TABLE: order = (direction > 0) ? order * 2 : order / 2; break;
+    default: order += direction; break;
+    }
+    if (order >= info->min_order && order <= info->max_order) {
+        a->order = order;
+    }
+}
+
+// Timings are keyed by approximant and function; APPROXIMANT_NONE times the
+// trig.c batch kernel for comparison. ns stays NaN until measured.
+typedef struct ApproximantTiming {
+    Approximant approximant;
+    TrigKind kind;
+    float ns;
+} ApproximantTiming;
+
+typedef struct ApproximantBench {
+    ApproximantTiming timings[APPROXIMANT_BENCH_MAX_TIMINGS];
+    int timing_count;
+    int next_replaced; // once full, slots are reused round robin
+    float x[APPROXIMANT_BENCH_SIZE];
+    float out[APPROXIMANT_BENCH_SIZE];
+    pthread_t worker;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool quit;
+} ApproximantBench;
+
+static inline bool approximant_timing_matches(const ApproximantTiming *t, const Approximant *a, TrigKind kind) {
+    return t->approximant.kind == a->kind && t->approximant.order == a->order && t->kind == kind;
+}
+
+// Best of a few runs, each repeating the batch for a couple of milliseconds.
+static float approximant_bench_measure(ApproximantBench *bench, const Approximant *a, TrigKind kind) {
+    double best = INFINITY;
+    for (int run = 0; run < APPROXIMANT_BENCH_RUNS; run++) {
+        double start = platform_time_seconds();
+        double elapsed;
+        int repeats = 0;
+        do {
+            if (a->kind == APPROXIMANT_NONE) {
+                trig_evaluate_batch_kind(kind, bench->x, bench->out, APPROXIMANT_BENCH_SIZE);
+            } else {
+                approximant_evaluate_batch(a, kind, bench->x, bench->out, APPROXIMANT_BENCH_SIZE);
+            }
+            repeats++;
+            elapsed = platform_time_seconds() - start;
+        } while (elapsed < APPROXIMANT_BENCH_RUN_SECONDS);
+        best = fmin(best, elapsed / repeats);
+    }
+    return (float)(best / APPROXIMANT_BENCH_SIZE * 1e9);
+}
+
+static void *approximant_bench_worker(void *arg) {
+    ApproximantBench *bench = arg;
+    pthread_mutex_lock(&bench->mutex);
+    while (true) {
+        int index = -1;
+        while (!bench->quit && index < 0) {
+            for (int i = 0; i < bench->timing_count && index < 0; i++) {
+                index = isnan(bench->timings[i].ns) ? i : -1;
+            }
+            if (index < 0 && !bench->quit) {
+                pthread_cond_wait(&bench->cond, &bench->mutex);
+            }
+        }
+        if (bench->quit) {
+            break;
+        }
+        ApproximantTiming timing = bench->timings[index];
+        pthread_mutex_unlock(&bench->mutex);
+
+        timing.ns = approximant_bench_measure(bench, &timing.approximant, timing.kind);
+
+        pthread_mutex_lock(&bench->mutex);
+        // The slot may have been reused for another request meanwhile.
+        if (approximant_timing_matches(&bench->timings[index], &timing.approximant, timing.kind)) {
+            bench->timings[index].ns = timing.ns;
+        }
+    }
+    pthread_mutex_unlock(&bench->mutex);
+    return NULL;
+}
+
+void approximant_bench_init(ApproximantBench *bench) {
+    memset(bench, 0, sizeof(*bench));
+    // Arguments over a few turns in a fixed pseudo-random order, so branchy
+    // kernels are not timed on a perfectly predictable pattern.
+    uint32_t state = 12345;
+    for (int i = 0; i < APPROXIMANT_BENCH_SIZE; i++) {
+        state = state * 1664525u + 1013904223u;
+        bench->x[i] = (float)((state >> 8) / 16777216.0 * 8 * APPROXIMANT_PI - 4 * APPROXIMANT_PI);
+    }
+    pthread_mutex_init(&bench->mutex, NULL);
+    pthread_cond_init(&bench->cond, NULL);
+    pthread_create(&bench->worker, NULL, approximant_bench_worker, bench);
+}
+
+void approximant_bench_deinit(ApproximantBench *bench) {
+    pthread_mutex_lock(&bench->mutex);
+    bench->quit = true;
+    pthread_cond_signal(&bench->cond);
+    pthread_mutex_unlock(&bench->mutex);
+    pthread_join(bench->worker, NULL);
+    pthread_cond_destroy(&bench->cond);
+    pthread_mutex_destroy(&bench->mutex);
+}
+
+// ns per evaluation, NaN while the measurement is queued or running.
+float approximant_bench_query(ApproximantBench *bench, const Approximant *a, TrigKind kind) {
+    pthread_mutex_lock(&bench->mutex);
+    ApproximantTiming *timing = NULL;
+    for (int i = 0; i < bench->timing_count && timing == NULL; i++) {
+        timing = approximant_timing_matches(&bench->timings[i], a, kind) ? &bench->timings[i] : NULL;
+    }
+    if (timing == NULL) {
+        if (bench->timing_count < APPROXIMANT_BENCH_MAX_TIMINGS) {
+            timing = &bench->timings[bench->timing_count++];
+        } else {
+            timing = &bench->timings[bench->next_replaced];
+            bench->next_replaced = (bench->next_replaced + 1) % APPROXIMANT_BENCH_MAX_TIMINGS;
+        }
+        *timing = (ApproximantTiming) { .approximant = *a, .kind = kind, .ns = NAN };
+        pthread_cond_signal(&bench->cond);
+    }
+    float ns = timing->ns;
+    pthread_mutex_unlock(&bench->mutex);
+    return ns;
+}
+
+// Overlay of one approximant, resampled only when it or the panel changed.
+struct ApproximantPlot {
+    Approximant approximant;
+    Domain domain;
+    Range range;
+    Vector2 position;
+    Vector2 size;
+    int count;
+    Vector2 curve[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS + 1];
+    Vector2 error[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS]; // largest error of each column, log scale
+    float max_error;
+};
+
+static bool approximant_plot_current(const ApproximantPlot *plot, const TrigonometricFunction *tf, const Approximant *a) {
+    return (
+        plot->approximant.kind == a->kind &&
+        plot->approximant.order == a->order &&
+        plot->domain.min == tf->domain.min &&
+        plot->domain.max == tf->domain.max &&
+        plot->range.min == tf->range.min &&
+        plot->range.max == tf->range.max &&
+        plot->position.x == tf->position.x &&
+        plot->position.y == tf->position.y &&
+        plot->size.x == tf->size.x &&
+        plot->size.y == tf->size.y &&
+        plot->count == tf->curve_count
+    );
+}
+
+// Samples the same columns as the panel curve. The error is relative where
+// the function exceeds 1 in magnitude, so tan stays readable near its poles.
+static void approximant_plot_update(ApproximantPlot *plot, TrigonometricFunction *tf, const Approximant *a, TrigKind kind) {
+    enum { MAX_SAMPLES = TRIGONOMETRIC_FUNCTION_MAX_COLUMNS * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + 1 };
+    int columns = tf->curve_count;
+    int sample_count = columns * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + 1;
+    double step = (tf->domain.max - tf->domain.min) / (sample_count - 1);
+    float xs[MAX_SAMPLES];
+    float exact[MAX_SAMPLES];
+    float approximated[MAX_SAMPLES];
+    for (int j = 0; j < sample_count; j++) {
+        xs[j] = (float)(tf->domain.min + step * j);
+    }
+    trig_evaluate_batch_kind(kind, xs, exact, sample_count);
+    approximant_evaluate_batch(a, kind, xs, approximated, sample_count);
+
+    float top = tf->position.y;
+    float bottom = tf->position.y + tf->size.y;
+    float x_fract = tf->size.x / columns;
+    plot->max_error = 0;
+    for (int j = 0; j <= columns; j++) {
+        const float *column = approximated + j * TRIGONOMETRIC_FUNCTION_SUBSAMPLES;
+        float y = trigonometric_function_value_to_y(tf, column[0]);
+        plot->curve[j] = (Vector2) {tf->position.x + x_fract * j, (y < top) ? top : (y > bottom) ? bottom : y};
+        if (j == columns) {
+            break;
+        }
+        float column_error = 0;
+        for (int k = 0; k <= TRIGONOMETRIC_FUNCTION_SUBSAMPLES; k++) {
+            int i = j * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + k;
+            float error = fabsf(approximated[i] - exact[i]) / fmaxf(1, fabsf(exact[i]));
+            column_error = isnan(error) ? column_error : fmaxf(column_error, error);
+        }
+        plot->max_error = fmaxf(plot->max_error, column_error);
+        float decades = (column_error > 0) ? log10f(column_error) + APPROXIMANT_ERROR_DECADES : 0;
+        decades = (decades < 0) ? 0 : (decades > APPROXIMANT_ERROR_DECADES) ? APPROXIMANT_ERROR_DECADES : decades;
+        plot->error[j] = (Vector2) {tf->position.x + x_fract * (j + 0.5f), bottom - decades / APPROXIMANT_ERROR_DECADES * tf->size.y};
+    }
+    plot->approximant = *a;
+    plot->domain = tf->domain;
+    plot->range = tf->range;
+    plot->position = tf->position;
+    plot->size = tf->size;
+    plot->count = columns;
+}
+
+// Drawn over the panel after trigonometric_function_draw, which sets up the
+// columns. Each approximant gets a colour and a label line below the last.
+void approximant_draw(ApproximantBench *bench, TrigonometricFunction *tf, Font *font) {
+    static const Color colors[APPROXIMANT_SET_MAX] = {
+        APPROXIMANT_COL, {0,255,200,255}, {255,96,255,255}, {160,255,64,255},
+    };
+    const ApproximantSet *set = &tf->approximants;
+    int kind = approximant_panel_kind(tf);
+    if (set->count == 0 || kind < 0 || tf->curve_count == 0) {
+        return;
+    }
+    if (tf->approximant_plots == NULL) {
+        tf->approximant_plots = calloc(APPROXIMANT_SET_MAX, sizeof(ApproximantPlot));
+    }
+
+    float top = tf->position.y;
+    float bottom = tf->position.y + tf->size.y;
+    float reference_ns = approximant_bench_query(bench, &(Approximant){APPROXIMANT_NONE, 0}, kind);
+    const char *reference = isnan(reference_ns) ? "" : TextFormat(" (%s %.2f ns)", trig_kind_names[kind], reference_ns);
+    for (int i = 0; i < set->count; i++) {
+        const Approximant *a = &set->shown[i];
+        ApproximantPlot *plot = &tf->approximant_plots[i];
+        if (!approximant_plot_current(plot, tf, a)) {
+            approximant_plot_update(plot, tf, a, kind);
+        }
+        Color color = colors[i];
+        Color error_color = ColorAlpha(color, 0.5f);
+        for (int j = 1; j <= plot->count; j++) {
+            Vector2 prev = plot->curve[j-1];
+            Vector2 next = plot->curve[j];
+            if ((prev.y != top && prev.y != bottom) || (next.y != top && next.y != bottom)) {
+                render_line(prev, next, LINE_SMALL * 2, color);
+            }
+            if (j < plot->count) {
+                render_line(plot->error[j-1], plot->error[j], LINE_SMALL, error_color);
+            }
+        }
+
+        float ns = approximant_bench_query(bench, a, kind);
+        const char *timing = isnan(ns) ? "timing..." : TextFormat("%.2f ns", ns);
+        draw_text_centered(
+            font,
+            TEXT_FLAG_BACKING_RECTANGLE,
+            (Vector2){tf->position.x + tf->size.x/2, top + layout.small_label_offset * (1 + APPROXIMANT_LABEL_SPACING * i)},
+            0,
+            TextFormat("%s%s  err %.2g  %s%s", (i == set->selected && set->count > 1) ? "> " : "", approximant_name(a), plot->max_error, timing, reference),
+            color
+        );
+    }
+    if (!layout.panel_compact) {
+        Color axis_color = ColorAlpha(APPROXIMANT_COL, 0.5f);
+        draw_text_centered(font, TEXT_FLAG_NONE, (Vector2){tf->position.x + tf->size.x + layout.small_label_offset, top}, 0, "1", axis_color);
+        draw_text_centered(font, TEXT_FLAG_NONE, (Vector2){tf->position.x + tf->size.x + layout.small_label_offset, bottom}, 0, TextFormat("1e-%d", APPROXIMANT_ERROR_DECADES), axis_color);
+    }
+}
@@ -0,0 +1,219 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+// Piecewise Chebyshev approximation of a function over a domain. Segments
+// are bisected until the interpolant at the Chebyshev nodes stays within the
+// tolerance (checked between the nodes), which gets within a small factor of
+// the minimax polynomial of the same degree without an exchange algorithm.
+// Errors are measured after clamping to the plotted range, so poles that are
+// drawn clamped anyway do not force endless subdivision; segments that still
+// do not converge are marked to be evaluated exactly.
+
+#define CHEBYSHEV_NODES 17
+#define CHEBYSHEV_CHECKS (CHEBYSHEV_NODES * 2)
+#define CHEBYSHEV_MAX_SEGMENTS 256
+#define CHEBYSHEV_MAX_DEPTH 14
+
+typedef void (*ChebyshevSource)(void *user, const float *x, float *out, int count);
+
+typedef struct ChebyshevSegment {
+    double min;
+    double max;
+    float mid;      // t = (x - mid)*scale maps the segment to [-1,1], subtracting
+    float scale;    // first keeps t accurate on segments far from the origin
+    int degree;     // -1 when the segment is evaluated exactly
+    float coefficients[CHEBYSHEV_NODES];
+} ChebyshevSegment;
+
+struct Chebyshev {
+    bool valid;
+    Domain domain;
+    Range range;
+    float tolerance;
+    int segment_count;
+    int exact_count;
+    ChebyshevSegment segments[CHEBYSHEV_MAX_SEGMENTS];
+};
+
+static inline float chebyshev_clamp(float v, Range range) {
+    if (!(v >= range.min)) {
+        return isnan(v) ? range.max : range.min;
+    }
+    return (v > range.max) ? range.max : v;
+}
+
+static float chebyshev_clenshaw(const ChebyshevSegment *s, float t) {
+    float b1 = 0, b2 = 0;
+    for (int k = s->degree; k >= 1; k--) {
+        float b0 = s->coefficients[k] + 2*t*b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return s->coefficients[0] + t*b1 - b2;
+}
+
+// Fits one segment, returns false if it needs to be split.
+static bool chebyshev_fit_segment(Chebyshev *ch, ChebyshevSegment *s, ChebyshevSource source, void *user, bool last_chance) {
+    float x[CHEBYSHEV_CHECKS + 1];
+    float f[CHEBYSHEV_CHECKS + 1];
+    // The nodes are centred on the float midpoint the evaluation subtracts.
+    s->mid = (float)((s->min + s->max) / 2);
+    double mid = s->mid;
+    double half = fmax(s->max - mid, mid - s->min);
+    s->scale = (float)(1 / half);
+    s->degree = -1;
+    // A few hundred floats are too coarse a grid to place the nodes on, and
+    // the source is exact on them anyway.
+    float ulp = nextafterf(fabsf(s->mid), INFINITY) - fabsf(s->mid);
+    if (half < ulp * CHEBYSHEV_NODES * CHEBYSHEV_NODES) {
+        return true;
+    }
+    for (int j = 0; j < CHEBYSHEV_NODES; j++) {
+        x[j] = (float)(mid + half * cos(PI * (j + 0.5) / CHEBYSHEV_NODES));
+    }
+    source(user, x, f, CHEBYSHEV_NODES);
+    bool finite = true;
+    for (int j = 0; j < CHEBYSHEV_NODES; j++) {
+        finite = finite && isfinite(f[j]);
+    }
+    if (!finite) {
+        return last_chance;
+    }
+
+    for (int k = 0; k < CHEBYSHEV_NODES; k++) {
+        double sum = 0;
+        for (int j = 0; j < CHEBYSHEV_NODES; j++) {
+            sum += f[j] * cos(PI * k * (j + 0.5) / CHEBYSHEV_NODES);
+        }
+        s->coefficients[k] = (float)(sum * 2 / CHEBYSHEV_NODES);
+    }
+    s->coefficients[0] /= 2;
+    s->degree = CHEBYSHEV_NODES - 1;
+
+    // Between the nodes is where the interpolation error peaks.
+    for (int j = 0; j <= CHEBYSHEV_CHECKS; j++) {
+        x[j] = (float)(mid + half * cos(PI * j / CHEBYSHEV_CHECKS));
+    }
+    source(user, x, f, CHEBYSHEV_CHECKS + 1);
+    float max_error = 0;
+    for (int j = 0; j <= CHEBYSHEV_CHECKS; j++) {
+        float approximation = chebyshev_clenshaw(s, (x[j] - s->mid) * s->scale);
+        float error = fabsf(chebyshev_clamp(approximation, ch->range) - chebyshev_clamp(f[j], ch->range));
+        max_error = (error > max_error) ? error : max_error;
+    }
+    if (max_error > ch->tolerance) {
+        s->degree = -1;
+        return last_chance;
+    }
+    // Drop the tail of coefficients that together stay below the remaining budget.
+    float tail = 0;
+    while (s->degree > 0 && tail + fabsf(s->coefficients[s->degree]) < ch->tolerance - max_error) {
+        tail += fabsf(s->coefficients[s->degree]);
+        s->degree--;
+    }
+    return true;
+}
+
+static void chebyshev_build_range(Chebyshev *ch, double min, double max, int depth, ChebyshevSource source, void *user) {
+    if (ch->segment_count == CHEBYSHEV_MAX_SEGMENTS) {
+        return;
+    }
+    ChebyshevSegment *s = &ch->segments[ch->segment_count];
+    s->min = min;
+    s->max = max;
+    // Keep one slot free per pending right half so the domain stays covered.
+    bool last_chance = depth >= CHEBYSHEV_MAX_DEPTH || ch->segment_count + depth + 2 >= CHEBYSHEV_MAX_SEGMENTS;
+    if (chebyshev_fit_segment(ch, s, source, user, last_chance)) {
+        ch->exact_count += (s->degree < 0);
+        ch->segment_count++;
+        return;
+    }
+    double mid = (min + max) / 2;
+    chebyshev_build_range(ch, min, mid, depth + 1, source, user);
+    chebyshev_build_range(ch, mid, max, depth + 1, source, user);
+}
+
+void chebyshev_build(Chebyshev *ch, Domain domain, Range range, float tolerance, ChebyshevSource source, void *user) {
+    ch->domain = domain;
+    ch->range = range;
+    ch->tolerance = tolerance;
+    ch->segment_count = 0;
+    ch->exact_count = 0;
+    chebyshev_build_range(ch, domain.min, domain.max, 0, source, user);
+    ch->valid = true;
+}
+
+bool chebyshev_covers(const Chebyshev *ch, Domain domain, Range range, float tolerance) {
+    return (
+        ch->valid &&
+        domain.min >= ch->domain.min &&
+        domain.max <= ch->domain.max &&
+        range.min == ch->range.min &&
+        range.max == ch->range.max &&
+        ch->tolerance <= tolerance
+    );
+}
+
+static int chebyshev_find_segment(const Chebyshev *ch, double x) {
+    int low = 0, high = ch->segment_count - 1;
+    if (x < ch->domain.min || x > ch->domain.max) {
+        return -1;
+    }
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (ch->segments[mid].min <= x) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+// Runs of samples in the same segment go through Clenshaw four at a time,
+// runs in exact segments (or outside the domain) are passed to the source.
+void chebyshev_evaluate_batch(const Chebyshev *ch, const float *x, float *out, int count, ChebyshevSource source, void *user) {
+    int i = 0;
+    while (i < count) {
+        int index = chebyshev_find_segment(ch, x[i]);
+        const ChebyshevSegment *s = (index >= 0) ? &ch->segments[index] : NULL;
+        int end = i + 1;
+        if (s != NULL) {
+            while (end < count && x[end] >= s->min && x[end] <= s->max) {
+                end++;
+            }
+        } else {
+            while (end < count && chebyshev_find_segment(ch, x[end]) < 0) {
+                end++;
+            }
+        }
+        if (s == NULL || s->degree < 0) {
+            source(user, x + i, out + i, end - i);
+            i = end;
+            continue;
+        }
+#ifdef __SSE__
+        __m128 mid = _mm_set1_ps(s->mid);
+        __m128 scale = _mm_set1_ps(s->scale);
+        for (; i + 4 <= end; i += 4) {
+            __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(x + i), mid), scale);
+            __m128 t2 = _mm_add_ps(t, t);
+            __m128 b1 = _mm_setzero_ps(), b2 = _mm_setzero_ps();
+            for (int k = s->degree; k >= 1; k--) {
+                __m128 b0 = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(s->coefficients[k]), _mm_mul_ps(t2, b1)), b2);
+                b2 = b1;
+                b1 = b0;
+            }
+            __m128 result = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(s->coefficients[0]), _mm_mul_ps(t, b1)), b2);
+            _mm_storeu_ps(out + i, result);
+        }
+#endif
+        for (; i < end; i++) {
+            out[i] = chebyshev_clenshaw(s, (x[i] - s->mid) * s->scale);
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.c"
+#include "cordic.c"
+
+// Checks the fixed-point CORDIC engine bit for bit. Every binary angle of a
+// range (a full turn by default) is rotated, compared against a double
+// reference in units of the last bit, and turned back into an angle with the
+// vectoring mode. The batch is timed against sinf + cosf on the same angles,
+// and the exact results can be dumped to diff against a firmware build.
+
+#define CORDIC_CHECK_MAX_THREADS 256
+#define CORDIC_CHECK_BATCH 4096
+
+typedef struct CordicCheckOptions {
+    int bits;               // 15 or 31
+    int iterations;
+    uint64_t first;
+    uint64_t last;
+    int thread_count;
+    const char *out_path;
+} CordicCheckOptions;
+
+typedef struct CordicCheckStats {
+    uint64_t count;
+    double max_sin_lsb;
+    double max_cos_lsb;
+    double sum_lsb;
+    uint64_t worst_angle;
+    uint64_t max_atan2_lsb;
+    double max_libm_lsb;
+    double cordic_seconds;
+    double libm_seconds;
+} CordicCheckStats;
+
+typedef struct CordicCheckJob {
+    const CordicCheckOptions *options;
+    char *out;
+    uint64_t first;
+    uint64_t count;
+    CordicCheckStats stats;
+} CordicCheckJob;
+
+static int cordic_check_record_size(const CordicCheckOptions *o) {
+    return (o->bits == 15) ? 2 * (int)sizeof(int16_t) : 2 * (int)sizeof(int32_t);
+}
+
+// Distance of the exact value from the fixed-point one, saturated like the engine.
+static double cordic_check_lsb(double exact, int32_t got, double one, double max) {
+    double v = exact * one;
+    v = (v > max) ? max : (v < -one) ? -one : v;
+    return fabs(v - got);
+}
+
+static void *cordic_check_job_run(void *arg) {
+    CordicCheckJob *job = arg;
+    const CordicCheckOptions *o = job->options;
+    CordicCheckStats *st = &job->stats;
+    double one = (o->bits == 15) ? 32768.0 : 2147483648.0;
+    double max = one - 1;
+    double turn = (o->bits == 15) ? 65536.0 : 4294967296.0;
+    int record_size = cordic_check_record_size(o);
+    uint16_t angles_q15[CORDIC_CHECK_BATCH];
+    uint32_t angles_q31[CORDIC_CHECK_BATCH];
+    int16_t sin_q15[CORDIC_CHECK_BATCH], cos_q15[CORDIC_CHECK_BATCH];
+    int32_t sin_q31[CORDIC_CHECK_BATCH], cos_q31[CORDIC_CHECK_BATCH];
+    float radians[CORDIC_CHECK_BATCH], sin_libm[CORDIC_CHECK_BATCH], cos_libm[CORDIC_CHECK_BATCH];
+
+    for (uint64_t done = 0; done < job->count; done += CORDIC_CHECK_BATCH) {
+        uint64_t first = job->first + done;
+        int count = (job->count - done < CORDIC_CHECK_BATCH) ? (int)(job->count - done) : CORDIC_CHECK_BATCH;
+        for (int i = 0; i < count; i++) {
+            angles_q31[i] = (uint32_t)(first + i);
+            angles_q15[i] = (uint16_t)(first + i);
+            radians[i] = (float)(2 * 3.14159265358979323846 * (double)(first + i) / turn);
+        }
+
+        double start = platform_time_seconds();
+        if (o->bits == 15) {
+            cordic_sincos_q15_batch(angles_q15, o->iterations, sin_q15, cos_q15, count);
+        } else {
+            cordic_sincos_q31_batch(angles_q31, o->iterations, sin_q31, cos_q31, count);
+        }
+        double middle = platform_time_seconds();
+        for (int i = 0; i < count; i++) {
+            sin_libm[i] = sinf(radians[i]);
+            cos_libm[i] = cosf(radians[i]);
+        }
+        st->libm_seconds += platform_time_seconds() - middle;
+        st->cordic_seconds += middle - start;
+        if (o->bits == 15) {
+            for (int i = 0; i < count; i++) {
+                sin_q31[i] = sin_q15[i];
+                cos_q31[i] = cos_q15[i];
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            uint64_t angle = first + i;
+            double x = 2 * 3.14159265358979323846 * (double)angle / turn;
+            double sin_error = cordic_check_lsb(sin(x), sin_q31[i], one, max);
+            double cos_error = cordic_check_lsb(cos(x), cos_q31[i], one, max);
+            if (sin_error > st->max_sin_lsb || cos_error > st->max_cos_lsb) {
+                st->worst_angle = angle;
+            }
+            st->max_sin_lsb = (sin_error > st->max_sin_lsb) ? sin_error : st->max_sin_lsb;
+            st->max_cos_lsb = (cos_error > st->max_cos_lsb) ? cos_error : st->max_cos_lsb;
+            st->sum_lsb += sin_error + cos_error;
+            // The float results on the same scale, which also keeps the timed libm loop alive.
+            double libm_error = fmax(fabs(sin_libm[i] - sin(x)), fabs(cos_libm[i] - cos(x))) * one;
+            st->max_libm_lsb = (libm_error > st->max_libm_lsb) ? libm_error : st->max_libm_lsb;
+
+            uint32_t back = (o->bits == 15)
+                ? cordic_atan2_q15(sin_q15[i], cos_q15[i], o->iterations)
+                : cordic_atan2_q31(sin_q31[i], cos_q31[i], o->iterations);
+            // Wrapped difference, sign extended from the engine's angle width.
+            uint32_t wrapped = back - (uint32_t)angle;
+            int64_t difference = (o->bits == 15) ? (int16_t)(uint16_t)wrapped : (int32_t)wrapped;
+            uint64_t atan2_error = (uint64_t)llabs(difference);
+            st->max_atan2_lsb = (atan2_error > st->max_atan2_lsb) ? atan2_error : st->max_atan2_lsb;
+        }
+        st->count += count;
+
+        if (job->out != NULL) {
+            char *dst = job->out + (first - o->first) * (uint64_t)record_size;
+            for (int i = 0; i < count; i++) {
+                if (o->bits == 15) {
+                    int16_t pair[2] = { sin_q15[i], cos_q15[i] };
+                    memcpy(dst + i * record_size, pair, sizeof(pair));
+                } else {
+                    int32_t pair[2] = { sin_q31[i], cos_q31[i] };
+                    memcpy(dst + i * record_size, pair, sizeof(pair));
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static void cordic_check_usage(const char *program) {
+    printf("%s [Options]\n", program);
+    printf("Options:\n");
+    printf("   -q 15|31           engine (31)\n");
+    printf("   -n <iterations>    micro-rotations (20 for q15, 33 for q31)\n");
+    printf("   -s <first>         first binary angle (0)\n");
+    printf("   -e <last>          last binary angle, inclusive (a full turn)\n");
+    printf("   -j <threads>       worker threads (all cores)\n");
+    printf("   -o <file>          also write the sin,cos pairs as raw int16/int32 in native byte order\n");
+    printf("Prints one JSON object; errors are in units of the last bit, timings in ns per angle.\n");
+}
+
+int main(int argc, char **argv) {
+    CordicCheckOptions o = {
+        .bits = 31,
+        .thread_count = platform_cpu_count(),
+    };
+    bool has_last = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL || strcmp(arg, "-h") == 0) {
+            cordic_check_usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "-q") == 0) {
+            o.bits = (atoi(value) == 15) ? 15 : 31;
+        } else if (strcmp(arg, "-n") == 0) {
+            o.iterations = atoi(value);
+        } else if (strcmp(arg, "-s") == 0) {
+            o.first = strtoull(value, NULL, 0);
+        } else if (strcmp(arg, "-e") == 0) {
+            o.last = strtoull(value, NULL, 0);
+            has_last = true;
+        } else if (strcmp(arg, "-j") == 0) {
+            o.thread_count = atoi(value);
+        } else if (strcmp(arg, "-o") == 0) {
+            o.out_path = value;
+        } else {
+            cordic_check_usage(argv[0]);
+            return 1;
+        }
+    }
+    uint64_t turn_last = (o.bits == 15) ? UINT16_MAX : UINT32_MAX;
+    int max_iterations = (o.bits == 15) ? CORDIC_Q15_ITERATIONS : CORDIC_Q31_ITERATIONS;
+    o.iterations = (o.iterations == 0) ? max_iterations : cordic_clamp_iterations(o.iterations, max_iterations);
+    o.last = has_last ? o.last : turn_last;
+    if (o.first > o.last || o.last > turn_last) {
+        fprintf(stderr, "angles must be within one turn (0..%llu)\n", (unsigned long long)turn_last);
+        return 1;
+    }
+    if (o.thread_count < 1) {
+        o.thread_count = 1;
+    } else if (o.thread_count > CORDIC_CHECK_MAX_THREADS) {
+        o.thread_count = CORDIC_CHECK_MAX_THREADS;
+    }
+
+    uint64_t total = o.last - o.first + 1;
+    MappedFile out = {0};
+    if (o.out_path != NULL) {
+        uint64_t size = total * (uint64_t)cordic_check_record_size(&o);
+        if (!platform_map_file_write(o.out_path, size, &out)) {
+            fprintf(stderr, "failed to map %s (%llu bytes)\n", o.out_path, (unsigned long long)size);
+            return 1;
+        }
+    }
+
+    // Every angle costs the same, so contiguous slices balance.
+    CordicCheckJob *jobs = calloc((size_t)o.thread_count, sizeof(CordicCheckJob));
+    pthread_t threads[CORDIC_CHECK_MAX_THREADS];
+    bool started[CORDIC_CHECK_MAX_THREADS];
+    double start_time = platform_time_seconds();
+    for (int t = 0; t < o.thread_count; t++) {
+        uint64_t first = total * (uint64_t)t / (uint64_t)o.thread_count;
+        uint64_t last = total * (uint64_t)(t + 1) / (uint64_t)o.thread_count;
+        jobs[t].options = &o;
+        jobs[t].out = (o.out_path != NULL) ? out.data : NULL;
+        jobs[t].first = o.first + first;
+        jobs[t].count = last - first;
+        // A slice without a thread is checked by this one.
+        started[t] = pthread_create(&threads[t], NULL, cordic_check_job_run, &jobs[t]) == 0;
+        if (!started[t]) {
+            cordic_check_job_run(&jobs[t]);
+        }
+    }
+    for (int t = 0; t < o.thread_count; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    double wall_seconds = platform_time_seconds() - start_time;
+    if (o.out_path != NULL) {
+        platform_unmap_file(&out);
+    }
+
+    CordicCheckStats sum = {0};
+    for (int t = 0; t < o.thread_count; t++) {
+        const CordicCheckStats *st = &jobs[t].stats;
+        if (st->max_sin_lsb > sum.max_sin_lsb || st->max_cos_lsb > sum.max_cos_lsb) {
+            sum.worst_angle = st->worst_angle;
+        }
+        sum.count += st->count;
+        sum.max_sin_lsb = (st->max_sin_lsb > sum.max_sin_lsb) ? st->max_sin_lsb : sum.max_sin_lsb;
+        sum.max_cos_lsb = (st->max_cos_lsb > sum.max_cos_lsb) ? st->max_cos_lsb : sum.max_cos_lsb;
+        sum.sum_lsb += st->sum_lsb;
+        sum.max_atan2_lsb = (st->max_atan2_lsb > sum.max_atan2_lsb) ? st->max_atan2_lsb : sum.max_atan2_lsb;
+        sum.max_libm_lsb = (st->max_libm_lsb > sum.max_libm_lsb) ? st->max_libm_lsb : sum.max_libm_lsb;
+        sum.cordic_seconds += st->cordic_seconds;
+        sum.libm_seconds += st->libm_seconds;
+    }
+    printf("{\"engine\":\"q%d\",\"iterations\":%d,\"first\":%llu,\"last\":%llu", o.bits, o.iterations,
+        (unsigned long long)o.first, (unsigned long long)o.last);
+    printf(",\"angles\":%llu,\"threads\":%d", (unsigned long long)sum.count, o.thread_count);
+    printf(",\"max_sin_lsb\":%.4f,\"max_cos_lsb\":%.4f,\"mean_lsb\":%.4f", sum.max_sin_lsb, sum.max_cos_lsb,
+        (sum.count > 0) ? sum.sum_lsb / (2.0 * sum.count) : 0.0);
+    printf(",\"worst_angle\":%llu,\"max_atan2_lsb\":%llu", (unsigned long long)sum.worst_angle, (unsigned long long)sum.max_atan2_lsb);
+    printf(",\"sinf_cosf_max_lsb\":%.4f", sum.max_libm_lsb);
+    printf(",\"cordic_ns\":%.4f,\"sinf_cosf_ns\":%.4f", sum.cordic_seconds * 1e9 / (double)sum.count, sum.libm_seconds * 1e9 / (double)sum.count);
+    printf(",\"wall_seconds\":%.3f}\n", wall_seconds);
+    free(jobs);
+    return 0;
+}
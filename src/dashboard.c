@@ -0,0 +1,207 @@
+#include "main.h"
+
+// A wall of independent unit circles, each with its own position, size and
+// angle. Everything that does not move with the angle (outline, axes, the
+// significant angle ticks and labels, quadrant numerals) is drawn once into a
+// layer shared by every circle, at the size of the largest one. Each circle
+// caches itself, the shared layer scaled to its radius with its own angle on
+// top, in a render target that is only redrawn when that angle or the layout
+// changed, so a still frame costs one textured quad per circle. Vector
+// exports and posters draw the circles directly.
+
+#define DASHBOARD_MAX_CIRCLES 64
+#define DASHBOARD_MARGIN 0.45f // room around a circle for its labels, in radii
+
+typedef struct DashboardCircle {
+    UnitCircle circle;
+    Rectangle cell;
+    bool dirty; // the render target no longer shows the circle
+    RenderTexture2D target;
+} DashboardCircle;
+
+typedef struct Dashboard {
+    int count; // 0 when the dashboard is off
+    bool direct; // bypass the render targets, for renders at another scale
+    DashboardCircle circles[DASHBOARD_MAX_CIRCLES];
+    RenderTexture2D layer;
+    float layer_radius;
+    bool layer_dirty;
+} Dashboard;
+
+static const int dashboard_counts[] = { 0, 4, 16, DASHBOARD_MAX_CIRCLES };
+static const float dashboard_scales[] = { 1.0f, 0.8f, 0.6f };
+
+void dashboard_free(Dashboard *db) {
+    for (int i = 0; i < DASHBOARD_MAX_CIRCLES; i++) {
+        if (db->circles[i].target.id != 0) {
+            UnloadRenderTexture(db->circles[i].target);
+        }
+    }
+    if (db->layer.id != 0) {
+        UnloadRenderTexture(db->layer);
+    }
+    *db = (Dashboard){0};
+}
+
+// Lays the circles out in a grid over the whole window, keeping their angles.
+void dashboard_apply_layout(Dashboard *db) {
+    if (db->count == 0) {
+        return;
+    }
+    int columns = (int)ceilf(sqrtf((float)db->count));
+    int rows = (db->count + columns - 1) / columns;
+    float cell_width = layout.width / columns;
+    float cell_height = layout.height / rows;
+    float side = floorf((cell_width < cell_height) ? cell_width : cell_height);
+    float radius = side / 2 / (1 + DASHBOARD_MARGIN);
+    for (int i = 0; i < db->count; i++) {
+        DashboardCircle *dc = &db->circles[i];
+        int column = i % columns;
+        int row = i / columns;
+        dc->cell = (Rectangle) {
+            floorf(cell_width * column + (cell_width - side) / 2),
+            floorf(cell_height * row + (cell_height - side) / 2),
+            side,
+            side,
+        };
+        UnitCircle *uc = &dc->circle;
+        uc->radius = radius * dashboard_scales[(column + row) % 3];
+        uc->center = (Vector2){ dc->cell.x + side / 2, dc->cell.y + side / 2 };
+        uc->position = (Vector2){ uc->center.x - uc->radius, uc->center.y - uc->radius };
+        unit_circle_update_degrees(uc, uc->deg);
+        dc->dirty = true;
+    }
+    db->layer_radius = radius;
+    db->layer_dirty = true;
+}
+
+// Shows count circles with their angles spread over a full turn.
+void dashboard_set_count(Dashboard *db, int count) {
+    dashboard_free(db);
+    db->count = (count > DASHBOARD_MAX_CIRCLES) ? DASHBOARD_MAX_CIRCLES : (count < 0) ? 0 : count;
+    for (int i = 0; i < db->count; i++) {
+        db->circles[i].circle.deg = 360.0f * i / db->count;
+    }
+    dashboard_apply_layout(db);
+}
+
+void dashboard_cycle(Dashboard *db) {
+    int next = 0;
+    for (int i = 0; i < (int)(sizeof(dashboard_counts) / sizeof(dashboard_counts[0])) - 1; i++) {
+        if (db->count == dashboard_counts[i]) {
+            next = dashboard_counts[i + 1];
+        }
+    }
+    dashboard_set_count(db, next);
+}
+
+// Turns the circle under position towards it, false if there is none.
+bool dashboard_point_towards(Dashboard *db, Vector2 position) {
+    for (int i = 0; i < db->count; i++) {
+        DashboardCircle *dc = &db->circles[i];
+        Rectangle cell = dc->cell;
+        if (position.x < cell.x || position.x >= cell.x + cell.width || position.y < cell.y || position.y >= cell.y + cell.height) {
+            continue;
+        }
+        float deg = dc->circle.deg;
+        unit_circle_update_towards(&dc->circle, position);
+        dc->dirty |= dc->circle.deg != deg;
+        return true;
+    }
+    return false;
+}
+
+// Labels keep the size they have on the main unit circle relative to the
+// radius. Returns the layout to restore afterwards.
+static Layout dashboard_scale_labels(float radius) {
+    Layout saved = layout;
+    float scale = radius / (layout.unit_circle.width / 2);
+    layout.text_scale *= scale;
+    layout.label_offset *= scale;
+    layout.small_label_offset *= scale;
+    return saved;
+}
+
+static void dashboard_draw_static(UnitCircle *uc, Font *font, float *angles, int angle_count) {
+    Layout saved = dashboard_scale_labels(uc->radius);
+    unit_circle_draw_outline(uc);
+    unit_circle_draw_quadrants(uc, font);
+    unit_circle_draw_angles_on_circumference(uc, font, angles, angle_count);
+    layout = saved;
+}
+
+// The tangent is left out, its segment runs off into the neighbouring circles.
+static void dashboard_draw_angle(UnitCircle *uc, Font *font) {
+    Layout saved = dashboard_scale_labels(uc->radius);
+    unit_circle_draw_sector(uc);
+    unit_circle_draw_right_angle(uc);
+    unit_circle_draw_triangle(uc, font);
+    layout = saved;
+}
+
+static void dashboard_reload_target(RenderTexture2D *target, int size) {
+    if (target->id != 0 && target->texture.width == size) {
+        return;
+    }
+    if (target->id != 0) {
+        UnloadRenderTexture(*target);
+    }
+    *target = LoadRenderTexture(size, size);
+}
+
+// Redraws the stale render targets. Must run outside of any texture mode, so
+// before the frame (or a recorded frame) is begun.
+void dashboard_update(Dashboard *db, Font *font, float *angles, int angle_count) {
+    if (db->count == 0) {
+        return;
+    }
+    if (db->layer_dirty) {
+        float half = db->layer_radius * (1 + DASHBOARD_MARGIN);
+        dashboard_reload_target(&db->layer, (int)ceilf(half * 2));
+        UnitCircle uc = {
+            .position = { half - db->layer_radius, half - db->layer_radius },
+            .center = { half, half },
+            .radius = db->layer_radius,
+        };
+        BeginTextureMode(db->layer);
+        ClearBackground(BLACK);
+        dashboard_draw_static(&uc, font, angles, angle_count);
+        EndTextureMode();
+        // The smaller circles sample the layer scaled down.
+        GenTextureMipmaps(&db->layer.texture);
+        SetTextureFilter(db->layer.texture, TEXTURE_FILTER_TRILINEAR);
+        db->layer_dirty = false;
+    }
+    for (int i = 0; i < db->count; i++) {
+        DashboardCircle *dc = &db->circles[i];
+        if (!dc->dirty) {
+            continue;
+        }
+        dashboard_reload_target(&dc->target, (int)dc->cell.width);
+        // Drawn relative to the cell, the circle's own state stays in window coordinates.
+        UnitCircle uc = dc->circle;
+        uc.position = (Vector2){ uc.position.x - dc->cell.x, uc.position.y - dc->cell.y };
+        uc.center = (Vector2){ uc.center.x - dc->cell.x, uc.center.y - dc->cell.y };
+        uc.point = (Vector2){ uc.point.x - dc->cell.x, uc.point.y - dc->cell.y };
+        float half = db->layer.texture.width * (uc.radius / db->layer_radius) / 2;
+        BeginTextureMode(dc->target);
+        ClearBackground(BLACK);
+        render_target(db->layer, (Rectangle){ uc.center.x - half, uc.center.y - half, half * 2, half * 2 });
+        dashboard_draw_angle(&uc, font);
+        EndTextureMode();
+        dc->dirty = false;
+    }
+}
+
+void dashboard_draw(Dashboard *db, Font *font, float *angles, int angle_count) {
+    bool direct = db->direct || render_is_vector();
+    for (int i = 0; i < db->count; i++) {
+        DashboardCircle *dc = &db->circles[i];
+        if (!direct && !dc->dirty && dc->target.id != 0) {
+            render_target(dc->target, dc->cell);
+            continue;
+        }
+        dashboard_draw_static(&dc->circle, font, angles, angle_count);
+        dashboard_draw_angle(&dc->circle, font);
+    }
+}
@@ -0,0 +1,320 @@
+#include "main.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The pyramid is an on-disk index next to the sample file ("<path>.mmpyr").
+// Level 0 holds the min/max of every DATASET_BLOCK samples, and every level
+// above folds DATASET_FACTOR entries of the level below into one.
+#define DATASET_PYRAMID_MAGIC "TRIGPYR1"
+#define DATASET_BLOCK 256
+#define DATASET_FACTOR 8
+#define DATASET_MAX_LEVELS 16
+#define DATASET_RAW_SCAN_LIMIT (DATASET_BLOCK*2)
+#define DATASET_MAX_COLUMNS 4096
+
+typedef struct DatasetPyramidHeader {
+    char magic[8];
+    uint64_t sample_count;
+    int64_t source_mod_time;
+    uint32_t block;
+    uint32_t factor;
+    uint32_t level_count;
+    uint32_t reserved;
+    uint64_t level_offsets[DATASET_MAX_LEVELS];
+    uint64_t level_counts[DATASET_MAX_LEVELS];
+} DatasetPyramidHeader;
+
+struct Dataset {
+    char path[512];
+    char pyramid_path[520];
+    MappedFile samples_file;
+    const float *samples;
+    uint64_t count;
+    double x_step;
+    MappedFile pyramid_file;
+    const DatasetPyramidHeader *pyramid;
+    atomic_bool pyramid_ready;
+    atomic_bool cancel_build;
+    pthread_t builder;
+    bool builder_running;
+    Range columns[DATASET_MAX_COLUMNS];
+};
+
+static inline const Range *dataset_pyramid_level(const DatasetPyramidHeader *header, uint32_t level) {
+    return (const Range *)((const char *)header + header->level_offsets[level]);
+}
+
+static inline Range dataset_range_merge(Range a, Range b) {
+    return (Range) {
+        (b.min < a.min) ? b.min : a.min,
+        (b.max > a.max) ? b.max : a.max,
+    };
+}
+
+static Range dataset_scan_raw(const float *samples, uint64_t start, uint64_t end) {
+    Range result = { INFINITY, -INFINITY };
+    for (uint64_t i = start; i < end; i++) {
+        float v = samples[i];
+        if (v < result.min) result.min = v;
+        if (v > result.max) result.max = v;
+    }
+    return result;
+}
+
+// Entries in each level for count samples, returns the number of levels.
+static uint32_t dataset_pyramid_level_counts(uint64_t count, uint64_t *level_counts) {
+    uint32_t levels = 0;
+    uint64_t entries = (count + DATASET_BLOCK - 1) / DATASET_BLOCK;
+    while (levels < DATASET_MAX_LEVELS) {
+        level_counts[levels++] = entries;
+        if (entries <= 1) {
+            break;
+        }
+        entries = (entries + DATASET_FACTOR - 1) / DATASET_FACTOR;
+    }
+    return levels;
+}
+
+// The levels are read straight out of the mapping, so a stale or damaged file
+// is rejected unless every level has the expected entries inside the file.
+static bool dataset_pyramid_is_valid(Dataset *ds, const DatasetPyramidHeader *header, uint64_t size) {
+    if (!(
+        size >= sizeof(DatasetPyramidHeader) &&
+        memcmp(header->magic, DATASET_PYRAMID_MAGIC, 8) == 0 &&
+        header->sample_count == ds->count &&
+        header->source_mod_time == (int64_t)GetFileModTime(ds->path) &&
+        header->block == DATASET_BLOCK &&
+        header->factor == DATASET_FACTOR
+    )) {
+        return false;
+    }
+    uint64_t level_counts[DATASET_MAX_LEVELS];
+    if (header->level_count != dataset_pyramid_level_counts(ds->count, level_counts)) {
+        return false;
+    }
+    for (uint32_t level = 0; level < header->level_count; level++) {
+        uint64_t offset = header->level_offsets[level];
+        if (
+            header->level_counts[level] != level_counts[level] ||
+            offset < sizeof(DatasetPyramidHeader) ||
+            offset % sizeof(float) != 0 ||
+            offset > size ||
+            level_counts[level] > (size - offset) / sizeof(Range)
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool dataset_pyramid_open(Dataset *ds) {
+    if (!platform_map_file_read(ds->pyramid_path, &ds->pyramid_file)) {
+        return false;
+    }
+    const DatasetPyramidHeader *header = ds->pyramid_file.data;
+    if (!dataset_pyramid_is_valid(ds, header, ds->pyramid_file.size)) {
+        platform_unmap_file(&ds->pyramid_file);
+        return false;
+    }
+    ds->pyramid = header;
+    atomic_store_explicit(&ds->pyramid_ready, true, memory_order_release);
+    return true;
+}
+
+static void *dataset_pyramid_build(void *arg) {
+    Dataset *ds = arg;
+
+    DatasetPyramidHeader header = {0};
+    memcpy(header.magic, DATASET_PYRAMID_MAGIC, 8);
+    header.sample_count = ds->count;
+    header.source_mod_time = (int64_t)GetFileModTime(ds->path);
+    header.block = DATASET_BLOCK;
+    header.factor = DATASET_FACTOR;
+
+    uint64_t offset = sizeof(DatasetPyramidHeader);
+    header.level_count = dataset_pyramid_level_counts(ds->count, header.level_counts);
+    for (uint32_t level = 0; level < header.level_count; level++) {
+        header.level_offsets[level] = offset;
+        offset += header.level_counts[level] * sizeof(Range);
+    }
+
+    char temp_path[528];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", ds->pyramid_path);
+    MappedFile out;
+    if (!platform_map_file_write(temp_path, offset, &out)) {
+        TraceLog(LOG_WARNING, "DATASET: Failed to create pyramid [%s]", temp_path);
+        return NULL;
+    }
+    memcpy(out.data, &header, sizeof(header));
+
+    Range *level0 = (Range *)((char *)out.data + header.level_offsets[0]);
+    for (uint64_t b = 0; b < header.level_counts[0]; b++) {
+        if ((b & 0xffff) == 0 && atomic_load(&ds->cancel_build)) {
+            platform_unmap_file(&out);
+            remove(temp_path);
+            return NULL;
+        }
+        uint64_t start = b * DATASET_BLOCK;
+        uint64_t end = (start + DATASET_BLOCK < ds->count) ? (start + DATASET_BLOCK) : ds->count;
+        level0[b] = dataset_scan_raw(ds->samples, start, end);
+    }
+    for (uint32_t level = 1; level < header.level_count; level++) {
+        const Range *below = (const Range *)((char *)out.data + header.level_offsets[level-1]);
+        Range *current = (Range *)((char *)out.data + header.level_offsets[level]);
+        uint64_t below_count = header.level_counts[level-1];
+        for (uint64_t b = 0; b < header.level_counts[level]; b++) {
+            Range r = below[b * DATASET_FACTOR];
+            for (uint64_t k = 1; k < DATASET_FACTOR && (b * DATASET_FACTOR + k) < below_count; k++) {
+                r = dataset_range_merge(r, below[b * DATASET_FACTOR + k]);
+            }
+            current[b] = r;
+        }
+    }
+    platform_unmap_file(&out);
+
+    remove(ds->pyramid_path);
+    if (rename(temp_path, ds->pyramid_path) != 0 || !dataset_pyramid_open(ds)) {
+        TraceLog(LOG_WARNING, "DATASET: Failed to open pyramid [%s]", ds->pyramid_path);
+        return NULL;
+    }
+    TraceLog(LOG_INFO, "DATASET: Pyramid ready [%s] %u levels", ds->pyramid_path, header.level_count);
+    return NULL;
+}
+
+Dataset *dataset_open(const char *path, Domain domain) {
+    Dataset *ds = calloc(1, sizeof(Dataset));
+    snprintf(ds->path, sizeof(ds->path), "%s", path);
+    snprintf(ds->pyramid_path, sizeof(ds->pyramid_path), "%s.mmpyr", path);
+    if (!platform_map_file_read(path, &ds->samples_file)) {
+        TraceLog(LOG_WARNING, "DATASET: Failed to map [%s]", path);
+        free(ds);
+        return NULL;
+    }
+    ds->samples = ds->samples_file.data;
+    ds->count = ds->samples_file.size / sizeof(float);
+    if (ds->count == 0) {
+        TraceLog(LOG_WARNING, "DATASET: No samples in [%s]", path);
+        platform_unmap_file(&ds->samples_file);
+        free(ds);
+        return NULL;
+    }
+    ds->x_step = (domain.max - domain.min) / (double)ds->count;
+    atomic_init(&ds->pyramid_ready, false);
+    atomic_init(&ds->cancel_build, false);
+
+    if (!dataset_pyramid_open(ds)) {
+        ds->builder_running = pthread_create(&ds->builder, NULL, dataset_pyramid_build, ds) == 0;
+    }
+    TraceLog(LOG_INFO, "DATASET: Mapped [%s] %llu samples", path, (unsigned long long)ds->count);
+    return ds;
+}
+
+void dataset_close(Dataset *ds) {
+    if (ds->builder_running) {
+        atomic_store(&ds->cancel_build, true);
+        pthread_join(ds->builder, NULL);
+    }
+    if (ds->pyramid != NULL) {
+        platform_unmap_file(&ds->pyramid_file);
+    }
+    platform_unmap_file(&ds->samples_file);
+    free(ds);
+}
+
+// Every column costs at most DATASET_RAW_SCAN_LIMIT raw samples or
+// DATASET_FACTOR+1 pyramid entries, no matter how many samples it covers.
+static Range dataset_query(Dataset *ds, uint64_t start, uint64_t end) {
+    uint64_t length = end - start;
+    if (length <= DATASET_RAW_SCAN_LIMIT) {
+        return dataset_scan_raw(ds->samples, start, end);
+    }
+    if (!atomic_load_explicit(&ds->pyramid_ready, memory_order_acquire)) {
+        Range result = { INFINITY, -INFINITY };
+        uint64_t stride = length / DATASET_RAW_SCAN_LIMIT;
+        for (uint64_t i = start; i < end; i += stride) {
+            float v = ds->samples[i];
+            if (v < result.min) result.min = v;
+            if (v > result.max) result.max = v;
+        }
+        return result;
+    }
+    uint32_t level = 0;
+    uint64_t bucket = DATASET_BLOCK;
+    while (level + 1 < ds->pyramid->level_count && bucket * DATASET_FACTOR <= length) {
+        bucket *= DATASET_FACTOR;
+        level++;
+    }
+    const Range *entries = dataset_pyramid_level(ds->pyramid, level);
+    Range result = { INFINITY, -INFINITY };
+    for (uint64_t b = start / bucket; b <= (end - 1) / bucket; b++) {
+        result = dataset_range_merge(result, entries[b]);
+    }
+    return result;
+}
+
+int dataset_decimate(Dataset *ds, Domain view, int column_count) {
+    if (column_count > DATASET_MAX_COLUMNS) {
+        column_count = DATASET_MAX_COLUMNS;
+    }
+    double column_span = (view.max - view.min) / column_count;
+    for (int c = 0; c < column_count; c++) {
+        double first = (view.min + column_span * c) / ds->x_step;
+        double last = (view.min + column_span * (c+1)) / ds->x_step;
+        if (last <= 0 || first >= (double)ds->count) {
+            ds->columns[c] = (Range) { INFINITY, -INFINITY };
+            continue;
+        }
+        uint64_t start = (first < 0) ? 0 : (uint64_t)first;
+        uint64_t end = (last > (double)ds->count) ? ds->count : (uint64_t)ceil(last);
+        if (end <= start) {
+            end = start + 1;
+        }
+        ds->columns[c] = dataset_query(ds, start, end);
+    }
+    return column_count;
+}
+
+void dataset_draw(Dataset *ds, TrigonometricFunction *tf, Color color) {
+    float top = tf->position.y;
+    float bottom = tf->position.y + tf->size.y;
+    double samples_in_view = (tf->domain.max - tf->domain.min) / ds->x_step;
+
+    if (samples_in_view < tf->size.x) {
+        double first = floor(tf->domain.min / ds->x_step);
+        double last = ceil(tf->domain.max / ds->x_step);
+        if (first < 0) first = 0;
+        if (last > (double)ds->count - 1) last = (double)ds->count - 1;
+        Vector2 prev = {0};
+        for (double i = first; i <= last; i++) {
+            float y = trigonometric_function_value_to_y(tf, ds->samples[(uint64_t)i]);
+            Vector2 next = {
+                trigonometric_function_domain_to_x(tf, i * ds->x_step),
+                (y < top) ? top : ((y > bottom) ? bottom : y),
+            };
+            if (i > first) {
+                render_line(prev, next, LINE_SMALL, color);
+            }
+            prev = next;
+        }
+        return;
+    }
+
+    int column_count = dataset_decimate(ds, tf->domain, (int)tf->size.x);
+    for (int c = 0; c < column_count; c++) {
+        Range r = ds->columns[c];
+        if (r.min > r.max) {
+            continue;
+        }
+        float y_max = trigonometric_function_value_to_y(tf, r.max);
+        float y_min = trigonometric_function_value_to_y(tf, r.min);
+        if (y_max < top) y_max = top;
+        if (y_min > bottom) y_min = bottom;
+        if (y_max > bottom || y_min < top) {
+            continue;
+        }
+        float x = tf->position.x + c + 0.5f;
+        render_line((Vector2){x, y_max}, (Vector2){x, y_min + 1}, LINE_SMALL, color);
+    }
+}
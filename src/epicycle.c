@@ -0,0 +1,321 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+// A chain of rotating circles anchored at the unit circle's center whose tip
+// draws a closed path. The circles are the Fourier coefficients of the path,
+// largest first. Time runs in fixed ticks, so every circle turns by the same
+// angle each tick and its phasor advances by one complex multiply with a
+// rotation computed once per shape. The rounding that builds up is bounded by
+// rescaling every phasor to its amplitude every few ticks, and by restarting
+// from the exact coefficients at the end of every turn. The tip is kept in a
+// ring buffer covering one turn and drawn as a single strip.
+
+#define EPICYCLE_SAMPLES 16384 // points of the path transformed, the most circles there can be
+#define EPICYCLE_DEFAULT_TERMS 1000
+#define EPICYCLE_MAX_TERMS 10000
+#define EPICYCLE_MIN_AMPLITUDE 1e-12f // zero coefficients cannot be renormalized
+#define EPICYCLE_TICKS 4096 // per turn, also the length of the trace
+#define EPICYCLE_TICKS_PER_SECOND 512
+#define EPICYCLE_MAX_TICKS_PER_FRAME 64
+#define EPICYCLE_RENORMALIZE 64 // ticks between rescaling the phasors
+#define EPICYCLE_MAX_CIRCLES 256 // drawn, the rest of the chain is only its arms
+#define EPICYCLE_MIN_CIRCLE_PIXELS 2.0f
+
+typedef enum EpicycleShape {
+    EPICYCLE_OFF,
+    EPICYCLE_SQUARE,
+    EPICYCLE_STAR,
+    EPICYCLE_SHAPE_COUNT,
+} EpicycleShape;
+
+typedef struct Epicycle {
+    EpicycleShape shape;
+    int terms; // circles in the chain
+    int available; // non-zero coefficients of the shape
+    int tick; // in [0, EPICYCLE_TICKS)
+    float pending; // fraction of a tick carried over to the next frame
+    int *frequency; // turns per turn of the path
+    float *amplitude; // the float arrays share one allocation of 7*EPICYCLE_SAMPLES
+    float *start_re; // phasors at tick 0, the coefficients
+    float *start_im;
+    float *step_re; // rotation by one tick
+    float *step_im;
+    float *re; // phasors at the current tick
+    float *im;
+    Vector2 *trace; // tips in radii from the center, y up, oldest at trace_head once full
+    int trace_head;
+    int trace_count;
+    Vector2 *strip; // screen points of the chain or the unrolled trace
+} Epicycle;
+
+typedef struct EpicycleTerm {
+    float amplitude;
+    int index;
+} EpicycleTerm;
+
+static const char *const epicycle_shape_names[EPICYCLE_SHAPE_COUNT] = { "off", "square", "star" };
+
+void epicycle_free(Epicycle *ep) {
+    free(ep->frequency);
+    free(ep->amplitude);
+    free(ep->trace);
+    *ep = (Epicycle){0};
+}
+
+// Closed polygon in radii, counterclockwise.
+static int epicycle_shape_vertices(EpicycleShape shape, Vector2 *vertices) {
+    if (shape == EPICYCLE_SQUARE) {
+        vertices[0] = (Vector2){ 0.7f, 0.7f };
+        vertices[1] = (Vector2){ -0.7f, 0.7f };
+        vertices[2] = (Vector2){ -0.7f, -0.7f };
+        vertices[3] = (Vector2){ 0.7f, -0.7f };
+        return 4;
+    }
+    for (int i = 0; i < 10; i++) {
+        float rad = (float)(TRIG_PI/2 + TRIG_PI/5 * i);
+        float r = (i % 2 == 0) ? 0.9f : 0.36f;
+        vertices[i] = (Vector2){ r * cosf(rad), r * sinf(rad) };
+    }
+    return 10;
+}
+
+// Samples the shape evenly along its perimeter into re, im.
+static void epicycle_sample_shape(EpicycleShape shape, float *re, float *im) {
+    Vector2 vertices[10];
+    int count = epicycle_shape_vertices(shape, vertices);
+    float perimeter = 0;
+    for (int i = 0; i < count; i++) {
+        Vector2 a = vertices[i], b = vertices[(i + 1) % count];
+        perimeter += hypotf(b.x - a.x, b.y - a.y);
+    }
+    int edge = 0;
+    float edge_start = 0;
+    for (int s = 0; s < EPICYCLE_SAMPLES; s++) {
+        float length = perimeter * s / EPICYCLE_SAMPLES;
+        Vector2 a = vertices[edge], b = vertices[(edge + 1) % count];
+        float edge_length = hypotf(b.x - a.x, b.y - a.y);
+        while (length > edge_start + edge_length && edge < count - 1) {
+            edge_start += edge_length;
+            edge++;
+            a = vertices[edge];
+            b = vertices[(edge + 1) % count];
+            edge_length = hypotf(b.x - a.x, b.y - a.y);
+        }
+        float t = (length - edge_start) / edge_length;
+        re[s] = a.x + (b.x - a.x) * t;
+        im[s] = a.y + (b.y - a.y) * t;
+    }
+}
+
+static int epicycle_compare_terms(const void *a, const void *b) {
+    float x = ((const EpicycleTerm *)a)->amplitude, y = ((const EpicycleTerm *)b)->amplitude;
+    return (x < y) - (x > y);
+}
+
+// The coefficients of the shape, largest first, with their rotation per tick.
+static void epicycle_load_shape(Epicycle *ep, EpicycleShape shape) {
+    if (ep->amplitude == NULL) {
+        ep->frequency = malloc(sizeof(int) * EPICYCLE_SAMPLES);
+        ep->amplitude = malloc(sizeof(float) * 7 * EPICYCLE_SAMPLES);
+        ep->start_re = ep->amplitude + EPICYCLE_SAMPLES;
+        ep->start_im = ep->start_re + EPICYCLE_SAMPLES;
+        ep->step_re = ep->start_im + EPICYCLE_SAMPLES;
+        ep->step_im = ep->step_re + EPICYCLE_SAMPLES;
+        ep->re = ep->step_im + EPICYCLE_SAMPLES;
+        ep->im = ep->re + EPICYCLE_SAMPLES;
+        ep->trace = malloc(sizeof(Vector2) * (EPICYCLE_TICKS + EPICYCLE_MAX_TERMS + 1));
+        ep->strip = ep->trace + EPICYCLE_TICKS;
+    }
+    epicycle_sample_shape(shape, ep->re, ep->im);
+    fft_forward(ep->re, ep->im, EPICYCLE_SAMPLES);
+
+    EpicycleTerm *terms = malloc(sizeof(EpicycleTerm) * EPICYCLE_SAMPLES);
+    for (int k = 0; k < EPICYCLE_SAMPLES; k++) {
+        terms[k] = (EpicycleTerm){ hypotf(ep->re[k], ep->im[k]) / EPICYCLE_SAMPLES, k };
+    }
+    qsort(terms, EPICYCLE_SAMPLES, sizeof(EpicycleTerm), epicycle_compare_terms);
+    ep->available = 0;
+    for (int j = 0; j < EPICYCLE_SAMPLES && terms[j].amplitude > EPICYCLE_MIN_AMPLITUDE; j++) {
+        int k = terms[j].index;
+        int frequency = (k < EPICYCLE_SAMPLES/2) ? k : k - EPICYCLE_SAMPLES;
+        double rad = TRIG_PI*2 * (((frequency % EPICYCLE_TICKS) + EPICYCLE_TICKS) % EPICYCLE_TICKS) / EPICYCLE_TICKS;
+        ep->frequency[j] = frequency;
+        ep->amplitude[j] = terms[j].amplitude;
+        ep->start_re[j] = ep->re[k] / EPICYCLE_SAMPLES;
+        ep->start_im[j] = ep->im[k] / EPICYCLE_SAMPLES;
+        ep->step_re[j] = (float)cos(rad);
+        ep->step_im[j] = (float)sin(rad);
+        ep->available++;
+    }
+    free(terms);
+    ep->shape = shape;
+}
+
+// Phasors [from, to) placed exactly at the current tick, for circles joining the chain.
+static void epicycle_seed(Epicycle *ep, int from, int to) {
+    for (int j = from; j < to; j++) {
+        int64_t turns = ((int64_t)ep->frequency[j] * ep->tick) % EPICYCLE_TICKS;
+        double rad = TRIG_PI*2 * (double)((turns + EPICYCLE_TICKS) % EPICYCLE_TICKS) / EPICYCLE_TICKS;
+        double c = cos(rad), s = sin(rad);
+        ep->re[j] = (float)(ep->start_re[j] * c - ep->start_im[j] * s);
+        ep->im[j] = (float)(ep->start_re[j] * s + ep->start_im[j] * c);
+    }
+}
+
+void epicycle_set_terms(Epicycle *ep, int terms) {
+    int limit = (ep->available < EPICYCLE_MAX_TERMS) ? ep->available : EPICYCLE_MAX_TERMS;
+    terms = (terms > limit) ? limit : (terms < 1) ? 1 : terms;
+    if (terms > ep->terms) {
+        epicycle_seed(ep, ep->terms, terms);
+    }
+    ep->terms = terms;
+    // The old trace belongs to another approximation of the shape.
+    ep->trace_head = 0;
+    ep->trace_count = 0;
+}
+
+// Next shape, keeping the number of circles (or starting at the default).
+void epicycle_cycle(Epicycle *ep) {
+    EpicycleShape shape = (EpicycleShape)((ep->shape + 1) % EPICYCLE_SHAPE_COUNT);
+    int terms = (ep->terms > 0) ? ep->terms : EPICYCLE_DEFAULT_TERMS;
+    if (shape == EPICYCLE_OFF) {
+        epicycle_free(ep);
+        return;
+    }
+    epicycle_load_shape(ep, shape);
+    ep->tick = 0;
+    ep->pending = 0;
+    ep->terms = 0;
+    epicycle_set_terms(ep, terms);
+}
+
+void epicycle_scale_terms(Epicycle *ep, float factor) {
+    if (ep->shape != EPICYCLE_OFF) {
+        epicycle_set_terms(ep, (int)(ep->terms * factor + 0.5f));
+    }
+}
+
+// Rescales every phasor to its amplitude, the drift of repeated rotations
+// is in the magnitude; the phase is reset at the end of the turn.
+static void epicycle_renormalize(Epicycle *ep) {
+    int j = 0;
+#ifdef __SSE__
+    for (; j + 4 <= ep->terms; j += 4) {
+        __m128 re = _mm_loadu_ps(ep->re + j);
+        __m128 im = _mm_loadu_ps(ep->im + j);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+        __m128 scale = _mm_div_ps(_mm_loadu_ps(ep->amplitude + j), length);
+        _mm_storeu_ps(ep->re + j, _mm_mul_ps(re, scale));
+        _mm_storeu_ps(ep->im + j, _mm_mul_ps(im, scale));
+    }
+#endif
+    for (; j < ep->terms; j++) {
+        float scale = ep->amplitude[j] / sqrtf(ep->re[j]*ep->re[j] + ep->im[j]*ep->im[j]);
+        ep->re[j] *= scale;
+        ep->im[j] *= scale;
+    }
+}
+
+// Turns every circle by one tick and returns where the tip ends up.
+static Vector2 epicycle_advance(Epicycle *ep) {
+    float tip_re = 0, tip_im = 0;
+    int j = 0;
+#ifdef __SSE__
+    __m128 sum_re = _mm_setzero_ps();
+    __m128 sum_im = _mm_setzero_ps();
+    for (; j + 4 <= ep->terms; j += 4) {
+        __m128 re = _mm_loadu_ps(ep->re + j);
+        __m128 im = _mm_loadu_ps(ep->im + j);
+        __m128 step_re = _mm_loadu_ps(ep->step_re + j);
+        __m128 step_im = _mm_loadu_ps(ep->step_im + j);
+        __m128 next_re = _mm_sub_ps(_mm_mul_ps(re, step_re), _mm_mul_ps(im, step_im));
+        __m128 next_im = _mm_add_ps(_mm_mul_ps(re, step_im), _mm_mul_ps(im, step_re));
+        _mm_storeu_ps(ep->re + j, next_re);
+        _mm_storeu_ps(ep->im + j, next_im);
+        sum_re = _mm_add_ps(sum_re, next_re);
+        sum_im = _mm_add_ps(sum_im, next_im);
+    }
+    float lanes_re[4], lanes_im[4];
+    _mm_storeu_ps(lanes_re, sum_re);
+    _mm_storeu_ps(lanes_im, sum_im);
+    tip_re = (lanes_re[0] + lanes_re[1]) + (lanes_re[2] + lanes_re[3]);
+    tip_im = (lanes_im[0] + lanes_im[1]) + (lanes_im[2] + lanes_im[3]);
+#endif
+    for (; j < ep->terms; j++) {
+        float re = ep->re[j], im = ep->im[j];
+        ep->re[j] = re * ep->step_re[j] - im * ep->step_im[j];
+        ep->im[j] = re * ep->step_im[j] + im * ep->step_re[j];
+        tip_re += ep->re[j];
+        tip_im += ep->im[j];
+    }
+    ep->tick++;
+    if (ep->tick == EPICYCLE_TICKS) {
+        ep->tick = 0;
+        memcpy(ep->re, ep->start_re, sizeof(float) * ep->terms);
+        memcpy(ep->im, ep->start_im, sizeof(float) * ep->terms);
+    } else if (ep->tick % EPICYCLE_RENORMALIZE == 0) {
+        epicycle_renormalize(ep);
+    }
+    return (Vector2){ tip_re, tip_im };
+}
+
+void epicycle_update(Epicycle *ep, float dt) {
+    if (ep->shape == EPICYCLE_OFF) {
+        return;
+    }
+    ep->pending += dt * EPICYCLE_TICKS_PER_SECOND;
+    int ticks = (int)ep->pending;
+    ep->pending -= ticks;
+    ticks = (ticks > EPICYCLE_MAX_TICKS_PER_FRAME) ? EPICYCLE_MAX_TICKS_PER_FRAME : ticks;
+    for (int i = 0; i < ticks; i++) {
+        Vector2 tip = epicycle_advance(ep);
+        ep->trace[(ep->trace_head + ep->trace_count) % EPICYCLE_TICKS] = tip;
+        if (ep->trace_count < EPICYCLE_TICKS) {
+            ep->trace_count++;
+        } else {
+            ep->trace_head = (ep->trace_head + 1) % EPICYCLE_TICKS;
+        }
+    }
+}
+
+void epicycle_draw(Epicycle *ep, UnitCircle *uc, Font *font) {
+    if (ep->shape == EPICYCLE_OFF) {
+        return;
+    }
+    const float r = uc->radius;
+    Vector2 joint = uc->center;
+    ep->strip[0] = joint;
+    for (int j = 0; j < ep->terms; j++) {
+        joint.x += ep->re[j] * r;
+        joint.y -= ep->im[j] * r;
+        ep->strip[j + 1] = joint;
+    }
+    Color circle_color = ColorAlpha(MAIN_COL, 0.25f);
+    for (int j = 0; j < ep->terms && j < EPICYCLE_MAX_CIRCLES; j++) {
+        if (ep->amplitude[j] * r < EPICYCLE_MIN_CIRCLE_PIXELS) {
+            break;
+        }
+        render_circle_lines(ep->strip[j], ep->amplitude[j] * r, circle_color);
+    }
+    render_line_strip(ep->strip, ep->terms + 1, ColorAlpha(MAIN_COL, 0.6f));
+
+    // The strip buffer is free again once the chain is submitted.
+    for (int i = 0; i < ep->trace_count; i++) {
+        Vector2 tip = ep->trace[(ep->trace_head + i) % EPICYCLE_TICKS];
+        ep->strip[i] = (Vector2){ uc->center.x + tip.x * r, uc->center.y - tip.y * r };
+    }
+    render_line_strip(ep->strip, ep->trace_count, EPICYCLE_COL);
+
+    draw_text_centered(
+        font,
+        TEXT_FLAG_BACKING_RECTANGLE,
+        (Vector2){uc->center.x, uc->center.y + uc->radius * 1.4f + layout.label_offset * 2},
+        0,
+        TextFormat("epicycles: %s, %d circles", epicycle_shape_names[ep->shape], ep->terms),
+        EPICYCLE_COL
+    );
+}
@@ -0,0 +1,614 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// User typed functions of x, e.g. "2*sin(3x+1) - cos(x)^2", or relations
+// between x and y such as "sin(x) = cos(y)" for implicit plots. The source is
+// parsed into a small tree, constant subtrees are folded while parsing, and
+// the tree is compiled to three-address register code. Evaluation runs every
+// instruction over a whole block of samples, so the dispatch cost is paid
+// once per EXPRESSION_BATCH samples instead of once per sample and node.
+// The same code also runs on intervals, giving bounds of the expression over
+// whole rectangles of (x, y) for the implicit plotter.
+
+#define EXPRESSION_MAX_SOURCE 128
+#define EXPRESSION_MAX_NODES 128
+#define EXPRESSION_MAX_CODE 128
+#define EXPRESSION_MAX_REGISTERS 32
+#define EXPRESSION_MAX_CONSTANTS 16
+#define EXPRESSION_BATCH 256
+#define EXPRESSION_X_REGISTER 0
+#define EXPRESSION_Y_REGISTER 1
+#define EXPRESSION_FIRST_CONSTANT 2
+
+typedef enum ExpressionOp {
+    EXPRESSION_OP_CONSTANT,
+    EXPRESSION_OP_X,
+    EXPRESSION_OP_Y,
+    EXPRESSION_OP_ADD,
+    EXPRESSION_OP_SUB,
+    EXPRESSION_OP_MUL,
+    EXPRESSION_OP_DIV,
+    EXPRESSION_OP_POW,
+    EXPRESSION_OP_NEG,
+    EXPRESSION_OP_SQUARE,
+    EXPRESSION_OP_SIN,
+    EXPRESSION_OP_COS,
+    EXPRESSION_OP_TAN,
+    EXPRESSION_OP_ASIN,
+    EXPRESSION_OP_ACOS,
+    EXPRESSION_OP_ATAN,
+    EXPRESSION_OP_SQRT,
+    EXPRESSION_OP_ABS,
+    EXPRESSION_OP_EXP,
+    EXPRESSION_OP_LOG,
+    EXPRESSION_OP_FUNCTION_FIRST = EXPRESSION_OP_SIN,
+} ExpressionOp;
+
+static const char *expression_function_names[] = {
+    "sin", "cos", "tan", "asin", "acos", "atan", "sqrt", "abs", "exp", "log",
+};
+
+// A relation compiles to lhs - rhs compared against zero.
+typedef enum ExpressionRelation {
+    EXPRESSION_RELATION_NONE,
+    EXPRESSION_RELATION_EQUAL,
+    EXPRESSION_RELATION_LESS,
+    EXPRESSION_RELATION_GREATER,
+} ExpressionRelation;
+
+typedef struct Interval {
+    float min;
+    float max;
+} Interval;
+
+typedef struct ExpressionInstruction {
+    uint8_t op;
+    uint8_t dst;
+    uint8_t a;
+    uint8_t b;
+} ExpressionInstruction;
+
+// Registers: 0 is x, 1 is y, then the constants, then temporaries.
+typedef struct Expression {
+    char source[EXPRESSION_MAX_SOURCE];
+    ExpressionRelation relation;
+    ExpressionInstruction code[EXPRESSION_MAX_CODE];
+    int code_count;
+    float constants[EXPRESSION_MAX_CONSTANTS];
+    int constant_count;
+    int register_count;
+    int result;
+} Expression;
+
+typedef struct ExpressionNode {
+    ExpressionOp op;
+    float value;
+    int a;
+    int b;
+} ExpressionNode;
+
+typedef struct ExpressionParser {
+    const char *at;
+    ExpressionNode nodes[EXPRESSION_MAX_NODES];
+    int node_count;
+    const char *error;
+    Expression *expression;
+    int temp_top;
+} ExpressionParser;
+
+static float expression_apply(ExpressionOp op, float a, float b) {
+    switch (op) {
+    case EXPRESSION_OP_ADD: return a + b;
+    case EXPRESSION_OP_SUB: return a - b;
+    case EXPRESSION_OP_MUL: return a * b;
+    case EXPRESSION_OP_DIV: return a / b;
+    case EXPRESSION_OP_POW: return powf(a, b);
+    case EXPRESSION_OP_NEG: return -a;
+    case EXPRESSION_OP_SQUARE: return a * a;
+    case EXPRESSION_OP_SIN: return trig_sin(a);
+    case EXPRESSION_OP_COS: return trig_cos(a);
+    case EXPRESSION_OP_TAN: return trig_tan(a);
+    case EXPRESSION_OP_ASIN: return asinf(a);
+    case EXPRESSION_OP_ACOS: return acosf(a);
+    case EXPRESSION_OP_ATAN: return atanf(a);
+    case EXPRESSION_OP_SQRT: return sqrtf(a);
+    case EXPRESSION_OP_ABS: return fabsf(a);
+    case EXPRESSION_OP_EXP: return expf(a);
+    case EXPRESSION_OP_LOG: return logf(a);
+    default: return 0;
+    }
+}
+
+static int expression_node(ExpressionParser *p, ExpressionOp op, float value, int a, int b) {
+    if (p->node_count == EXPRESSION_MAX_NODES) {
+        p->error = "expression too long";
+        return 0;
+    }
+    p->nodes[p->node_count] = (ExpressionNode) { op, value, a, b };
+    return p->node_count++;
+}
+
+static bool expression_is_unary(ExpressionOp op) {
+    return op == EXPRESSION_OP_NEG || op == EXPRESSION_OP_SQUARE || op >= EXPRESSION_OP_FUNCTION_FIRST;
+}
+
+static bool expression_is_constant(ExpressionParser *p, int node, float value) {
+    return p->nodes[node].op == EXPRESSION_OP_CONSTANT && p->nodes[node].value == value;
+}
+
+// Folds constant operands and a few identities before a node is created.
+static int expression_fold(ExpressionParser *p, ExpressionOp op, int a, int b) {
+    bool a_constant = p->nodes[a].op == EXPRESSION_OP_CONSTANT;
+    bool unary = expression_is_unary(op);
+    if (a_constant && (unary || p->nodes[b].op == EXPRESSION_OP_CONSTANT)) {
+        float value = expression_apply(op, p->nodes[a].value, unary ? 0 : p->nodes[b].value);
+        return expression_node(p, EXPRESSION_OP_CONSTANT, value, 0, 0);
+    }
+    if (!unary) {
+        if ((op == EXPRESSION_OP_ADD && expression_is_constant(p, a, 0)) || (op == EXPRESSION_OP_MUL && expression_is_constant(p, a, 1))) {
+            return b;
+        }
+        if (((op == EXPRESSION_OP_ADD || op == EXPRESSION_OP_SUB) && expression_is_constant(p, b, 0)) ||
+            ((op == EXPRESSION_OP_MUL || op == EXPRESSION_OP_DIV || op == EXPRESSION_OP_POW) && expression_is_constant(p, b, 1))
+        ) {
+            return a;
+        }
+        if (op == EXPRESSION_OP_POW && expression_is_constant(p, b, 2)) {
+            return expression_node(p, EXPRESSION_OP_SQUARE, 0, a, 0);
+        }
+    }
+    return expression_node(p, op, 0, a, b);
+}
+
+static void expression_skip_space(ExpressionParser *p) {
+    while (*p->at == ' ' || *p->at == '\t') {
+        p->at++;
+    }
+}
+
+static int expression_parse_sum(ExpressionParser *p);
+static int expression_parse_unary(ExpressionParser *p);
+
+static bool expression_starts_primary(ExpressionParser *p) {
+    expression_skip_space(p);
+    char c = *p->at;
+    return (c >= '0' && c <= '9') || c == '.' || c == '(' || (c >= 'a' && c <= 'z');
+}
+
+static int expression_parse_primary(ExpressionParser *p) {
+    expression_skip_space(p);
+    const char *start = p->at;
+    if ((*start >= '0' && *start <= '9') || *start == '.') {
+        char *end;
+        float value = strtof(start, &end);
+        p->at = end;
+        return expression_node(p, EXPRESSION_OP_CONSTANT, value, 0, 0);
+    }
+    if (*start == '(') {
+        p->at++;
+        int node = expression_parse_sum(p);
+        expression_skip_space(p);
+        if (*p->at != ')') {
+            p->error = "missing ')'";
+            return 0;
+        }
+        p->at++;
+        return node;
+    }
+    int length = 0;
+    while (start[length] >= 'a' && start[length] <= 'z') {
+        length++;
+    }
+    if (length == 1 && (*start == 'x' || *start == 'y')) {
+        p->at++;
+        return expression_node(p, (*start == 'x') ? EXPRESSION_OP_X : EXPRESSION_OP_Y, 0, 0, 0);
+    }
+    if (length == 2 && strncmp(start, "pi", 2) == 0) {
+        p->at += 2;
+        return expression_node(p, EXPRESSION_OP_CONSTANT, (float)TRIG_PI, 0, 0);
+    }
+    if (length == 1 && *start == 'e') {
+        p->at++;
+        return expression_node(p, EXPRESSION_OP_CONSTANT, (float)2.71828182845904523536, 0, 0);
+    }
+    int function_count = sizeof(expression_function_names) / sizeof(expression_function_names[0]);
+    for (int i = 0; i < function_count; i++) {
+        if ((int)strlen(expression_function_names[i]) == length && strncmp(start, expression_function_names[i], length) == 0) {
+            p->at += length;
+            // The argument is a single primary, so cos(x)^2 squares the cosine.
+            int argument = expression_parse_primary(p);
+            return expression_fold(p, (ExpressionOp)(EXPRESSION_OP_FUNCTION_FIRST + i), argument, 0);
+        }
+    }
+    p->error = (length > 0) ? "unknown name" : "unexpected character";
+    return 0;
+}
+
+// '^' is right associative and binds tighter than unary minus: -x^2 = -(x^2).
+static int expression_parse_power(ExpressionParser *p) {
+    int base = expression_parse_primary(p);
+    expression_skip_space(p);
+    if (*p->at == '^') {
+        p->at++;
+        int exponent = expression_parse_unary(p);
+        return expression_fold(p, EXPRESSION_OP_POW, base, exponent);
+    }
+    return base;
+}
+
+static int expression_parse_unary(ExpressionParser *p) {
+    expression_skip_space(p);
+    if (*p->at == '-') {
+        p->at++;
+        return expression_fold(p, EXPRESSION_OP_NEG, expression_parse_unary(p), 0);
+    }
+    if (*p->at == '+') {
+        p->at++;
+    }
+    return expression_parse_power(p);
+}
+
+static int expression_parse_product(ExpressionParser *p) {
+    int node = expression_parse_unary(p);
+    while (p->error == NULL) {
+        expression_skip_space(p);
+        ExpressionOp op;
+        if (*p->at == '*' || *p->at == '/') {
+            op = (*p->at == '*') ? EXPRESSION_OP_MUL : EXPRESSION_OP_DIV;
+            p->at++;
+        } else if (expression_starts_primary(p)) {
+            op = EXPRESSION_OP_MUL;
+        } else {
+            break;
+        }
+        node = expression_fold(p, op, node, expression_parse_unary(p));
+    }
+    return node;
+}
+
+static int expression_parse_sum(ExpressionParser *p) {
+    int node = expression_parse_product(p);
+    while (p->error == NULL) {
+        expression_skip_space(p);
+        if (*p->at != '+' && *p->at != '-') {
+            break;
+        }
+        ExpressionOp op = (*p->at == '+') ? EXPRESSION_OP_ADD : EXPRESSION_OP_SUB;
+        p->at++;
+        node = expression_fold(p, op, node, expression_parse_product(p));
+    }
+    return node;
+}
+
+static int expression_constant_register(ExpressionParser *p, float value) {
+    Expression *e = p->expression;
+    for (int i = 0; i < e->constant_count; i++) {
+        if (e->constants[i] == value) {
+            return EXPRESSION_FIRST_CONSTANT + i;
+        }
+    }
+    if (e->constant_count == EXPRESSION_MAX_CONSTANTS) {
+        p->error = "too many constants";
+        return 0;
+    }
+    e->constants[e->constant_count] = value;
+    return EXPRESSION_FIRST_CONSTANT + e->constant_count++;
+}
+
+static bool expression_is_temp(ExpressionParser *p, int reg) {
+    return reg >= EXPRESSION_FIRST_CONSTANT + p->expression->constant_count;
+}
+
+static int expression_emit(ExpressionParser *p, ExpressionOp op, int dst, int a, int b) {
+    Expression *e = p->expression;
+    if (e->code_count == EXPRESSION_MAX_CODE || dst >= EXPRESSION_MAX_REGISTERS) {
+        p->error = "expression too complex";
+        return 0;
+    }
+    e->code[e->code_count++] = (ExpressionInstruction) { (uint8_t)op, (uint8_t)dst, (uint8_t)a, (uint8_t)b };
+    if (dst + 1 > e->register_count) {
+        e->register_count = dst + 1;
+    }
+    return dst;
+}
+
+// Only constants still reachable after folding get a register.
+static void expression_collect_constants(ExpressionParser *p, int node) {
+    ExpressionNode *n = &p->nodes[node];
+    if (n->op == EXPRESSION_OP_CONSTANT) {
+        expression_constant_register(p, n->value);
+    } else if (n->op != EXPRESSION_OP_X && n->op != EXPRESSION_OP_Y) {
+        expression_collect_constants(p, n->a);
+        if (!expression_is_unary(n->op)) {
+            expression_collect_constants(p, n->b);
+        }
+    }
+}
+
+// Temporaries are allocated as a stack: an operation writes over its first
+// temporary operand in place and releases the second one.
+static int expression_generate(ExpressionParser *p, int node) {
+    ExpressionNode *n = &p->nodes[node];
+    if (p->error != NULL) {
+        return 0;
+    }
+    if (n->op == EXPRESSION_OP_X) {
+        return EXPRESSION_X_REGISTER;
+    }
+    if (n->op == EXPRESSION_OP_Y) {
+        return EXPRESSION_Y_REGISTER;
+    }
+    if (n->op == EXPRESSION_OP_CONSTANT) {
+        return expression_constant_register(p, n->value);
+    }
+    bool unary = expression_is_unary(n->op);
+    int a = expression_generate(p, n->a);
+    int b = unary ? 0 : expression_generate(p, n->b);
+    if (!unary && expression_is_temp(p, b)) {
+        p->temp_top--;
+    }
+    int dst = a;
+    if (!expression_is_temp(p, a)) {
+        dst = p->temp_top++;
+    }
+    return expression_emit(p, n->op, dst, a, b);
+}
+
+// Returns NULL on success, otherwise a short description of the error.
+const char *expression_compile(Expression *e, const char *source) {
+    memset(e, 0, sizeof(*e));
+    snprintf(e->source, sizeof(e->source), "%s", source);
+    ExpressionParser *p = calloc(1, sizeof(ExpressionParser));
+    p->at = e->source;
+    p->expression = e;
+
+    int root = expression_parse_sum(p);
+    expression_skip_space(p);
+    char c = *p->at;
+    if (p->error == NULL && (c == '=' || c == '<' || c == '>')) {
+        // <= and >= plot the same as < and >, == the same as =.
+        p->at += (p->at[1] == '=') ? 2 : 1;
+        e->relation = (c == '=') ? EXPRESSION_RELATION_EQUAL : (c == '<') ? EXPRESSION_RELATION_LESS : EXPRESSION_RELATION_GREATER;
+        root = expression_fold(p, EXPRESSION_OP_SUB, root, expression_parse_sum(p));
+        expression_skip_space(p);
+    }
+    if (p->error == NULL && *p->at != '\0' && *p->at != '\n' && *p->at != '\r') {
+        p->error = "unexpected character";
+    }
+    if (p->error == NULL) {
+        // Constants get their registers first, so temporaries start after them.
+        expression_collect_constants(p, root);
+        p->temp_top = EXPRESSION_FIRST_CONSTANT + e->constant_count;
+        e->register_count = p->temp_top;
+        e->result = expression_generate(p, root);
+    }
+    const char *error = p->error;
+    free(p);
+    if (error != NULL) {
+        e->code_count = 0;
+    }
+    return error;
+}
+
+// y reads as 0, so a relation evaluates to lhs - rhs along the x axis.
+void expression_evaluate_batch(const Expression *e, const float *x, float *out, int count) {
+    float temps[EXPRESSION_MAX_REGISTERS][EXPRESSION_BATCH];
+    float *reg[EXPRESSION_MAX_REGISTERS];
+    for (int r = 1; r < e->register_count; r++) {
+        reg[r] = temps[r];
+    }
+    // Constant registers (and y) are filled once and stay valid for every block.
+    int filled = (count < EXPRESSION_BATCH) ? count : EXPRESSION_BATCH;
+    memset(temps[EXPRESSION_Y_REGISTER], 0, sizeof(float) * filled);
+    for (int c = 0; c < e->constant_count; c++) {
+        for (int i = 0; i < filled; i++) {
+            temps[EXPRESSION_FIRST_CONSTANT + c][i] = e->constants[c];
+        }
+    }
+
+    for (int first = 0; first < count; first += EXPRESSION_BATCH) {
+        int n = (count - first < EXPRESSION_BATCH) ? (count - first) : EXPRESSION_BATCH;
+        reg[EXPRESSION_X_REGISTER] = (float *)x + first;
+        for (int k = 0; k < e->code_count; k++) {
+            ExpressionInstruction in = e->code[k];
+            float *d = reg[in.dst];
+            const float *a = reg[in.a];
+            const float *b = reg[in.b];
+            switch ((ExpressionOp)in.op) {
+            case EXPRESSION_OP_ADD: for (int i = 0; i < n; i++) d[i] = a[i] + b[i]; break;
+            case EXPRESSION_OP_SUB: for (int i = 0; i < n; i++) d[i] = a[i] - b[i]; break;
+            case EXPRESSION_OP_MUL: for (int i = 0; i < n; i++) d[i] = a[i] * b[i]; break;
+            case EXPRESSION_OP_DIV: for (int i = 0; i < n; i++) d[i] = a[i] / b[i]; break;
+            case EXPRESSION_OP_POW: for (int i = 0; i < n; i++) d[i] = powf(a[i], b[i]); break;
+            case EXPRESSION_OP_NEG: for (int i = 0; i < n; i++) d[i] = -a[i]; break;
+            case EXPRESSION_OP_SQUARE: for (int i = 0; i < n; i++) d[i] = a[i] * a[i]; break;
+            case EXPRESSION_OP_SIN: trig_evaluate_batch_kind(TRIG_SIN, a, d, n); break;
+            case EXPRESSION_OP_COS: trig_evaluate_batch_kind(TRIG_COS, a, d, n); break;
+            case EXPRESSION_OP_TAN: trig_evaluate_batch_kind(TRIG_TAN, a, d, n); break;
+            default: for (int i = 0; i < n; i++) d[i] = expression_apply((ExpressionOp)in.op, a[i], 0); break;
+            }
+        }
+        const float *result = reg[e->result];
+        if (result != out + first) {
+            memcpy(out + first, result, sizeof(float) * n);
+        }
+    }
+}
+
+float expression_evaluate(const Expression *e, float x) {
+    float out;
+    expression_evaluate_batch(e, &x, &out, 1);
+    return out;
+}
+
+// Interval versions of the operations. An empty interval (no real value, such
+// as sqrt of a negative range) is NaN and propagates; an unbounded result is
+// [-inf, inf]. Bounds are not rounded outwards, which only matters for cells
+// touching the curve within float precision.
+
+#define INTERVAL_EMPTY ((Interval) { NAN, NAN })
+#define INTERVAL_ENTIRE ((Interval) { -INFINITY, INFINITY })
+
+static inline bool interval_is_empty(Interval a) {
+    return isnan(a.min);
+}
+
+static inline Interval interval_make(double a, double b) {
+    return (a <= b) ? (Interval) { (float)a, (float)b } : (Interval) { (float)b, (float)a };
+}
+
+static Interval interval_mul(Interval a, Interval b) {
+    float p[4] = { a.min * b.min, a.min * b.max, a.max * b.min, a.max * b.max };
+    Interval r = { p[0], p[0] };
+    for (int i = 0; i < 4; i++) {
+        if (isnan(p[i])) {
+            return INTERVAL_ENTIRE; // 0 * inf
+        }
+        r.min = fminf(r.min, p[i]);
+        r.max = fmaxf(r.max, p[i]);
+    }
+    return r;
+}
+
+static Interval interval_div(Interval a, Interval b) {
+    if (b.min <= 0 && b.max >= 0) {
+        return INTERVAL_ENTIRE;
+    }
+    return interval_mul(a, (Interval) { 1 / b.max, 1 / b.min });
+}
+
+static Interval interval_integer_power(Interval a, int n) {
+    if (n < 0) {
+        return interval_div((Interval) { 1, 1 }, interval_integer_power(a, -n));
+    }
+    double lo = pow(a.min, n), hi = pow(a.max, n);
+    if (n % 2 == 0 && a.min < 0 && a.max > 0) {
+        return (Interval) { 0, (float)fmax(lo, hi) };
+    }
+    return interval_make(lo, hi);
+}
+
+static Interval interval_pow(Interval a, Interval b) {
+    if (b.min == b.max && b.min == floorf(b.min) && fabsf(b.min) < 64) {
+        return interval_integer_power(a, (int)b.min);
+    }
+    if (a.max < 0) {
+        return INTERVAL_EMPTY;
+    }
+    if (a.min <= 0) {
+        return (Interval) { 0, INFINITY };
+    }
+    // a^b = exp(b*log(a)) with both factors monotone.
+    Interval l = interval_make(log(a.min), log(a.max));
+    Interval e = interval_mul(b, l);
+    return interval_make(exp(e.min), exp(e.max));
+}
+
+// sin reaches 1 at pi/2 + 2pi*k and -1 at -pi/2 + 2pi*k.
+static Interval interval_sin(Interval a) {
+    if (a.max - a.min >= 2*TRIG_PI || isinf(a.min) || isinf(a.max)) {
+        return (Interval) { -1, 1 };
+    }
+    Interval r = interval_make(sin(a.min), sin(a.max));
+    if (TRIG_PI/2 + 2*TRIG_PI * ceil((a.min - TRIG_PI/2) / (2*TRIG_PI)) <= a.max) {
+        r.max = 1;
+    }
+    if (-TRIG_PI/2 + 2*TRIG_PI * ceil((a.min + TRIG_PI/2) / (2*TRIG_PI)) <= a.max) {
+        r.min = -1;
+    }
+    return r;
+}
+
+static Interval interval_cos(Interval a) {
+    return interval_sin((Interval) { (float)(a.min + TRIG_PI/2), (float)(a.max + TRIG_PI/2) });
+}
+
+static Interval interval_tan(Interval a) {
+    if (a.max - a.min >= TRIG_PI || TRIG_PI/2 + TRIG_PI * ceil((a.min - TRIG_PI/2) / TRIG_PI) <= a.max) {
+        return INTERVAL_ENTIRE;
+    }
+    return interval_make(tan(a.min), tan(a.max));
+}
+
+static Interval interval_apply(ExpressionOp op, Interval a, Interval b) {
+    if (interval_is_empty(a) || (!expression_is_unary(op) && interval_is_empty(b))) {
+        return INTERVAL_EMPTY;
+    }
+    switch (op) {
+    case EXPRESSION_OP_ADD: return (Interval) { a.min + b.min, a.max + b.max };
+    case EXPRESSION_OP_SUB: return (Interval) { a.min - b.max, a.max - b.min };
+    case EXPRESSION_OP_MUL: return interval_mul(a, b);
+    case EXPRESSION_OP_DIV: return interval_div(a, b);
+    case EXPRESSION_OP_POW: return interval_pow(a, b);
+    case EXPRESSION_OP_NEG: return (Interval) { -a.max, -a.min };
+    case EXPRESSION_OP_SQUARE: return interval_integer_power(a, 2);
+    case EXPRESSION_OP_SIN: return interval_sin(a);
+    case EXPRESSION_OP_COS: return interval_cos(a);
+    case EXPRESSION_OP_TAN: return interval_tan(a);
+    case EXPRESSION_OP_ASIN:
+    case EXPRESSION_OP_ACOS:
+        if (a.min > 1 || a.max < -1) {
+            return INTERVAL_EMPTY;
+        }
+        a.min = fmaxf(a.min, -1);
+        a.max = fminf(a.max, 1);
+        return (op == EXPRESSION_OP_ASIN) ? interval_make(asin(a.min), asin(a.max)) : interval_make(acos(a.max), acos(a.min));
+    case EXPRESSION_OP_ATAN: return interval_make(atan(a.min), atan(a.max));
+    case EXPRESSION_OP_SQRT:
+        if (a.max < 0) {
+            return INTERVAL_EMPTY;
+        }
+        return interval_make(sqrt(fmaxf(a.min, 0)), sqrt(a.max));
+    case EXPRESSION_OP_ABS:
+        if (a.min < 0 && a.max > 0) {
+            return (Interval) { 0, fmaxf(-a.min, a.max) };
+        }
+        return interval_make(fabsf(a.min), fabsf(a.max));
+    case EXPRESSION_OP_EXP: return interval_make(exp(a.min), exp(a.max));
+    case EXPRESSION_OP_LOG:
+        if (a.max <= 0) {
+            return INTERVAL_EMPTY;
+        }
+        return interval_make((a.min <= 0) ? -INFINITY : log(a.min), log(a.max));
+    default: return INTERVAL_ENTIRE;
+    }
+}
+
+// Bounds of the expression over the boxes x[i] * y[i].
+void expression_evaluate_interval_batch(const Expression *e, const Interval *x, const Interval *y, Interval *out, int count) {
+    Interval temps[EXPRESSION_MAX_REGISTERS][EXPRESSION_BATCH];
+    Interval *reg[EXPRESSION_MAX_REGISTERS];
+    for (int r = EXPRESSION_FIRST_CONSTANT; r < e->register_count; r++) {
+        reg[r] = temps[r];
+    }
+    int filled = (count < EXPRESSION_BATCH) ? count : EXPRESSION_BATCH;
+    for (int c = 0; c < e->constant_count; c++) {
+        for (int i = 0; i < filled; i++) {
+            temps[EXPRESSION_FIRST_CONSTANT + c][i] = (Interval) { e->constants[c], e->constants[c] };
+        }
+    }
+
+    for (int first = 0; first < count; first += EXPRESSION_BATCH) {
+        int n = (count - first < EXPRESSION_BATCH) ? (count - first) : EXPRESSION_BATCH;
+        reg[EXPRESSION_X_REGISTER] = (Interval *)x + first;
+        reg[EXPRESSION_Y_REGISTER] = (Interval *)y + first;
+        for (int k = 0; k < e->code_count; k++) {
+            ExpressionInstruction in = e->code[k];
+            Interval *d = reg[in.dst];
+            const Interval *a = reg[in.a];
+            const Interval *b = reg[in.b];
+            ExpressionOp op = (ExpressionOp)in.op;
+            for (int i = 0; i < n; i++) {
+                d[i] = interval_apply(op, a[i], b[i]);
+            }
+        }
+        const Interval *result = reg[e->result];
+        if (result != out + first) {
+            memcpy(out + first, result, sizeof(Interval) * n);
+        }
+    }
+}
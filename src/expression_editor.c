@@ -0,0 +1,77 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+
+// One line text input that replaces a panel's function with a typed
+// expression. Enter compiles and applies it, Escape cancels; a compile error
+// keeps the editor open with the message next to the text.
+
+typedef struct ExpressionEditor {
+    TrigonometricFunction *target;
+    char text[EXPRESSION_MAX_SOURCE];
+    int length;
+    const char *error;
+} ExpressionEditor;
+
+void expression_editor_begin(ExpressionEditor *ed, TrigonometricFunction *tf) {
+    ed->target = tf;
+    ed->error = NULL;
+    ed->length = 0;
+    ed->text[0] = '\0';
+    if (tf->expression != NULL) {
+        ed->length = (int)strlen(tf->expression->source);
+        memcpy(ed->text, tf->expression->source, ed->length + 1);
+    }
+    while (GetCharPressed() != 0) {
+        // drop the key that opened the editor
+    }
+    // Escape cancels the edit instead of closing the window.
+    SetExitKey(KEY_NULL);
+}
+
+static void expression_editor_close(ExpressionEditor *ed) {
+    ed->target = NULL;
+    SetExitKey(KEY_ESCAPE);
+}
+
+// Consumes this frame's keyboard input, returns false once the editor is closed.
+bool expression_editor_update(ExpressionEditor *ed) {
+    if (ed->target == NULL) {
+        return false;
+    }
+    for (int c = GetCharPressed(); c != 0; c = GetCharPressed()) {
+        if (c >= 32 && c < 127 && ed->length < EXPRESSION_MAX_SOURCE - 1) {
+            ed->text[ed->length++] = (char)c;
+            ed->text[ed->length] = '\0';
+            ed->error = NULL;
+        }
+    }
+    if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressedRepeat(KEY_BACKSPACE)) && ed->length > 0) {
+        ed->text[--ed->length] = '\0';
+        ed->error = NULL;
+    }
+    if (IsKeyPressed(KEY_ESCAPE)) {
+        expression_editor_close(ed);
+    } else if (IsKeyPressed(KEY_ENTER)) {
+        Expression *expression = malloc(sizeof(Expression));
+        ed->error = expression_compile(expression, ed->text);
+        if (ed->error == NULL) {
+            trigonometric_function_set_expression(ed->target, expression);
+            expression_editor_close(ed);
+        } else {
+            free(expression);
+        }
+    }
+    return ed->target != NULL;
+}
+
+void expression_editor_draw(ExpressionEditor *ed, Font *font) {
+    if (ed->target == NULL) {
+        return;
+    }
+    const char *text = TextFormat("%s(x) = %s_", ed->target->name, ed->text);
+    if (ed->error != NULL) {
+        text = TextFormat("%s(x) = %s  [%s]", ed->target->name, ed->text, ed->error);
+    }
+    draw_text_centered(font, TEXT_FLAG_BACKING_RECTANGLE, layout.status_label, 0, text, ed->target->color);
+}
@@ -0,0 +1,155 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+#define FFT_MAX_LOG2 24
+
+// Twiddles are stored per radix-2 stage so every butterfly loop reads them
+// contiguously: the stage with half-length h keeps its h factors at offset h-1.
+typedef struct FftPlan {
+    int n;
+    int log2;
+    float *twiddle_re;
+    float *twiddle_im;
+    int *bit_reverse;
+} FftPlan;
+
+static FftPlan *fft_plans[FFT_MAX_LOG2 + 1];
+static pthread_mutex_t fft_plans_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline bool fft_is_power_of_two(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+static FftPlan *fft_plan_create(int log2) {
+    int n = 1 << log2;
+    FftPlan *plan = malloc(sizeof(FftPlan));
+    plan->n = n;
+    plan->log2 = log2;
+    plan->twiddle_re = malloc(sizeof(float) * n);
+    plan->twiddle_im = malloc(sizeof(float) * n);
+    plan->bit_reverse = malloc(sizeof(int) * n);
+    for (int half = 1; half < n; half <<= 1) {
+        double step = -3.14159265358979323846 / half;
+        for (int k = 0; k < half; k++) {
+            plan->twiddle_re[half - 1 + k] = (float)cos(step * k);
+            plan->twiddle_im[half - 1 + k] = (float)sin(step * k);
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < log2; b++) {
+            r |= ((i >> b) & 1) << (log2 - 1 - b);
+        }
+        plan->bit_reverse[i] = r;
+    }
+    return plan;
+}
+
+// Plans are built once per size and shared by every caller for the lifetime of the program.
+FftPlan *fft_plan_get(int n) {
+    if (!fft_is_power_of_two(n)) {
+        return NULL;
+    }
+    int log2 = 0;
+    while ((1 << log2) < n) {
+        log2++;
+    }
+    if (log2 > FFT_MAX_LOG2) {
+        return NULL;
+    }
+    pthread_mutex_lock(&fft_plans_mutex);
+    if (fft_plans[log2] == NULL) {
+        fft_plans[log2] = fft_plan_create(log2);
+    }
+    FftPlan *plan = fft_plans[log2];
+    pthread_mutex_unlock(&fft_plans_mutex);
+    return plan;
+}
+
+static void fft_radix2_stage(float *re, float *im, int n, const float *w_re, const float *w_im, int half) {
+    for (int block = 0; block < n; block += half * 2) {
+        float *a_re = re + block;
+        float *a_im = im + block;
+        float *b_re = a_re + half;
+        float *b_im = a_im + half;
+        int k = 0;
+#ifdef __SSE__
+        for (; k + 4 <= half; k += 4) {
+            __m128 wr = _mm_loadu_ps(w_re + k);
+            __m128 wi = _mm_loadu_ps(w_im + k);
+            __m128 br = _mm_loadu_ps(b_re + k);
+            __m128 bi = _mm_loadu_ps(b_im + k);
+            __m128 ar = _mm_loadu_ps(a_re + k);
+            __m128 ai = _mm_loadu_ps(a_im + k);
+            __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+            __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+            _mm_storeu_ps(b_re + k, _mm_sub_ps(ar, tr));
+            _mm_storeu_ps(b_im + k, _mm_sub_ps(ai, ti));
+            _mm_storeu_ps(a_re + k, _mm_add_ps(ar, tr));
+            _mm_storeu_ps(a_im + k, _mm_add_ps(ai, ti));
+        }
+#endif
+        for (; k < half; k++) {
+            float t_re = b_re[k] * w_re[k] - b_im[k] * w_im[k];
+            float t_im = b_re[k] * w_im[k] + b_im[k] * w_re[k];
+            b_re[k] = a_re[k] - t_re;
+            b_im[k] = a_im[k] - t_im;
+            a_re[k] += t_re;
+            a_im[k] += t_im;
+        }
+    }
+}
+
+// The first two radix-2 stages only use the twiddles 1 and -i, so they are
+// fused into one multiplication-free radix-4 pass.
+static void fft_radix4_first_pass(float *re, float *im, int n) {
+    for (int i = 0; i < n; i += 4) {
+        float a0r = re[i] + re[i+1], a0i = im[i] + im[i+1];
+        float a1r = re[i] - re[i+1], a1i = im[i] - im[i+1];
+        float b0r = re[i+2] + re[i+3], b0i = im[i+2] + im[i+3];
+        float b1r = re[i+2] - re[i+3], b1i = im[i+2] - im[i+3];
+        re[i]   = a0r + b0r; im[i]   = a0i + b0i;
+        re[i+2] = a0r - b0r; im[i+2] = a0i - b0i;
+        re[i+1] = a1r + b1i; im[i+1] = a1i - b1r;
+        re[i+3] = a1r - b1i; im[i+3] = a1i + b1r;
+    }
+}
+
+// In-place forward transform of split real/imaginary arrays, n must be a power of two.
+void fft_forward_plan(FftPlan *plan, float *re, float *im) {
+    int n = plan->n;
+    for (int i = 0; i < n; i++) {
+        int j = plan->bit_reverse[i];
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    int half = 1;
+    if (n >= 4) {
+        fft_radix4_first_pass(re, im, n);
+        half = 4;
+    }
+    for (; half < n; half <<= 1) {
+        fft_radix2_stage(re, im, n, plan->twiddle_re + half - 1, plan->twiddle_im + half - 1, half);
+    }
+}
+
+void fft_forward(float *re, float *im, int n) {
+    FftPlan *plan = fft_plan_get(n);
+    if (plan != NULL) {
+        fft_forward_plan(plan, re, im);
+    }
+}
+
+// Magnitudes of the first n/2+1 bins, written over re.
+void fft_magnitudes(float *re, const float *im, int n) {
+    for (int i = 0; i <= n/2; i++) {
+        re[i] = sqrtf(re[i]*re[i] + im[i]*im[i]);
+    }
+}
@@ -0,0 +1,125 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Uniform grid over the window. Every cell lists the regions overlapping it,
+// highest priority first, so a point query is one cell lookup plus a scan of
+// the few regions sharing that cell. Built only when the layout changes.
+
+#define HIT_CELL_SIZE 32
+
+typedef enum HitKind {
+    HIT_NONE,
+    HIT_UNIT_CIRCLE,
+    HIT_PANEL,
+} HitKind;
+
+typedef struct HitRegion {
+    Rectangle rect;
+    HitKind kind;
+    int index;
+    int priority;
+} HitRegion;
+
+typedef struct HitIndex {
+    HitRegion *regions;
+    int region_count;
+    int region_capacity;
+    int columns;
+    int rows;
+    int *cell_start;
+    int *cell_items;
+} HitIndex;
+
+void hit_index_clear(HitIndex *hi) {
+    hi->region_count = 0;
+}
+
+void hit_index_add(HitIndex *hi, Rectangle rect, HitKind kind, int index, int priority) {
+    if (hi->region_count == hi->region_capacity) {
+        hi->region_capacity = (hi->region_capacity == 0) ? 16 : hi->region_capacity * 2;
+        hi->regions = realloc(hi->regions, sizeof(HitRegion) * hi->region_capacity);
+    }
+    hi->regions[hi->region_count++] = (HitRegion) { rect, kind, index, priority };
+}
+
+static inline int hit_clamp(int v, int min, int max) {
+    return (v < min) ? min : ((v > max) ? max : v);
+}
+
+static void hit_region_cells(HitIndex *hi, Rectangle r, int *x0, int *y0, int *x1, int *y1) {
+    *x0 = hit_clamp((int)floorf(r.x / HIT_CELL_SIZE), 0, hi->columns - 1);
+    *y0 = hit_clamp((int)floorf(r.y / HIT_CELL_SIZE), 0, hi->rows - 1);
+    *x1 = hit_clamp((int)floorf((r.x + r.width) / HIT_CELL_SIZE), 0, hi->columns - 1);
+    *y1 = hit_clamp((int)floorf((r.y + r.height) / HIT_CELL_SIZE), 0, hi->rows - 1);
+}
+
+static int hit_priority_compare(const void *a, const void *b) {
+    return ((const HitRegion *)b)->priority - ((const HitRegion *)a)->priority;
+}
+
+// Counts, prefix-sums, then fills the per-cell lists in one flat array.
+void hit_index_build(HitIndex *hi, float width, float height) {
+    qsort(hi->regions, hi->region_count, sizeof(HitRegion), hit_priority_compare);
+
+    hi->columns = (int)ceilf(width / HIT_CELL_SIZE) + 1;
+    hi->rows = (int)ceilf(height / HIT_CELL_SIZE) + 1;
+    int cell_count = hi->columns * hi->rows;
+    hi->cell_start = realloc(hi->cell_start, sizeof(int) * (cell_count + 1));
+    memset(hi->cell_start, 0, sizeof(int) * (cell_count + 1));
+
+    for (int i = 0; i < hi->region_count; i++) {
+        int x0, y0, x1, y1;
+        hit_region_cells(hi, hi->regions[i].rect, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                hi->cell_start[y * hi->columns + x + 1]++;
+            }
+        }
+    }
+    for (int c = 0; c < cell_count; c++) {
+        hi->cell_start[c + 1] += hi->cell_start[c];
+    }
+    hi->cell_items = realloc(hi->cell_items, sizeof(int) * (hi->cell_start[cell_count] + 1));
+
+    int *fill = calloc(cell_count, sizeof(int));
+    for (int i = 0; i < hi->region_count; i++) {
+        int x0, y0, x1, y1;
+        hit_region_cells(hi, hi->regions[i].rect, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                int c = y * hi->columns + x;
+                hi->cell_items[hi->cell_start[c] + fill[c]++] = i;
+            }
+        }
+    }
+    free(fill);
+}
+
+// Highest priority region containing the point, or NULL.
+const HitRegion *hit_index_query(const HitIndex *hi, Vector2 point) {
+    if (hi->cell_start == NULL || point.x < 0 || point.y < 0) {
+        return NULL;
+    }
+    int x = (int)(point.x / HIT_CELL_SIZE);
+    int y = (int)(point.y / HIT_CELL_SIZE);
+    if (x >= hi->columns || y >= hi->rows) {
+        return NULL;
+    }
+    int c = y * hi->columns + x;
+    for (int i = hi->cell_start[c]; i < hi->cell_start[c + 1]; i++) {
+        const HitRegion *region = &hi->regions[hi->cell_items[i]];
+        Rectangle r = region->rect;
+        if (is_point_inside_area((Vector2){r.x, r.y}, (Vector2){r.width, r.height}, point)) {
+            return region;
+        }
+    }
+    return NULL;
+}
+
+void hit_index_free(HitIndex *hi) {
+    free(hi->regions);
+    free(hi->cell_start);
+    free(hi->cell_items);
+    memset(hi, 0, sizeof(*hi));
+}
@@ -0,0 +1,382 @@
+#include "main.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Plots relations in x and y such as "sin(x) = cos(y)" or "sin(x*y) > 0.5".
+// The panel is covered by a quadtree of square cells in pixel units, refined
+// one level at a time: interval evaluation bounds lhs - rhs over each cell,
+// cells that provably miss the curve (or lie entirely inside or outside an
+// inequality) are decided, and only the remaining cells are split, down to
+// single pixels. Each level is split across threads in contiguous runs of
+// cells, which are whole subtrees of the previous level, and published when
+// done, so a coarse preview shows up at once and sharpens over a few frames.
+
+#define IMPLICIT_MAX_THREADS 64
+#define IMPLICIT_MIN_CELLS_PER_THREAD 256
+#define IMPLICIT_CHUNK 256
+#define IMPLICIT_MAX_PIXELS 16384 // per side, cell coordinates are int16
+
+typedef enum ImplicitState {
+    IMPLICIT_EMPTY,     // no solution in the cell
+    IMPLICIT_FILLED,    // the relation holds in the whole cell
+    IMPLICIT_UNKNOWN,   // needs splitting, or is a curve pixel at the last level
+} ImplicitState;
+
+typedef struct ImplicitCell {
+    int16_t x;
+    int16_t y;
+} ImplicitCell;
+
+typedef struct ImplicitRequest {
+    Expression expression;
+    Domain domain;
+    Range range;
+    int width;
+    int height;
+    float scale; // request pixels per panel pixel, above 1 for posters
+} ImplicitRequest;
+
+typedef struct ImplicitCellList {
+    ImplicitCell *cells;
+    int count;
+    int capacity;
+} ImplicitCellList;
+
+// What the panel draws: decided cells of any size plus the undecided cells of
+// the last finished level.
+typedef struct ImplicitResult {
+    ImplicitCellList filled;
+    ImplicitCellList boundary;
+    int *filled_sizes;
+    int filled_sizes_capacity;
+    int boundary_size;
+    float scale; // of the request the cells are in
+} ImplicitResult;
+
+typedef struct ImplicitPlot ImplicitPlot;
+
+typedef struct ImplicitJob {
+    ImplicitPlot *plot;
+    const ImplicitCell *cells;
+    uint8_t *states;
+    int count;
+    int size;
+    uint64_t generation;
+} ImplicitJob;
+
+struct ImplicitPlot {
+    ImplicitRequest requested;
+    ImplicitRequest computing;
+    uint64_t request_generation;
+    uint64_t result_generation;
+    uint64_t finished_generation; // last request refined down to pixels
+    atomic_uint_fast64_t latest_generation; // read by jobs to stop early
+    ImplicitResult result;
+    ImplicitResult work;
+    pthread_t worker;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t finished; // signalled with finished_generation
+    bool quit;
+};
+
+static void implicit_cells_push(ImplicitCellList *list, ImplicitCell cell) {
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity == 0) ? 1024 : list->capacity * 2;
+        list->cells = realloc(list->cells, sizeof(ImplicitCell) * list->capacity);
+    }
+    list->cells[list->count++] = cell;
+}
+
+static void implicit_result_push_filled(ImplicitResult *r, ImplicitCell cell, int size) {
+    implicit_cells_push(&r->filled, cell);
+    if (r->filled_sizes_capacity < r->filled.capacity) {
+        r->filled_sizes_capacity = r->filled.capacity;
+        r->filled_sizes = realloc(r->filled_sizes, sizeof(int) * r->filled_sizes_capacity);
+    }
+    r->filled_sizes[r->filled.count - 1] = size;
+}
+
+static void implicit_result_copy(ImplicitResult *dst, const ImplicitResult *src) {
+    dst->filled.count = 0;
+    dst->boundary.count = 0;
+    for (int i = 0; i < src->filled.count; i++) {
+        implicit_result_push_filled(dst, src->filled.cells[i], src->filled_sizes[i]);
+    }
+    for (int i = 0; i < src->boundary.count; i++) {
+        implicit_cells_push(&dst->boundary, src->boundary.cells[i]);
+    }
+    dst->boundary_size = src->boundary_size;
+    dst->scale = src->scale;
+}
+
+static void implicit_result_free(ImplicitResult *r) {
+    free(r->filled.cells);
+    free(r->boundary.cells);
+    free(r->filled_sizes);
+}
+
+// Cell (x, y, size) in panel pixels covers [x, x+size] horizontally and the
+// values drawn on rows [y, y+size], see trigonometric_function_value_to_y.
+static void *implicit_job_run(void *arg) {
+    ImplicitJob *job = arg;
+    const ImplicitRequest *rq = &job->plot->computing;
+    double x_scale = (rq->domain.max - rq->domain.min) / rq->width;
+    double y_scale = (rq->range.max - rq->range.min) / rq->height;
+    double half_height = rq->height / 2.0;
+    Interval xs[IMPLICIT_CHUNK], ys[IMPLICIT_CHUNK], g[IMPLICIT_CHUNK];
+    for (int first = 0; first < job->count; first += IMPLICIT_CHUNK) {
+        if (atomic_load(&job->plot->latest_generation) != job->generation) {
+            return NULL;
+        }
+        int n = (job->count - first < IMPLICIT_CHUNK) ? (job->count - first) : IMPLICIT_CHUNK;
+        for (int i = 0; i < n; i++) {
+            ImplicitCell c = job->cells[first + i];
+            xs[i] = (Interval) { (float)(rq->domain.min + c.x * x_scale), (float)(rq->domain.min + (c.x + job->size) * x_scale) };
+            ys[i] = (Interval) { (float)((half_height - c.y - job->size) * y_scale), (float)((half_height - c.y) * y_scale) };
+        }
+        expression_evaluate_interval_batch(&rq->expression, xs, ys, g, n);
+        for (int i = 0; i < n; i++) {
+            ImplicitState state = IMPLICIT_UNKNOWN;
+            if (interval_is_empty(g[i])) {
+                state = IMPLICIT_EMPTY;
+            } else if (rq->expression.relation == EXPRESSION_RELATION_EQUAL) {
+                state = (g[i].min > 0 || g[i].max < 0) ? IMPLICIT_EMPTY : IMPLICIT_UNKNOWN;
+            } else {
+                float sign = (rq->expression.relation == EXPRESSION_RELATION_GREATER) ? 1 : -1;
+                Interval s = (sign > 0) ? g[i] : (Interval) { -g[i].max, -g[i].min };
+                state = (s.min > 0) ? IMPLICIT_FILLED : (s.max <= 0) ? IMPLICIT_EMPTY : IMPLICIT_UNKNOWN;
+            }
+            job->states[first + i] = (uint8_t)state;
+        }
+    }
+    return NULL;
+}
+
+static void implicit_classify(ImplicitPlot *plot, const ImplicitCellList *level, uint8_t *states, int size, uint64_t generation) {
+    ImplicitJob jobs[IMPLICIT_MAX_THREADS];
+    pthread_t threads[IMPLICIT_MAX_THREADS];
+    int job_count = platform_cpu_count();
+    job_count = (job_count > IMPLICIT_MAX_THREADS) ? IMPLICIT_MAX_THREADS : job_count;
+    int useful = level->count / IMPLICIT_MIN_CELLS_PER_THREAD;
+    job_count = (job_count > useful) ? useful : job_count;
+    job_count = (job_count < 1) ? 1 : job_count;
+    for (int i = 0; i < job_count; i++) {
+        int start = (int)((int64_t)level->count * i / job_count);
+        int end = (int)((int64_t)level->count * (i + 1) / job_count);
+        jobs[i] = (ImplicitJob) {
+            .plot = plot,
+            .cells = level->cells + start,
+            .states = states + start,
+            .count = end - start,
+            .size = size,
+            .generation = generation,
+        };
+    }
+    for (int i = 1; i < job_count; i++) {
+        pthread_create(&threads[i], NULL, implicit_job_run, &jobs[i]);
+    }
+    implicit_job_run(&jobs[0]);
+    for (int i = 1; i < job_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Refines level by level, publishing after each one; returns early when a
+// newer request arrives.
+static void implicit_compute(ImplicitPlot *plot, uint64_t generation) {
+    const ImplicitRequest *rq = &plot->computing;
+    ImplicitResult *work = &plot->work;
+    work->filled.count = 0;
+    work->boundary.count = 0;
+    if (rq->width <= 0 || rq->height <= 0) {
+        return;
+    }
+    int size = 1;
+    while (size < rq->width || size < rq->height) {
+        size *= 2;
+    }
+    ImplicitCellList levels[2] = {0};
+    uint8_t *states = NULL;
+    int states_capacity = 0;
+    implicit_cells_push(&levels[0], (ImplicitCell) {0,0});
+    for (int l = 0; levels[l & 1].count > 0; l++, size /= 2) {
+        ImplicitCellList *level = &levels[l & 1];
+        ImplicitCellList *next = &levels[(l + 1) & 1];
+        if (states_capacity < level->count) {
+            states_capacity = level->capacity;
+            states = realloc(states, states_capacity);
+        }
+        implicit_classify(plot, level, states, size, generation);
+        if (atomic_load(&plot->latest_generation) != generation) {
+            break;
+        }
+        next->count = 0;
+        work->boundary.count = 0;
+        for (int i = 0; i < level->count; i++) {
+            ImplicitCell c = level->cells[i];
+            if (states[i] == IMPLICIT_FILLED) {
+                implicit_result_push_filled(work, c, size);
+            } else if (states[i] == IMPLICIT_UNKNOWN && size == 1) {
+                implicit_cells_push(&work->boundary, c);
+            } else if (states[i] == IMPLICIT_UNKNOWN) {
+                implicit_cells_push(&work->boundary, c);
+                int half = size / 2;
+                for (int k = 0; k < 4; k++) {
+                    ImplicitCell child = { (int16_t)(c.x + (k & 1) * half), (int16_t)(c.y + (k >> 1) * half) };
+                    if (child.x < rq->width && child.y < rq->height) {
+                        implicit_cells_push(next, child);
+                    }
+                }
+            }
+        }
+        work->boundary_size = size;
+        work->scale = rq->scale;
+        pthread_mutex_lock(&plot->mutex);
+        implicit_result_copy(&plot->result, work);
+        plot->result_generation = generation;
+        pthread_mutex_unlock(&plot->mutex);
+        if (size == 1) {
+            break;
+        }
+    }
+    free(levels[0].cells);
+    free(levels[1].cells);
+    free(states);
+}
+
+static void *implicit_worker(void *arg) {
+    ImplicitPlot *plot = arg;
+    pthread_mutex_lock(&plot->mutex);
+    while (true) {
+        while (!plot->quit && plot->result_generation == plot->request_generation) {
+            pthread_cond_wait(&plot->cond, &plot->mutex);
+        }
+        if (plot->quit) {
+            break;
+        }
+        uint64_t generation = plot->request_generation;
+        plot->computing = plot->requested;
+        pthread_mutex_unlock(&plot->mutex);
+
+        implicit_compute(plot, generation);
+
+        pthread_mutex_lock(&plot->mutex);
+        if (plot->result_generation != generation && plot->request_generation == generation) {
+            // Nothing to plot (empty panel), still counts as done.
+            plot->result.filled.count = 0;
+            plot->result.boundary.count = 0;
+            plot->result_generation = generation;
+        }
+        if (plot->request_generation == generation) {
+            plot->finished_generation = generation;
+            pthread_cond_broadcast(&plot->finished);
+        }
+    }
+    pthread_mutex_unlock(&plot->mutex);
+    return NULL;
+}
+
+ImplicitPlot *implicit_plot_create(void) {
+    ImplicitPlot *plot = calloc(1, sizeof(ImplicitPlot));
+    pthread_mutex_init(&plot->mutex, NULL);
+    pthread_cond_init(&plot->cond, NULL);
+    pthread_cond_init(&plot->finished, NULL);
+    pthread_create(&plot->worker, NULL, implicit_worker, plot);
+    return plot;
+}
+
+void implicit_plot_free(ImplicitPlot *plot) {
+    if (plot == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&plot->mutex);
+    plot->quit = true;
+    atomic_store(&plot->latest_generation, 0);
+    pthread_cond_signal(&plot->cond);
+    pthread_mutex_unlock(&plot->mutex);
+    pthread_join(plot->worker, NULL);
+    pthread_cond_destroy(&plot->cond);
+    pthread_cond_destroy(&plot->finished);
+    pthread_mutex_destroy(&plot->mutex);
+    implicit_result_free(&plot->result);
+    implicit_result_free(&plot->work);
+    free(plot);
+}
+
+static inline bool implicit_request_equals(const ImplicitRequest *a, const ImplicitRequest *b) {
+    return (
+        strcmp(a->expression.source, b->expression.source) == 0 &&
+        a->domain.min == b->domain.min &&
+        a->domain.max == b->domain.max &&
+        a->range.min == b->range.min &&
+        a->range.max == b->range.max &&
+        a->width == b->width &&
+        a->height == b->height &&
+        a->scale == b->scale
+    );
+}
+
+// Called once per frame, restarts the refinement only when the panel changed.
+// A poster's curve_scale refines down to its pixels instead of the panel's.
+void implicit_plot_update(ImplicitPlot *plot, TrigonometricFunction *tf) {
+    float scale = (tf->curve_scale > 1) ? tf->curve_scale : 1;
+    scale = fminf(scale, IMPLICIT_MAX_PIXELS / fmaxf(fmaxf(tf->size.x, tf->size.y), 1));
+    ImplicitRequest request = {
+        .expression = *tf->expression,
+        .domain = tf->domain,
+        .range = tf->range,
+        .width = (int)(tf->size.x * scale),
+        .height = (int)(tf->size.y * scale),
+        .scale = scale,
+    };
+    pthread_mutex_lock(&plot->mutex);
+    if (plot->request_generation == 0 || !implicit_request_equals(&request, &plot->requested)) {
+        plot->requested = request;
+        plot->request_generation++;
+        atomic_store(&plot->latest_generation, plot->request_generation);
+        pthread_cond_signal(&plot->cond);
+    }
+    pthread_mutex_unlock(&plot->mutex);
+}
+
+// Blocks until the last request is refined down to pixels, for exports
+// that draw the panel only once.
+void implicit_plot_wait(ImplicitPlot *plot) {
+    pthread_mutex_lock(&plot->mutex);
+    while (plot->finished_generation != plot->request_generation) {
+        pthread_cond_wait(&plot->finished, &plot->mutex);
+    }
+    pthread_mutex_unlock(&plot->mutex);
+}
+
+// Cells still undecided above pixel size are drawn faint until refined.
+void implicit_plot_draw(ImplicitPlot *plot, TrigonometricFunction *tf) {
+    Color fill = ColorAlpha(tf->color, 0.5f);
+    Color boundary = tf->color;
+    pthread_mutex_lock(&plot->mutex);
+    const ImplicitResult *r = &plot->result;
+    if (r->boundary_size > 1) {
+        boundary = ColorAlpha(tf->color, 0.25f);
+    }
+    float pixel = (r->scale > 0) ? 1 / r->scale : 1;
+    for (int i = 0; i < r->filled.count; i++) {
+        ImplicitCell c = r->filled.cells[i];
+        float x = c.x * pixel, y = c.y * pixel, size = r->filled_sizes[i] * pixel;
+        render_rectangle(
+            (Rectangle){tf->position.x + x, tf->position.y + y, fminf(size, tf->size.x - x), fminf(size, tf->size.y - y)},
+            fill
+        );
+    }
+    for (int i = 0; i < r->boundary.count; i++) {
+        ImplicitCell c = r->boundary.cells[i];
+        float x = c.x * pixel, y = c.y * pixel, size = r->boundary_size * pixel;
+        render_rectangle(
+            (Rectangle){tf->position.x + x, tf->position.y + y, fminf(size, tf->size.x - x), fminf(size, tf->size.y - y)},
+            boundary
+        );
+    }
+    pthread_mutex_unlock(&plot->mutex);
+}
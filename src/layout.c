@@ -0,0 +1,125 @@
+#include "main.h"
+
+// Every screen position is derived from the window size here, once per
+// resize. The scene is laid out in a centered square of side `side`, which is
+// what the fixed WINSIDE window used to be; draw functions read the cached
+// offsets instead of scaling constants every frame.
+
+typedef struct Layout {
+    float width;
+    float height;
+    float side;
+    Vector2 origin;
+    float text_scale;
+    float label_offset;
+    float small_label_offset;
+    float tan_inner_padding;
+    Rectangle unit_circle;
+    Rectangle panels_area;
+    Vector2 panel_size;
+    float panel_gap;
+    float panel_row_pitch;
+    int panel_count;
+    int panel_columns;
+    int panel_scroll_row;
+    bool panel_compact;
+    Rectangle spectrum;
+    Vector2 deg_label;
+    Vector2 rad_label;
+    Vector2 status_label;
+} Layout;
+
+static Layout layout;
+
+static inline Vector2 layout_point(float x, float y) {
+    return (Vector2) { layout.origin.x + layout.side * x, layout.origin.y + layout.side * y };
+}
+
+// Up to three panels keep the original row under the unit circle. More panels
+// get a grid across the window width with as many columns as it takes for all
+// rows to fit below the unit circle, until panels would get narrower than
+// 0.05 of the scene; rows that still do not fit are reached by scrolling.
+static void layout_update_panels(void) {
+    float side = layout.side;
+    Vector2 panels = layout_point(0.1f, 0.8f);
+    float area_width = side * 0.8f;
+    layout.panel_columns = 3;
+    if (layout.panel_count > 3) {
+        panels.x = layout.width * 0.05f;
+        area_width = layout.width * 0.9f;
+        float area_height = layout.height - panels.y;
+        int columns = (int)ceilf(sqrtf((float)layout.panel_count));
+        while (columns < layout.panel_count) {
+            float pitch = area_width / (columns * 1.5f - 0.5f);
+            int rows = (layout.panel_count + columns - 1) / columns;
+            if (rows * pitch <= area_height || area_width / ((columns + 1) * 1.5f - 0.5f) < side * 0.05f) {
+                break;
+            }
+            columns++;
+        }
+        layout.panel_columns = columns;
+    }
+    // Same proportions as the original row: gaps are half a panel wide.
+    float panel_width = area_width / (layout.panel_columns * 1.5f - 0.5f);
+    layout.panel_size = (Vector2) { panel_width, panel_width / 2 };
+    layout.panel_gap = panel_width / 2;
+    layout.panel_row_pitch = panel_width;
+    layout.panel_compact = panel_width < side * 0.15f;
+    layout.panels_area = (Rectangle) { panels.x, panels.y, area_width, layout.height - panels.y };
+
+    int rows = (layout.panel_count + layout.panel_columns - 1) / layout.panel_columns;
+    if (layout.panel_scroll_row > rows - 1) {
+        layout.panel_scroll_row = (rows > 0) ? rows - 1 : 0;
+    }
+}
+
+void layout_set_panel_count(int count) {
+    layout.panel_count = count;
+    layout_update_panels();
+}
+
+void layout_scroll_panels(int rows) {
+    layout.panel_scroll_row += rows;
+    if (layout.panel_scroll_row < 0) {
+        layout.panel_scroll_row = 0;
+    }
+    layout_update_panels();
+}
+
+void layout_update(float width, float height) {
+    float side = (width < height) ? width : height;
+    layout.width = width;
+    layout.height = height;
+    layout.side = side;
+    layout.origin = (Vector2) { (width - side) / 2, (height - side) / 2 };
+    layout.text_scale = side / WINSIDE;
+    layout.label_offset = side * 0.05f;
+    layout.small_label_offset = side * 0.03f;
+    layout.tan_inner_padding = side * 0.1f;
+
+    Vector2 unit_circle = layout_point(0.3f, 0.2f);
+    layout.unit_circle = (Rectangle) { unit_circle.x, unit_circle.y, side * 0.4f, side * 0.4f };
+
+    layout_update_panels();
+
+    Vector2 spectrum = layout_point(0.77f, 0.3f);
+    layout.spectrum = (Rectangle) { spectrum.x, spectrum.y, side * 0.2f, side * 0.12f };
+
+    layout.deg_label = layout_point(0.25f, 0.05f);
+    layout.rad_label = layout_point(0.75f, 0.05f);
+    layout.status_label = layout_point(0.5f, 0.1f);
+}
+
+Vector2 layout_panel_position(int index) {
+    int column = index % layout.panel_columns;
+    int row = index / layout.panel_columns - layout.panel_scroll_row;
+    return (Vector2) {
+        layout.panels_area.x + (layout.panel_size.x + layout.panel_gap) * column,
+        layout.panels_area.y + layout.panel_row_pitch * row,
+    };
+}
+
+// Panels scrolled above the panel area or below the window are not drawn or hit-tested.
+bool layout_panel_visible(Vector2 position) {
+    return position.y >= layout.panels_area.y && position.y < layout.height;
+}
@@ -1,113 +1,312 @@
 #include "main.h"
+#include "platform.c"
+#include "trig.c"
+#include "cordic.c"
+#include "expression.c"
+#include "layout.c"
+#include "render.c"
 #include "unit_circle.c"
+#include "chebyshev.c"
+#include "implicit.c"
+#include "partial_sum.c"
 #include "trigonometric_function.c"
+#include "expression_editor.c"
+#include "dataset.c"
+#include "fft.c"
+#include "sine_fit.c"
+#include "spectrum.c"
+#include "approximant.c"
+#include "swarm.c"
+#include "epicycle.c"
+#include "dashboard.c"
+#include "plugin.c"
+#include "hit_test.c"
+#include "scene.c"
+#include "video.c"
+#include "poster.c"
+#include <string.h>
 
-int main(void) {
+// main [waveform.f32] [-panels <file>] [-plugins <dir>] [-export <prefix> svg|pdf <from_deg> <to_deg> <step_deg>] [-record <path> <scale>] [-poster <path.png> <size>]
+// With -panels, the sin/cos/tan panels are replaced by the ones listed in <file>.
+// Plugins (see trig_plugin.h) are loaded from <dir>, build/plugins by default.
+// With -export, one vector file per angle is written without opening a window.
+// With -record, every frame is streamed to <path> (see video_recorder_start).
+// With -poster, a size x size render is written once the window is up.
+static int export_angles(Scene *scene, const char *prefix, const char *extension, float from, float to, float step) {
+    VectorFormat format = (strcmp(extension, "pdf") == 0) ? VECTOR_FORMAT_PDF : VECTOR_FORMAT_SVG;
+    double start_time = platform_time_seconds();
+    int count = 0;
+    for (float deg = from; deg <= to && step > 0; deg = from + step * (count)) {
+        unit_circle_update_degrees(&scene->unit_circle, deg);
+        if (!scene_export_vector(scene, TextFormat("%s%06d.%s", prefix, count, extension), format)) {
+            return 1;
+        }
+        count++;
+    }
+    TraceLog(LOG_INFO, "EXPORT: %d files in %.3fs", count, platform_time_seconds() - start_time);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *dataset_path = NULL;
+    int export_arg = 0;
+    int record_arg = 0;
+    int poster_arg = 0;
+    const char *panels_path = NULL;
+    const char *plugins_path = "build/plugins";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-export") == 0 && i + 5 < argc) {
+            export_arg = i;
+            i += 5;
+        } else if (strcmp(argv[i], "-record") == 0 && i + 2 < argc) {
+            record_arg = i;
+            i += 2;
+        } else if (strcmp(argv[i], "-panels") == 0 && i + 1 < argc) {
+            panels_path = argv[++i];
+        } else if (strcmp(argv[i], "-plugins") == 0 && i + 1 < argc) {
+            plugins_path = argv[++i];
+        } else if (strcmp(argv[i], "-poster") == 0 && i + 2 < argc) {
+            poster_arg = i;
+            i += 2;
+        } else {
+            dataset_path = argv[i];
+        }
+    }
+
+    Scene scene;
+    static PluginHost plugins;
+    plugin_host_init(&plugins, plugins_path);
+    if (export_arg != 0) {
+        layout_update(WINSIDE, WINSIDE);
+        scene_init(&scene, render_load_font_metrics("arial.ttf"));
+        if (panels_path != NULL) {
+            scene_load_functions(&scene, panels_path);
+        }
+        if (plugin_host_poll(&plugins, platform_time_seconds())) {
+            scene_sync_plugins(&scene, &plugins);
+        }
+        if (dataset_path != NULL) {
+            scene.dataset = dataset_open(dataset_path, scene.trigonometric_functions[0].domain);
+        }
+        int result = export_angles(
+            &scene,
+            argv[export_arg+1],
+            argv[export_arg+2],
+            (float)atof(argv[export_arg+3]),
+            (float)atof(argv[export_arg+4]),
+            (float)atof(argv[export_arg+5])
+        );
+        scene_deinit(&scene);
+        plugin_host_deinit(&plugins);
+        return result;
+    }
+
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(WINSIDE, WINSIDE, "Trig");
     SetTargetFPS(60);
 
-    Font font = LoadFont("arial.ttf");
-
-    UnitCircle unit_circle;
-    unit_circle.position = (Vector2){WINSIDE*0.3,WINSIDE*0.2};
-    unit_circle.radius = WINSIDE*0.2;
-    unit_circle.center = (Vector2){
-        unit_circle.position.x + unit_circle.radius,
-        unit_circle.position.y + unit_circle.radius
-    };
-
-    const int trigonometric_functions_count = 3;
-    TrigonometricFunction trigonometric_functions[trigonometric_functions_count];
-    {
-        float x = WINSIDE*0.1;
-        float y = WINSIDE*0.8;
-        float width = WINSIDE*0.6/3;
-        float height = WINSIDE*0.1;
-
-        trigonometric_functions[0] = (TrigonometricFunction) {
-            .name = "sin",
-            .function = sinf,
-            .range = (Range) {-1,1},
-            .position = (Vector2){x,y},
-            .size = (Vector2){width,height},
-            .color = SIN_COL,
-        };
-        trigonometric_functions[1] = (TrigonometricFunction) {
-            .name = "cos",
-            .function = cosf,
-            .range = (Range) {-1,1},
-            .position = (Vector2){x+width+x,y},
-            .size = (Vector2){width,height},
-            .color = COS_COL,
-        };
-        trigonometric_functions[2] = (TrigonometricFunction) {
-            .name = "tan",
-            .function = tanf,
-            .range = (Range) {-5,5},
-            .position = (Vector2){x+width+x+width+x,y},
-            .size = (Vector2){width,height},
-            .color = TAN_COL,
-        };
+    layout_update(GetScreenWidth(), GetScreenHeight());
+
+    scene_init(&scene, LoadFont("arial.ttf"));
+    if (panels_path != NULL) {
+        scene_load_functions(&scene, panels_path);
     }
+    UnitCircle *unit_circle = &scene.unit_circle;
+    int panning_panel = -1; // index of the panel dragged with the right button
 
-    const int significant_angles_count = 16;
-    float significant_angles[significant_angles_count];
-    {
-        for (int i = 0; i < 4; i++) {
-            int idx = 4*i;
-            float deg = 90*i;
-            significant_angles[idx+0] = deg+30;
-            significant_angles[idx+1] = deg+45;
-            significant_angles[idx+2] = deg+60;
-            significant_angles[idx+3] = deg+90;
-        }
+    if (dataset_path != NULL) {
+        scene.dataset = dataset_open(dataset_path, scene.trigonometric_functions[0].domain);
     }
 
-    { // Unit circle initial angle
-        Vector2 angle45 = {
-            unit_circle.center.x + 1,
-            unit_circle.center.y - 1,
-        };
-        unit_circle_update_towards(&unit_circle, angle45);
+    if (poster_arg != 0) {
+        poster_export(&scene, argv[poster_arg+1], atoi(argv[poster_arg+2]));
+    }
+
+    VideoRecorder recorder = {0};
+    if (record_arg != 0 && !video_recorder_start(&recorder, argv[record_arg+1], (float)atof(argv[record_arg+2]))) {
+        scene_deinit(&scene);
+        plugin_host_deinit(&plugins);
+        return 1;
     }
 
     while (!WindowShouldClose()) {
+        // While an expression is typed, keys go to the editor only.
+        bool typing = expression_editor_update(&scene.expression_editor);
+
+        if (!typing && IsKeyPressed(KEY_F11)) {
+            ToggleBorderlessWindowed();
+        }
+        if (IsWindowResized()) {
+            layout_update(GetScreenWidth(), GetScreenHeight());
+            scene_apply_layout(&scene);
+        }
+        if (!typing && (IsKeyPressed(KEY_PAGE_DOWN) || IsKeyPressedRepeat(KEY_PAGE_DOWN))) {
+            layout_scroll_panels(1);
+            scene_apply_layout(&scene);
+        } else if (!typing && (IsKeyPressed(KEY_PAGE_UP) || IsKeyPressedRepeat(KEY_PAGE_UP))) {
+            layout_scroll_panels(-1);
+            scene_apply_layout(&scene);
+        }
+
+        if (plugin_host_poll(&plugins, GetTime())) {
+            scene_sync_plugins(&scene, &plugins);
+        }
+
+        // One lookup per frame serves both the drag and the hovered panel keys.
+        // The dashboard covers the scene, nothing under it can be hit.
+        Vector2 mouse = GetMousePosition();
+        const HitRegion *hit = (scene.dashboard.count > 0) ? NULL : hit_index_query(&scene.hit_index, mouse);
+        TrigonometricFunction *hovered = (hit != NULL && hit->kind == HIT_PANEL) ? &(scene.trigonometric_functions[hit->index]) : NULL;
+
         if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            Vector2 mouse = GetMousePosition();
+            if (scene.dashboard.count > 0) {
+                dashboard_point_towards(&scene.dashboard, mouse);
+            } else if (hit != NULL && hit->kind == HIT_UNIT_CIRCLE) {
+                unit_circle_update_towards(unit_circle, mouse);
+            } else if (hovered != NULL) {
+                float rad = (float)trigonometric_function_x_to_domain(hovered, mouse.x);
+                unit_circle_update_radians(unit_circle, rad);
+            }
+        }
 
-            if (is_point_inside_area(unit_circle.position, (Vector2){unit_circle.radius*2,unit_circle.radius*2}, mouse)) {
-                unit_circle_update_towards(&unit_circle, mouse);
-            } else {
-                for (int i = 0; i < trigonometric_functions_count; i++) {
-                    TrigonometricFunction *fv = &(trigonometric_functions[i]);
-                    if (is_point_inside_area(fv->position, fv->size, mouse)) {
-                        float relative_x = (mouse.x - fv->position.x) / fv->size.x;
-                        float rad = relative_x * 2 * PI;
-                        unit_circle_update_radians(&unit_circle, rad);
-                        break;
-                    }
+        // Right drag pans the panel it started on, the wheel zooms around the cursor.
+        if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && hovered != NULL) {
+            panning_panel = hit->index;
+        } else if (!IsMouseButtonDown(MOUSE_BUTTON_RIGHT) || panning_panel >= scene.trigonometric_functions_count) {
+            panning_panel = -1;
+        }
+        if (panning_panel >= 0) {
+            TrigonometricFunction *tf = &(scene.trigonometric_functions[panning_panel]);
+            float dx = GetMouseDelta().x;
+            if (dx != 0) {
+                trigonometric_function_pan(tf, -dx / tf->size.x);
+            }
+        }
+        float wheel = GetMouseWheelMove();
+        if (hovered != NULL && wheel != 0) {
+            trigonometric_function_zoom_at(hovered, pow(0.8, wheel), trigonometric_function_x_to_domain(hovered, mouse.x));
+        }
+
+        if (hovered != NULL && !typing) {
+            if (IsKeyPressed(KEY_E)) {
+                expression_editor_begin(&scene.expression_editor, hovered);
+            } else if (IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT)) {
+                trigonometric_function_pan(hovered, -0.1);
+            } else if (IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT)) {
+                trigonometric_function_pan(hovered, 0.1);
+            } else if (IsKeyPressed(KEY_UP) || IsKeyPressedRepeat(KEY_UP)) {
+                trigonometric_function_zoom(hovered, 0.5);
+            } else if (IsKeyPressed(KEY_DOWN) || IsKeyPressedRepeat(KEY_DOWN)) {
+                trigonometric_function_zoom(hovered, 2);
+            } else if (IsKeyPressed(KEY_HOME)) {
+                trigonometric_function_reset_domain(hovered);
+            } else if (IsKeyPressed(KEY_A)) {
+                if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) {
+                    approximant_add(hovered);
+                } else {
+                    approximant_cycle(hovered);
+                }
+            } else if (IsKeyPressed(KEY_T)) {
+                partial_sum_cycle(hovered, unit_circle->rad);
+            } else if (IsKeyPressed(KEY_RIGHT_BRACKET) || IsKeyPressedRepeat(KEY_RIGHT_BRACKET)) {
+                if (hovered->partial_sum != NULL) {
+                    partial_sum_step(hovered, 1, IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT));
+                } else {
+                    approximant_step_order(hovered, 1);
                 }
+            } else if (IsKeyPressed(KEY_LEFT_BRACKET) || IsKeyPressedRepeat(KEY_LEFT_BRACKET)) {
+                if (hovered->partial_sum != NULL) {
+                    partial_sum_step(hovered, -1, IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT));
+                } else {
+                    approximant_step_order(hovered, -1);
+                }
+            }
+        }
+        // M cycles the multi-angle modes, = and - scale the number of points by 10.
+        if (!typing && IsKeyPressed(KEY_M)) {
+            swarm_cycle(&scene.swarm);
+        } else if (!typing && IsKeyPressed(KEY_EQUAL)) {
+            swarm_scale_count(&scene.swarm, 10);
+        } else if (!typing && IsKeyPressed(KEY_MINUS)) {
+            swarm_scale_count(&scene.swarm, 0.1f);
+        }
+        float frame_time = video_recorder_frame_time(&recorder, GetFrameTime());
+        swarm_update(&scene.swarm, unit_circle->rad, frame_time);
+        // O cycles the epicycle shapes, . and , double and halve the circles.
+        if (!typing && IsKeyPressed(KEY_O)) {
+            epicycle_cycle(&scene.epicycle);
+        } else if (!typing && (IsKeyPressed(KEY_PERIOD) || IsKeyPressedRepeat(KEY_PERIOD))) {
+            epicycle_scale_terms(&scene.epicycle, 2);
+        } else if (!typing && (IsKeyPressed(KEY_COMMA) || IsKeyPressedRepeat(KEY_COMMA))) {
+            epicycle_scale_terms(&scene.epicycle, 0.5f);
+        }
+        epicycle_update(&scene.epicycle, frame_time);
+        // D cycles the dashboard through 4, 16 and 64 circles and back to the scene.
+        if (!typing && IsKeyPressed(KEY_D)) {
+            dashboard_cycle(&scene.dashboard);
+        }
+        // C shows the CORDIC micro-rotations, stepped with [ and ] over the unit circle.
+        if (!typing && IsKeyPressed(KEY_C)) {
+            scene.cordic_steps = (scene.cordic_steps > 0) ? 0 : 1;
+        }
+        if (!typing && scene.cordic_steps > 0 && hit != NULL && hit->kind == HIT_UNIT_CIRCLE) {
+            if (IsKeyPressed(KEY_RIGHT_BRACKET) || IsKeyPressedRepeat(KEY_RIGHT_BRACKET)) {
+                scene.cordic_steps = (scene.cordic_steps < CORDIC_Q31_ITERATIONS) ? scene.cordic_steps + 1 : scene.cordic_steps;
+            } else if (IsKeyPressed(KEY_LEFT_BRACKET) || IsKeyPressedRepeat(KEY_LEFT_BRACKET)) {
+                scene.cordic_steps = (scene.cordic_steps > 1) ? scene.cordic_steps - 1 : 1;
+            }
+        }
+        if (!typing && IsKeyPressed(KEY_S)) {
+            if (hovered != NULL) {
+                spectrum_set_source(&scene.spectrum, hovered, (hit->index == 0) ? scene.dataset : NULL);
+            } else {
+                spectrum_set_source(&scene.spectrum, NULL, NULL);
             }
         }
+        spectrum_update(&scene.spectrum);
 
-        BeginDrawing();
+        if (!typing && scene.dataset != NULL && IsKeyPressed(KEY_F)) {
+            sine_fitter_start(&scene.sine_fitter, scene.dataset);
+        }
+        if (sine_fitter_poll(&scene.sine_fitter)) {
+            scene.sine_fit_visible = scene.sine_fitter.result.valid;
+        }
 
-        ClearBackground(BLACK);
+        if (!typing && IsKeyPressed(KEY_P)) {
+            scene_export_vector(&scene, "trig.svg", VECTOR_FORMAT_SVG);
+            scene_export_vector(&scene, "trig.pdf", VECTOR_FORMAT_PDF);
+        }
+
+        if (!typing && IsKeyPressed(KEY_R)) {
+            if (recorder.recording) {
+                video_recorder_stop(&recorder);
+            } else if (!video_recorder_start(&recorder, "trig.y4m", 1)) {
+                TraceLog(LOG_WARNING, "VIDEO: R did not start a recording, see above");
+            }
+        }
 
-        unit_circle_draw_tan(&unit_circle, &font); // drawn early to not block texts outside of unit circle
-        unit_circle_draw_base(&unit_circle);
-        unit_circle_draw_quadrants(&unit_circle, &font);
-        unit_circle_draw_angles_on_circumference(&unit_circle, &font, significant_angles, significant_angles_count);
-        unit_circle_draw_right_angle(&unit_circle);
-        unit_circle_draw_triangle(&unit_circle, &font);
+        dashboard_update(&scene.dashboard, &scene.font, scene.significant_angles, scene.significant_angles_count);
 
-        for (int i = 0; i < trigonometric_functions_count; i++) {
-            trigonometric_function_draw(&(trigonometric_functions[i]), &font, unit_circle.rad);
+        if (recorder.recording) {
+            video_recorder_begin_frame(&recorder);
+            scene_draw(&scene);
+            video_recorder_end_frame(&recorder);
         }
 
-        draw_text_centered(&font, TEXT_FLAG_NONE, (Vector2){(WINSIDE/2)-(WINSIDE*0.25),WINSIDE*0.05}, 0, TextFormat("deg: %.2f", unit_circle.deg), MAIN_COL);
-        draw_text_centered(&font, TEXT_FLAG_NONE, (Vector2){(WINSIDE/2)+(WINSIDE*0.25),WINSIDE*0.05}, 0, TextFormat("rad: %.2f", unit_circle.rad), MAIN_COL);
+        BeginDrawing();
+
+        ClearBackground(BLACK);
+
+        if (recorder.recording) {
+            video_recorder_draw(&recorder);
+        } else {
+            scene_draw(&scene);
+        }
 
         EndDrawing();
     }
+
+    video_recorder_stop(&recorder);
+    scene_deinit(&scene);
+    plugin_host_deinit(&plugins);
 }
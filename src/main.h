@@ -9,12 +9,21 @@
 #define LINE_BIG 5
 #define LINE_SMALL 1
 #define POINT_RADIUS 10
+#define TRIGONOMETRIC_FUNCTION_SCREEN_COLUMNS 512 // most columns sampled at curve_scale 1
+#define TRIGONOMETRIC_FUNCTION_MAX_COLUMNS 4096 // most at any curve_scale, for posters
+#define TRIGONOMETRIC_FUNCTION_COLUMN_WIDTH 2
+#define TRIGONOMETRIC_FUNCTION_SUBSAMPLES 4
 
 #define MAIN_COL ((Color){255,255,255,255})
 #define FILL_COL ((Color){255,255,255,32})
 #define SIN_COL ((Color){0,128,255,255})
 #define COS_COL ((Color){200,0,255,255})
 #define TAN_COL ((Color){255,128,0,255})
+#define DATA_COL ((Color){0,255,128,160})
+#define FIT_COL ((Color){255,0,96,255})
+#define APPROXIMANT_COL ((Color){255,220,0,255})
+#define SWARM_COL ((Color){0,220,255,255})
+#define EPICYCLE_COL ((Color){255,64,160,255})
 
 typedef struct UnitCircle {
     Vector2 position;
@@ -33,15 +42,70 @@ typedef struct Range {
     float max;
 } Range;
 
+typedef struct Domain {
+    double min;
+    double max;
+} Domain;
+
+typedef enum ApproximantKind {
+    APPROXIMANT_NONE,
+    APPROXIMANT_TAYLOR,
+    APPROXIMANT_BHASKARA,
+    APPROXIMANT_MINIMAX,
+    APPROXIMANT_TABLE,
+    APPROXIMANT_CORDIC,
+    APPROXIMANT_CORDIC_Q15,
+    APPROXIMANT_CORDIC_Q31,
+    APPROXIMANT_KIND_COUNT,
+} ApproximantKind;
+
+// A cheap sin/cos/tan approximation compared against a built-in panel, see approximant.c.
+typedef struct Approximant {
+    ApproximantKind kind;
+    int order; // polynomial degree, table size or CORDIC iterations, depending on kind
+} Approximant;
+
+#define APPROXIMANT_SET_MAX 4
+
+// The approximants compared on one panel, each drawn with its own error curve and label line.
+typedef struct ApproximantSet {
+    Approximant shown[APPROXIMANT_SET_MAX];
+    int count;
+    int selected; // the entry A and [ ] change
+} ApproximantSet;
+
+typedef struct Expression Expression;
+typedef struct Chebyshev Chebyshev;
+typedef struct ImplicitPlot ImplicitPlot;
+typedef struct ApproximantPlot ApproximantPlot;
+typedef struct PartialSum PartialSum;
+
 typedef struct TrigonometricFunction {
-    char name[4];
+    char name[16];
     float (*function)(float);
+    Expression *expression; // owned, evaluated instead of function when set
+    void (*evaluate_batch)(const float *x, float *out, int count); // plugin kernel, used instead of function when set
+    int plugin; // 1 + index of the plugin providing evaluate_batch, 0 for none
+    Chebyshev *approximation; // owned, cached fit of an expression or plugin function
+    ImplicitPlot *implicit; // owned, created on first draw of a relation in x and y
+    ApproximantSet approximants; // overlaid with their error curves, built-in kernels only
+    ApproximantPlot *approximant_plots; // owned, cached overlays, one per entry of approximants
+    PartialSum *partial_sum; // owned, plotted instead of function when set, see partial_sum.c
     Range range;
+    Domain domain;
     Vector2 position;
     Vector2 size;
     Color color;
+    bool dirty; // curve must be resampled, set on any domain/position/size change
+    float curve_scale; // device pixels per layout pixel the curve is sampled for, above 1 only for posters
+    int curve_count; // columns sampled, follows the panel width and not the domain
+    Vector2 curve[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS + 1];
+    float curve_top[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS]; // extent of the samples inside each column
+    float curve_bottom[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS];
 } TrigonometricFunction;
 
+typedef struct Dataset Dataset;
+
 typedef enum TextFlags {
     TEXT_FLAG_NONE = 0,
     TEXT_FLAG_LARGE = 1 << 0,
@@ -61,11 +125,16 @@ static inline bool is_point_inside_area(Vector2 area_pos, Vector2 area_size, Vec
     );
 }
 
+void trig_sincosd(float deg, float *sin_out, float *cos_out); // trig.c
+float trigonometric_function_value_to_y(TrigonometricFunction *tf, float value); // trigonometric_function.c
+
+// Exact on the axes and at the usual 30/45/60 degree marks.
 static inline Vector2 get_angle_direction(float deg) {
-    float rad = deg * DEG2RAD;
+    float s, c;
+    trig_sincosd(deg, &s, &c);
     return (Vector2) {
-        cosf(rad),
-        -sinf(rad)
+        c,
+        -s
     };
 }
 
@@ -76,25 +145,4 @@ static inline Vector2 vec2_in_direction(Vector2 position, Vector2 direction, flo
     };
 }
 
-static inline void draw_text_centered(Font *font, TextFlags flags, Vector2 position, float rotation, const char *text, Color color) {
-    int size = has_flag(flags, TEXT_FLAG_LARGE) ? 40 : 30;
-    int spacing = 2;
-    Vector2 text_dimensions = MeasureTextEx(*font, text, size, spacing);
-    Vector2 text_origin = {
-        text_dimensions.x/2,
-        text_dimensions.y/2
-    };
-    const float padding = 5;
-    if (has_flag(flags, TEXT_FLAG_BACKING_RECTANGLE)) {
-        DrawRectangle(
-            position.x - (text_dimensions.x/2) - padding,
-            position.y - (text_dimensions.y/2) - padding,
-            text_dimensions.x + (padding*2),
-            text_dimensions.y + (padding*2),
-            (Color) {0,0,0,128}
-        );
-    }
-    DrawTextPro(*font, text, position, text_origin, rotation, size, spacing, color);
-}
-
 #endif
\ No newline at end of file
@@ -0,0 +1,549 @@
+#include "main.h"
+#include <float.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+// Panels plotting the partial sums of a series instead of a function: the
+// Fourier series of a square, sawtooth and triangle wave, and the Taylor
+// series of sin and cos around a point. The sums at the panel's samples are
+// cached, so stepping the term count by one adds or removes a single term,
+// evaluated exactly (the phase in double, reduced before the float kernel).
+// A pan sums only the samples it brings in; a zoom or a big jump in the
+// count sums everything again, and that pass rotates one phasor per sample
+// instead of evaluating sin, reseeded from the exact phase every few terms. Every sum is accumulated four
+// samples at a time with Kahan compensation, so tens of thousands of terms
+// lose no more than the terms themselves carry.
+
+#define PARTIAL_SUM_DEFAULT_TERMS 10
+#define PARTIAL_SUM_MAX_TERMS 50000
+#define PARTIAL_SUM_MAX_SAMPLES (TRIGONOMETRIC_FUNCTION_MAX_COLUMNS * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + 1)
+#define PARTIAL_SUM_MAX_STEPS 64 // term count changes applied term by term, bigger ones sum again
+#define PARTIAL_SUM_RESEED 64 // terms between exact phasors when summing again
+#define PARTIAL_SUM_VECTORS 3 // of four samples, carried through a block of terms together
+#define PARTIAL_SUM_TAYLOR_LIMIT 1e30 // largest Taylor power added, far off any panel
+
+typedef enum PartialSumSeries {
+    PARTIAL_SUM_SQUARE,
+    PARTIAL_SUM_SAWTOOTH,
+    PARTIAL_SUM_TRIANGLE,
+    PARTIAL_SUM_SIN_TAYLOR,
+    PARTIAL_SUM_COS_TAYLOR,
+    PARTIAL_SUM_SERIES_COUNT,
+} PartialSumSeries;
+
+static float partial_sum_square(float x) {
+    return (trig_sin(x) < 0) ? -1.0f : 1.0f;
+}
+
+static float partial_sum_sawtooth(float x) {
+    return (float)(x - TRIG_PI*2 * floor((x + TRIG_PI) / (TRIG_PI*2)));
+}
+
+static float partial_sum_triangle(float x) {
+    return (float)(2 / TRIG_PI) * asinf(trig_sin(x));
+}
+
+typedef struct PartialSumInfo {
+    const char *name;
+    const char *token; // function of a panel registry line
+    float (*target)(float);
+    Range range;
+    float jump; // height of the target's discontinuity, 0 where it has none
+} PartialSumInfo;
+
+static const PartialSumInfo partial_sum_infos[PARTIAL_SUM_SERIES_COUNT] = {
+    [PARTIAL_SUM_SQUARE] = { "square", "square_sum", partial_sum_square, {-1.5f,1.5f}, 2 },
+    [PARTIAL_SUM_SAWTOOTH] = { "sawtooth", "sawtooth_sum", partial_sum_sawtooth, {-4.5f,4.5f}, (float)(TRIG_PI*2) },
+    [PARTIAL_SUM_TRIANGLE] = { "triangle", "triangle_sum", partial_sum_triangle, {-1.5f,1.5f}, 0 },
+    [PARTIAL_SUM_SIN_TAYLOR] = { "sin taylor", "sin_taylor", trig_sin, {-1.5f,1.5f}, 0 },
+    [PARTIAL_SUM_COS_TAYLOR] = { "cos taylor", "cos_taylor", trig_cos, {-1.5f,1.5f}, 0 },
+};
+
+struct PartialSum {
+    PartialSumSeries series;
+    float point; // of the Taylor expansion
+    int terms; // plotted
+    int summed; // terms in sum
+    int count; // samples in x, 0 until the first sampling
+    float (*restore_function)(float); // the panel before partial_sum_cycle took it over
+    Range restore_range;
+    char restore_name[16];
+    float peak; // largest partial sum over the samples
+    float max_error; // largest distance from the target over the samples
+    float x[PARTIAL_SUM_MAX_SAMPLES];
+    float sum[PARTIAL_SUM_MAX_SAMPLES];
+    float compensation[PARTIAL_SUM_MAX_SAMPLES]; // Kahan: what rounding added to sum, to take back
+    float term[PARTIAL_SUM_MAX_SAMPLES];
+    float phasor_re[PARTIAL_SUM_MAX_SAMPLES]; // summing again: e^(ihx), or the Taylor power
+    float phasor_im[PARTIAL_SUM_MAX_SAMPLES];
+    float rotation_re[PARTIAL_SUM_MAX_SAMPLES]; // e^(i dh x) between harmonics, or x - point
+    float rotation_im[PARTIAL_SUM_MAX_SAMPLES];
+    int limit[PARTIAL_SUM_MAX_SAMPLES]; // Taylor: first term whose power passes PARTIAL_SUM_TAYLOR_LIMIT
+    Vector2 reference[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS + 1];
+};
+
+static inline bool partial_sum_is_taylor(PartialSumSeries series) {
+    return series == PARTIAL_SUM_SIN_TAYLOR || series == PARTIAL_SUM_COS_TAYLOR;
+}
+
+// Harmonic and coefficient of Fourier term i, counted from 0.
+static void partial_sum_harmonic(PartialSumSeries series, int i, int *harmonic, double *coefficient) {
+    double sign = (i % 2 == 0) ? 1 : -1;
+    switch (series) {
+    case PARTIAL_SUM_SQUARE:
+        *harmonic = 2*i + 1;
+        *coefficient = 4 / (TRIG_PI * *harmonic);
+        break;
+    case PARTIAL_SUM_SAWTOOTH:
+        *harmonic = i + 1;
+        *coefficient = 2 * sign / *harmonic;
+        break;
+    default:
+        *harmonic = 2*i + 1;
+        *coefficient = 8 / (TRIG_PI*TRIG_PI) * sign / ((double)*harmonic * *harmonic);
+        break;
+    }
+}
+
+// Derivative k of the Taylor series' function at the expansion point.
+static double partial_sum_derivative(PartialSumSeries series, double point, int k) {
+    int quarter = (k + ((series == PARTIAL_SUM_COS_TAYLOR) ? 1 : 0)) % 4;
+    double s = sin(point), c = cos(point);
+    return (quarter == 0) ? s : (quarter == 1) ? c : (quarter == 2) ? -s : -c;
+}
+
+// The first term whose power |d|^k / k! passes PARTIAL_SUM_TAYLOR_LIMIT,
+// PARTIAL_SUM_MAX_TERMS if none does. That term and all after it are left
+// out of the sample's sum: the power rises until k = |d| and falls after, so
+// without the cut a view a few hundred radians wide overflows float, and
+// inf - inf in the compensation turns the sums into NaN.
+static int partial_sum_taylor_limit(double d) {
+    double log_d = log(fabs(d));
+    double log_limit = log(PARTIAL_SUM_TAYLOR_LIMIT);
+    int peak = (fabs(d) < PARTIAL_SUM_MAX_TERMS) ? (int)fabs(d) : PARTIAL_SUM_MAX_TERMS;
+    if (d == 0 || peak * log_d - lgamma(peak + 1.0) <= log_limit) {
+        return PARTIAL_SUM_MAX_TERMS;
+    }
+    int low = 0, high = peak; // power(low) within the limit, power(high) past it
+    while (high - low > 1) {
+        int middle = (low + high) / 2;
+        if (middle * log_d - lgamma(middle + 1.0) > log_limit) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+    return high;
+}
+
+// sin or cos of h*x at samples [first, last). h*x is exact in double
+// (24 + 17 bits), so only the reduction to [-pi, pi] and the float kernel round.
+static void partial_sum_sin_harmonic(PartialSum *ps, TrigKind kind, int harmonic, float *out, int first, int last) {
+    const double turns_per_rad = 1 / (TRIG_PI*2);
+    for (int j = first; j < last; j++) {
+        double phase = (double)harmonic * ps->x[j];
+        double turns = phase * turns_per_rad;
+        ps->term[j] = (float)(phase - TRIG_PI*2 * (double)(int64_t)(turns + ((turns < 0) ? -0.5 : 0.5)));
+    }
+    trig_evaluate_batch_kind(kind, ps->term + first, out + first, last - first);
+}
+
+// sum += scale * term at samples [first, last), with Kahan compensation.
+static void partial_sum_accumulate_range(PartialSum *ps, const float *term, float scale, int first, int last) {
+    int j = first;
+#ifdef __SSE__
+    const __m128 scale4 = _mm_set1_ps(scale);
+    for (; j + 4 <= last; j += 4) {
+        __m128 s = _mm_loadu_ps(ps->sum + j);
+        __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(term + j), scale4), _mm_loadu_ps(ps->compensation + j));
+        __m128 t = _mm_add_ps(s, y);
+        _mm_storeu_ps(ps->compensation + j, _mm_sub_ps(_mm_sub_ps(t, s), y));
+        _mm_storeu_ps(ps->sum + j, t);
+    }
+#endif
+    for (; j < last; j++) {
+        float y = term[j] * scale - ps->compensation[j];
+        float t = ps->sum[j] + y;
+        ps->compensation[j] = (t - ps->sum[j]) - y;
+        ps->sum[j] = t;
+    }
+}
+
+static void partial_sum_accumulate(PartialSum *ps, const float *term, float scale) {
+    partial_sum_accumulate_range(ps, term, scale, 0, ps->count);
+}
+
+// Adds (sign 1) or removes (sign -1) term i, evaluated exactly.
+static void partial_sum_step_term(PartialSum *ps, int i, float sign) {
+    if (!partial_sum_is_taylor(ps->series)) {
+        int harmonic;
+        double coefficient;
+        partial_sum_harmonic(ps->series, i, &harmonic, &coefficient);
+        partial_sum_sin_harmonic(ps, TRIG_SIN, harmonic, ps->phasor_im, 0, ps->count);
+        partial_sum_accumulate(ps, ps->phasor_im, sign * (float)coefficient);
+        return;
+    }
+    // (x - point)^i / i! through logarithms, which neither overflows nor
+    // underflows before the result does.
+    double derivative = partial_sum_derivative(ps->series, ps->point, i);
+    for (int j = 0; j < ps->count; j++) {
+        double d = (double)ps->x[j] - ps->point;
+        double power = (i == 0) ? 1 : (d == 0 || i >= ps->limit[j]) ? 0 : exp(i * log(fabs(d)) - lgamma(i + 1.0));
+        power = (d < 0 && i % 2 == 1) ? -power : power;
+        ps->phasor_im[j] = (derivative == 0) ? 0 : (float)(derivative * power);
+    }
+    partial_sum_accumulate(ps, ps->phasor_im, sign);
+}
+
+// The Fourier sums of samples [first, last) again from nothing, up to the
+// summed terms, in blocks of PARTIAL_SUM_RESEED terms. Each block starts every sample's phasor at the exact phase of its
+// first harmonic and turns it by the step between harmonics from there, so
+// rounding never builds up past a block. Within a block, a few vectors of
+// samples keep their phasors and sums in registers through all its terms.
+static void partial_sum_rebuild_fourier(PartialSum *ps, int first_sample, int last_sample) {
+    float coefficients[PARTIAL_SUM_RESEED];
+    int first, second;
+    double coefficient;
+    partial_sum_harmonic(ps->series, 0, &first, &coefficient);
+    partial_sum_harmonic(ps->series, 1, &second, &coefficient);
+    partial_sum_sin_harmonic(ps, TRIG_COS, second - first, ps->rotation_re, first_sample, last_sample);
+    partial_sum_sin_harmonic(ps, TRIG_SIN, second - first, ps->rotation_im, first_sample, last_sample);
+    for (int block = 0; block < ps->summed; block += PARTIAL_SUM_RESEED) {
+        int n = (ps->summed - block < PARTIAL_SUM_RESEED) ? ps->summed - block : PARTIAL_SUM_RESEED;
+        int harmonic;
+        partial_sum_harmonic(ps->series, block, &harmonic, &coefficient);
+        for (int i = 0; i < n; i++) {
+            int unused;
+            partial_sum_harmonic(ps->series, block + i, &unused, &coefficient);
+            coefficients[i] = (float)coefficient;
+        }
+        partial_sum_sin_harmonic(ps, TRIG_COS, harmonic, ps->phasor_re, first_sample, last_sample);
+        partial_sum_sin_harmonic(ps, TRIG_SIN, harmonic, ps->phasor_im, first_sample, last_sample);
+        int j = first_sample;
+#ifdef __SSE__
+        for (; j + 4*PARTIAL_SUM_VECTORS <= last_sample; j += 4*PARTIAL_SUM_VECTORS) {
+            __m128 re[PARTIAL_SUM_VECTORS], im[PARTIAL_SUM_VECTORS];
+            __m128 rotation_re[PARTIAL_SUM_VECTORS], rotation_im[PARTIAL_SUM_VECTORS];
+            __m128 sum[PARTIAL_SUM_VECTORS], compensation[PARTIAL_SUM_VECTORS];
+            for (int v = 0; v < PARTIAL_SUM_VECTORS; v++) {
+                re[v] = _mm_loadu_ps(ps->phasor_re + j + 4*v);
+                im[v] = _mm_loadu_ps(ps->phasor_im + j + 4*v);
+                rotation_re[v] = _mm_loadu_ps(ps->rotation_re + j + 4*v);
+                rotation_im[v] = _mm_loadu_ps(ps->rotation_im + j + 4*v);
+                sum[v] = _mm_loadu_ps(ps->sum + j + 4*v);
+                compensation[v] = _mm_loadu_ps(ps->compensation + j + 4*v);
+            }
+            for (int i = 0; i < n; i++) {
+                const __m128 scale = _mm_set1_ps(coefficients[i]);
+                for (int v = 0; v < PARTIAL_SUM_VECTORS; v++) {
+                    __m128 y = _mm_sub_ps(_mm_mul_ps(im[v], scale), compensation[v]);
+                    __m128 t = _mm_add_ps(sum[v], y);
+                    compensation[v] = _mm_sub_ps(_mm_sub_ps(t, sum[v]), y);
+                    sum[v] = t;
+                    __m128 next_re = _mm_sub_ps(_mm_mul_ps(re[v], rotation_re[v]), _mm_mul_ps(im[v], rotation_im[v]));
+                    im[v] = _mm_add_ps(_mm_mul_ps(re[v], rotation_im[v]), _mm_mul_ps(im[v], rotation_re[v]));
+                    re[v] = next_re;
+                }
+            }
+            for (int v = 0; v < PARTIAL_SUM_VECTORS; v++) {
+                _mm_storeu_ps(ps->sum + j + 4*v, sum[v]);
+                _mm_storeu_ps(ps->compensation + j + 4*v, compensation[v]);
+            }
+        }
+#endif
+        for (; j < last_sample; j++) {
+            float re = ps->phasor_re[j], im = ps->phasor_im[j];
+            float sum = ps->sum[j], compensation = ps->compensation[j];
+            for (int i = 0; i < n; i++) {
+                float y = im * coefficients[i] - compensation;
+                float t = sum + y;
+                compensation = (t - sum) - y;
+                sum = t;
+                float next_re = re * ps->rotation_re[j] - im * ps->rotation_im[j];
+                im = re * ps->rotation_im[j] + im * ps->rotation_re[j];
+                re = next_re;
+            }
+            ps->sum[j] = sum;
+            ps->compensation[j] = compensation;
+        }
+    }
+}
+
+// The Taylor sums of samples [first, last) again from nothing, the power (x - point)^k / k! of each
+// sample carried from one term to the next and zeroed from its limit on.
+// Once every power has underflowed the remaining terms add nothing.
+static void partial_sum_rebuild_taylor(PartialSum *ps, int first, int last) {
+    for (int j = first; j < last; j++) {
+        double d = (double)ps->x[j] - ps->point;
+        ps->rotation_re[j] = (float)d;
+        ps->phasor_re[j] = 1;
+        ps->limit[j] = partial_sum_taylor_limit(d);
+    }
+    for (int k = 0; k < ps->summed; k++) {
+        partial_sum_accumulate_range(ps, ps->phasor_re, (float)partial_sum_derivative(ps->series, ps->point, k), first, last);
+        float inverse = 1.0f / (k + 1);
+        float largest = 0;
+        for (int j = first; j < last; j++) {
+            ps->phasor_re[j] = (k + 1 < ps->limit[j]) ? ps->phasor_re[j] * ps->rotation_re[j] * inverse : 0;
+            largest = fmaxf(largest, fabsf(ps->phasor_re[j]));
+        }
+        if (largest < FLT_MIN) {
+            break;
+        }
+    }
+}
+
+// First index of the increasing samples x not below value.
+static int partial_sum_lower_bound(const float *x, int count, float value) {
+    int low = 0, high = count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (x[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Whether the samples x are the cached ones moved by a whole number of
+// samples, as a pan leaves them on the grid update_curve snaps partial sums
+// to. *shift is how far x[0] sits into the cached samples, negative where x
+// starts before them.
+static bool partial_sum_find_shift(const PartialSum *ps, const float *x, int count, int *shift) {
+    if (count != ps->count || count == 0) {
+        return false;
+    }
+    int s = partial_sum_lower_bound(ps->x, count, x[0]);
+    if (s < count && memcmp(x, ps->x + s, sizeof(float) * (count - s)) == 0) {
+        *shift = s;
+        return true;
+    }
+    s = partial_sum_lower_bound(x, count, ps->x[0]);
+    if (s < count && memcmp(x + s, ps->x, sizeof(float) * (count - s)) == 0) {
+        *shift = -s;
+        return true;
+    }
+    return false;
+}
+
+static void partial_sum_rebuild(PartialSum *ps, int first, int last) {
+    memset(ps->sum + first, 0, sizeof(float) * (last - first));
+    memset(ps->compensation + first, 0, sizeof(float) * (last - first));
+    if (partial_sum_is_taylor(ps->series)) {
+        partial_sum_rebuild_taylor(ps, first, last);
+    } else {
+        partial_sum_rebuild_fourier(ps, first, last);
+    }
+}
+
+// Updates the cached sums to the samples x and the current term count, and
+// copies them out. A pan keeps the sums of the samples still in view and
+// only sums the ones it brings in.
+void partial_sum_sample(PartialSum *ps, const float *x, float *out, int count) {
+    count = (count > PARTIAL_SUM_MAX_SAMPLES) ? PARTIAL_SUM_MAX_SAMPLES : count;
+    int shift = 0;
+    bool shifted = partial_sum_find_shift(ps, x, count, &shift);
+    int change = ps->terms - ps->summed;
+    // Taking a Taylor term back would leave its rounding, up to
+    // PARTIAL_SUM_TAYLOR_LIMIT * FLT_EPSILON, in a sum of order one; summing
+    // again stops within a few hundred terms, where the powers pass the
+    // limit or underflow.
+    bool taylor_shrinks = partial_sum_is_taylor(ps->series) && change < 0;
+    if (!shifted || taylor_shrinks || change > PARTIAL_SUM_MAX_STEPS || change < -PARTIAL_SUM_MAX_STEPS) {
+        memcpy(ps->x, x, sizeof(float) * count);
+        ps->count = count;
+        ps->summed = ps->terms;
+        partial_sum_rebuild(ps, 0, count);
+    } else if (shift != 0) {
+        int kept = count - abs(shift);
+        int from = (shift > 0) ? shift : 0, to = (shift > 0) ? 0 : -shift;
+        memmove(ps->sum + to, ps->sum + from, sizeof(float) * kept);
+        memmove(ps->compensation + to, ps->compensation + from, sizeof(float) * kept);
+        memmove(ps->limit + to, ps->limit + from, sizeof(int) * kept);
+        memcpy(ps->x, x, sizeof(float) * count);
+        if (shift > 0) {
+            partial_sum_rebuild(ps, kept, count);
+        } else {
+            partial_sum_rebuild(ps, 0, -shift);
+        }
+    }
+    for (; ps->summed < ps->terms; ps->summed++) {
+        partial_sum_step_term(ps, ps->summed, 1);
+    }
+    for (; ps->summed > ps->terms; ps->summed--) {
+        partial_sum_step_term(ps, ps->summed - 1, -1);
+    }
+
+    float (*target)(float) = partial_sum_infos[ps->series].target;
+    ps->peak = -INFINITY;
+    ps->max_error = 0;
+    for (int j = 0; j < count; j++) {
+        out[j] = ps->sum[j] - ps->compensation[j];
+        ps->peak = fmaxf(ps->peak, out[j]);
+        float error = fabsf(out[j] - target(x[j]));
+        ps->max_error = isnan(error) ? ps->max_error : fmaxf(ps->max_error, error);
+    }
+}
+
+// The first terms of series at one point, in double. Takes the series by
+// value, so the spectrum worker can use it while the panel steps its terms.
+static float partial_sum_evaluate_terms(PartialSumSeries series, float point, int terms, float x) {
+    double sum = 0;
+    if (partial_sum_is_taylor(series)) {
+        double d = (double)x - point;
+        double power = 1;
+        int limit = partial_sum_taylor_limit(d);
+        for (int k = 0; k < terms && k < limit && (power != 0 || k == 0); k++) {
+            sum += partial_sum_derivative(series, point, k) * power;
+            power *= d / (k + 1);
+        }
+        return (float)sum;
+    }
+    int first, second;
+    double coefficient;
+    partial_sum_harmonic(series, 0, &first, &coefficient);
+    partial_sum_harmonic(series, 1, &second, &coefficient);
+    double rotation_re = cos((second - first) * (double)x), rotation_im = sin((second - first) * (double)x);
+    double re = cos(first * (double)x), im = sin(first * (double)x);
+    for (int i = 0; i < terms; i++) {
+        int harmonic;
+        partial_sum_harmonic(series, i, &harmonic, &coefficient);
+        sum += coefficient * im;
+        double next_re = re * rotation_re - im * rotation_im;
+        im = re * rotation_im + im * rotation_re;
+        re = next_re;
+    }
+    return (float)sum;
+}
+
+// The partial sum at one point, for the panel's marker.
+float partial_sum_evaluate(const PartialSum *ps, float x) {
+    return partial_sum_evaluate_terms(ps->series, ps->point, ps->terms, x);
+}
+
+static void partial_sum_apply(TrigonometricFunction *tf) {
+    const PartialSumInfo *info = &partial_sum_infos[tf->partial_sum->series];
+    tf->function = info->target;
+    tf->range = info->range;
+    snprintf(tf->name, sizeof(tf->name), "%s", info->name);
+    tf->approximants.count = 0;
+    tf->partial_sum->count = 0;
+    tf->dirty = true;
+}
+
+// The series whose registry token is name, NULL if there is none.
+PartialSum *partial_sum_create(const char *name) {
+    for (int s = 0; s < PARTIAL_SUM_SERIES_COUNT; s++) {
+        const PartialSumInfo *info = &partial_sum_infos[s];
+        if (strcmp(name, info->token) == 0) {
+            PartialSum *ps = calloc(1, sizeof(PartialSum));
+            ps->series = (PartialSumSeries)s;
+            ps->terms = PARTIAL_SUM_DEFAULT_TERMS;
+            ps->restore_function = info->target;
+            ps->restore_range = info->range;
+            snprintf(ps->restore_name, sizeof(ps->restore_name), "%s", info->name);
+            return ps;
+        }
+    }
+    return NULL;
+}
+
+// Gives the panel back the function it had before it plotted a series.
+void partial_sum_release(TrigonometricFunction *tf) {
+    PartialSum *ps = tf->partial_sum;
+    if (ps == NULL) {
+        return;
+    }
+    tf->function = ps->restore_function;
+    tf->range = ps->restore_range;
+    memcpy(tf->name, ps->restore_name, sizeof(tf->name));
+    free(ps);
+    tf->partial_sum = NULL;
+    tf->dirty = true;
+}
+
+// Turns a built-in panel into the next series, the Taylor series expanded
+// around point. After the last series the panel gets its function back.
+void partial_sum_cycle(TrigonometricFunction *tf, float point) {
+    PartialSum *ps = tf->partial_sum;
+    if (ps == NULL) {
+        if (tf->expression != NULL || tf->evaluate_batch != NULL) {
+            return;
+        }
+        ps = calloc(1, sizeof(PartialSum));
+        ps->series = PARTIAL_SUM_SQUARE;
+        ps->terms = PARTIAL_SUM_DEFAULT_TERMS;
+        ps->restore_function = tf->function;
+        ps->restore_range = tf->range;
+        memcpy(ps->restore_name, tf->name, sizeof(ps->restore_name));
+        tf->partial_sum = ps;
+    } else if (ps->series + 1 == PARTIAL_SUM_SERIES_COUNT) {
+        partial_sum_release(tf);
+        return;
+    } else {
+        ps->series++;
+    }
+    ps->point = point;
+    partial_sum_apply(tf);
+}
+
+// By one term, or doubling and halving with scale.
+void partial_sum_step(TrigonometricFunction *tf, int direction, bool scale) {
+    PartialSum *ps = tf->partial_sum;
+    if (ps == NULL) {
+        return;
+    }
+    int terms = scale ? ((direction > 0) ? ps->terms * 2 : ps->terms / 2) : ps->terms + direction;
+    terms = (terms < 1) ? 1 : (terms > PARTIAL_SUM_MAX_TERMS) ? PARTIAL_SUM_MAX_TERMS : terms;
+    if (terms != ps->terms) {
+        ps->terms = terms;
+        tf->dirty = true;
+    }
+}
+
+// Drawn over the panel after trigonometric_function_draw, which plots the
+// sums: the target faintly behind them and, for a discontinuous target, the
+// peak the sums overshoot to.
+void partial_sum_draw(TrigonometricFunction *tf, Font *font) {
+    PartialSum *ps = tf->partial_sum;
+    if (ps == NULL || tf->curve_count == 0 || ps->count == 0) {
+        return;
+    }
+    const PartialSumInfo *info = &partial_sum_infos[ps->series];
+    float top = tf->position.y;
+    float bottom = tf->position.y + tf->size.y;
+    for (int j = 0; j <= tf->curve_count && j * TRIGONOMETRIC_FUNCTION_SUBSAMPLES < ps->count; j++) {
+        float y = trigonometric_function_value_to_y(tf, info->target(ps->x[j * TRIGONOMETRIC_FUNCTION_SUBSAMPLES]));
+        ps->reference[j] = (Vector2){ tf->curve[j].x, (y < top) ? top : (y > bottom) ? bottom : y };
+    }
+    render_line_strip(ps->reference, tf->curve_count + 1, ColorAlpha(MAIN_COL, 0.35f));
+
+    const char *detail;
+    if (info->jump > 0) {
+        float y = trigonometric_function_value_to_y(tf, ps->peak);
+        if (y > top && y < bottom) {
+            render_line((Vector2){tf->position.x, y}, (Vector2){tf->position.x + tf->size.x, y}, LINE_SMALL, ColorAlpha(tf->color, 0.5f));
+        }
+        // Gibbs: the overshoot past the top of the jump, in parts of the jump.
+        float target_top = (ps->series == PARTIAL_SUM_SQUARE) ? 1.0f : (float)TRIG_PI;
+        detail = TextFormat("overshoot %.2f%%", (ps->peak - target_top) / info->jump * 100);
+    } else {
+        detail = TextFormat("err %.2g", ps->max_error);
+    }
+    const char *around = partial_sum_is_taylor(ps->series) ? TextFormat(" at %.2f", ps->point) : "";
+    draw_text_centered(
+        font,
+        TEXT_FLAG_BACKING_RECTANGLE,
+        (Vector2){tf->position.x + tf->size.x/2, tf->position.y + layout.small_label_offset},
+        0,
+        TextFormat("%s%s  n = %d  %s", info->name, around, ps->terms, detail),
+        tf->color
+    );
+}
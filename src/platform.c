@@ -0,0 +1,293 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #include <windows.h>
+    #undef near
+    #undef far
+    #define PLATFORM_LIBRARY_SUFFIX ".dll"
+#else
+    #include <dirent.h>
+    #include <dlfcn.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define PLATFORM_LIBRARY_SUFFIX ".so"
+#endif
+
+typedef struct MappedFile {
+    void *data;
+    uint64_t size;
+    bool writable;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+#ifdef _WIN32
+
+static bool platform_map(MappedFile *mf, const char *path, uint64_t size, bool writable) {
+    mf->data = NULL;
+    mf->writable = writable;
+    mf->file = CreateFileA(
+        path,
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        writable ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL
+    );
+    if (mf->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    if (!writable) {
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(mf->file, &file_size)) {
+            CloseHandle(mf->file);
+            return false;
+        }
+        size = (uint64_t)file_size.QuadPart;
+    }
+    mf->size = size;
+    if (size == 0) {
+        CloseHandle(mf->file);
+        return false;
+    }
+    mf->mapping = CreateFileMappingA(
+        mf->file,
+        NULL,
+        writable ? PAGE_READWRITE : PAGE_READONLY,
+        (DWORD)(size >> 32),
+        (DWORD)(size & 0xffffffff),
+        NULL
+    );
+    if (mf->mapping == NULL) {
+        CloseHandle(mf->file);
+        return false;
+    }
+    mf->data = MapViewOfFile(mf->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (mf->data == NULL) {
+        CloseHandle(mf->mapping);
+        CloseHandle(mf->file);
+        return false;
+    }
+    return true;
+}
+
+void platform_unmap_file(MappedFile *mf) {
+    if (mf->data == NULL) {
+        return;
+    }
+    if (mf->writable) {
+        FlushViewOfFile(mf->data, 0);
+    }
+    UnmapViewOfFile(mf->data);
+    CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+    mf->data = NULL;
+}
+
+int platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+double platform_time_seconds(void) {
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+void *platform_library_open(const char *path) {
+    return (void *)LoadLibraryA(path);
+}
+
+void *platform_library_symbol(void *library, const char *name) {
+    return (void *)GetProcAddress((HMODULE)library, name);
+}
+
+void platform_library_close(void *library) {
+    FreeLibrary((HMODULE)library);
+}
+
+// Calls visit(name, user) for every regular file in the directory.
+void platform_list_directory(const char *directory, void (*visit)(const char *name, void *user), void *user) {
+    char pattern[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*", directory);
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            visit(data.cFileName, user);
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+}
+
+#else
+
+static bool platform_map(MappedFile *mf, const char *path, uint64_t size, bool writable) {
+    mf->data = NULL;
+    mf->writable = writable;
+    mf->fd = writable ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    if (mf->fd < 0) {
+        return false;
+    }
+    if (writable) {
+        if (ftruncate(mf->fd, (off_t)size) != 0) {
+            close(mf->fd);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(mf->fd, &st) != 0) {
+            close(mf->fd);
+            return false;
+        }
+        size = (uint64_t)st.st_size;
+    }
+    mf->size = size;
+    if (size == 0) {
+        close(mf->fd);
+        return false;
+    }
+    void *data = mmap(NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, mf->fd, 0);
+    if (data == MAP_FAILED) {
+        close(mf->fd);
+        return false;
+    }
+    mf->data = data;
+    return true;
+}
+
+void platform_unmap_file(MappedFile *mf) {
+    if (mf->data == NULL) {
+        return;
+    }
+    if (mf->writable) {
+        msync(mf->data, mf->size, MS_SYNC);
+    }
+    munmap(mf->data, mf->size);
+    close(mf->fd);
+    mf->data = NULL;
+}
+
+int platform_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+double platform_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void *platform_library_open(const char *path) {
+    return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+}
+
+void *platform_library_symbol(void *library, const char *name) {
+    return dlsym(library, name);
+}
+
+void platform_library_close(void *library) {
+    dlclose(library);
+}
+
+// Calls visit(name, user) for every regular file in the directory.
+void platform_list_directory(const char *directory, void (*visit)(const char *name, void *user), void *user) {
+    DIR *dir = opendir(directory);
+    if (dir == NULL) {
+        return;
+    }
+    for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        char path[1024];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            visit(entry->d_name, user);
+        }
+    }
+    closedir(dir);
+}
+
+#endif
+
+bool platform_map_file_read(const char *path, MappedFile *mf) {
+    return platform_map(mf, path, 0, false);
+}
+
+bool platform_map_file_write(const char *path, uint64_t size, MappedFile *mf) {
+    return platform_map(mf, path, size, true);
+}
+
+// A path starting with '|' is treated as a shell command to stream into.
+FILE *platform_open_output(const char *path, bool *is_pipe) {
+    *is_pipe = path[0] == '|';
+    if (!*is_pipe) {
+        return fopen(path, "wb");
+    }
+#ifdef _WIN32
+    return _popen(path + 1, "wb");
+#else
+    return popen(path + 1, "w");
+#endif
+}
+
+void platform_close_output(FILE *file, bool is_pipe) {
+    if (!is_pipe) {
+        fclose(file);
+        return;
+    }
+#ifdef _WIN32
+    _pclose(file);
+#else
+    pclose(file);
+#endif
+}
+
+// Modification time in seconds, 0 when the file does not exist.
+int64_t platform_file_mtime(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    return (int64_t)st.st_mtime;
+}
+
+bool platform_copy_file(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    if (in == NULL) {
+        return false;
+    }
+    FILE *out = fopen(to, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+    char buffer[65536];
+    size_t length;
+    bool ok = true;
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        ok = ok && fwrite(buffer, 1, length, out) == length;
+    }
+    fclose(in);
+    ok = (fclose(out) == 0) && ok;
+    return ok;
+}
@@ -0,0 +1,134 @@
+#include "main.h"
+#include "trig_plugin.h"
+#include <stdio.h>
+#include <string.h>
+
+// Loads function kernel plugins (see trig_plugin.h) from a directory and
+// reloads them when their file changes. Each load goes through a private
+// copy of the library, so the original can be rebuilt while it is in use.
+// Replaced libraries stay loaded until shutdown: worker threads may still be
+// running a kernel from the previous version.
+
+#define PLUGIN_MAX 64
+#define PLUGIN_MAX_LOADED 256
+#define PLUGIN_POLL_SECONDS 0.5
+#define PLUGIN_COPY_PREFIX ".loaded-"
+
+typedef struct PluginEntry {
+    char name[128];
+    char path[512];
+    int64_t mtime;
+    int64_t failed_mtime;
+    const TrigPlugin *plugin;
+    int generation;
+} PluginEntry;
+
+typedef struct PluginLibrary {
+    void *library;
+    char copy_path[512];
+} PluginLibrary;
+
+typedef struct PluginHost {
+    char directory[512];
+    PluginEntry entries[PLUGIN_MAX];
+    int entry_count;
+    PluginLibrary loaded[PLUGIN_MAX_LOADED];
+    int loaded_count;
+    double last_poll;
+    bool changed;
+} PluginHost;
+
+void plugin_host_init(PluginHost *host, const char *directory) {
+    memset(host, 0, sizeof(*host));
+    snprintf(host->directory, sizeof(host->directory), "%s", directory);
+    host->last_poll = -PLUGIN_POLL_SECONDS;
+}
+
+static void plugin_host_load(PluginHost *host, PluginEntry *entry, int64_t mtime) {
+    if (host->loaded_count == PLUGIN_MAX_LOADED) {
+        TraceLog(LOG_WARNING, "PLUGIN: Too many reloads, restart to load [%s]", entry->path);
+        entry->failed_mtime = mtime;
+        return;
+    }
+    PluginLibrary *pl = &host->loaded[host->loaded_count];
+    snprintf(pl->copy_path, sizeof(pl->copy_path), "%s/" PLUGIN_COPY_PREFIX "%d-%s", host->directory, entry->generation, entry->name);
+    if (!platform_copy_file(entry->path, pl->copy_path)) {
+        // Most likely still being written, the next poll retries.
+        return;
+    }
+    pl->library = platform_library_open(pl->copy_path);
+    TrigPluginDescribe describe = (pl->library != NULL) ? (TrigPluginDescribe)platform_library_symbol(pl->library, TRIG_PLUGIN_ENTRY) : NULL;
+    const TrigPlugin *plugin = (describe != NULL) ? describe() : NULL;
+    if (plugin == NULL || plugin->abi_version != TRIG_PLUGIN_ABI_VERSION) {
+        TraceLog(
+            LOG_WARNING,
+            "PLUGIN: [%s] %s",
+            entry->path,
+            (pl->library == NULL) ? "failed to load" : (plugin == NULL) ? "has no " TRIG_PLUGIN_ENTRY : "was built for another ABI version"
+        );
+        if (pl->library != NULL) {
+            platform_library_close(pl->library);
+        }
+        remove(pl->copy_path);
+        entry->failed_mtime = mtime;
+        return;
+    }
+    host->loaded_count++;
+    entry->plugin = plugin;
+    entry->mtime = mtime;
+    entry->generation++;
+    host->changed = true;
+    TraceLog(LOG_INFO, "PLUGIN: [%s] loaded, %u functions", entry->path, plugin->function_count);
+}
+
+static void plugin_host_visit(const char *name, void *user) {
+    PluginHost *host = user;
+    size_t length = strlen(name);
+    size_t suffix_length = strlen(PLATFORM_LIBRARY_SUFFIX);
+    if (length <= suffix_length || strcmp(name + length - suffix_length, PLATFORM_LIBRARY_SUFFIX) != 0) {
+        return;
+    }
+    if (strncmp(name, PLUGIN_COPY_PREFIX, strlen(PLUGIN_COPY_PREFIX)) == 0) {
+        return;
+    }
+    PluginEntry *entry = NULL;
+    for (int i = 0; i < host->entry_count; i++) {
+        if (strcmp(host->entries[i].name, name) == 0) {
+            entry = &host->entries[i];
+        }
+    }
+    if (entry == NULL) {
+        if (host->entry_count == PLUGIN_MAX) {
+            return;
+        }
+        entry = &host->entries[host->entry_count++];
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        snprintf(entry->path, sizeof(entry->path), "%s/%s", host->directory, name);
+    }
+    int64_t mtime = platform_file_mtime(entry->path);
+    if (mtime != entry->mtime && mtime != entry->failed_mtime) {
+        plugin_host_load(host, entry, mtime);
+    }
+}
+
+// Rescans the directory at most every PLUGIN_POLL_SECONDS, returns true when
+// a plugin was loaded or reloaded since the last call.
+bool plugin_host_poll(PluginHost *host, double now) {
+    if (now - host->last_poll >= PLUGIN_POLL_SECONDS) {
+        host->last_poll = now;
+        platform_list_directory(host->directory, plugin_host_visit, host);
+    }
+    bool changed = host->changed;
+    host->changed = false;
+    return changed;
+}
+
+void plugin_host_deinit(PluginHost *host) {
+    for (int i = 0; i < host->loaded_count; i++) {
+        platform_library_close(host->loaded[i].library);
+        remove(host->loaded[i].copy_path);
+    }
+    host->loaded_count = 0;
+    host->entry_count = 0;
+}
@@ -0,0 +1,392 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+#include "../raylib/include/rlgl.h"
+
+// Renders the scene at any size by drawing it tile by tile through a zoomed
+// and offset camera. Tiles of one row are assembled into a band, and every
+// band is filtered and compressed onto the PNG's deflate stream, so memory
+// use is one band regardless of the poster size. The compressor is greedy
+// LZ77 with the fixed Huffman codes: it tries the previous byte, the
+// previous pixel and the last position with the same three bytes, which is
+// enough for the flat backgrounds and thin curves a poster is made of.
+
+#define POSTER_TILE 2048
+#define POSTER_CHUNK (1 << 20) // IDAT size, compressed data is flushed in chunks of about this
+#define POSTER_WINDOW 32768 // deflate's largest distance
+#define POSTER_HASH_BITS 15
+#define POSTER_MAX_MATCH 258
+#define POSTER_ADLER_BLOCK 5552 // bytes summed before b can overflow 32 bits
+
+typedef struct PngWriter {
+    FILE *file;
+    int width;
+    int height;
+    uint32_t crc_table[256];
+    uint32_t adler_a;
+    uint32_t adler_b;
+    uint16_t literal_code[288]; // fixed Huffman codes, bit-reversed for the LSB-first stream
+    uint8_t literal_bits[288];
+    uint64_t bit_buffer;
+    int bit_count;
+    unsigned char *previous_row; // unfiltered, zero above the first row
+    unsigned char *sub_row; // the sub filter's residuals, while choosing
+    unsigned char *filtered; // a band, each row with its filter byte
+    size_t filtered_capacity;
+    int32_t *head; // last position of each hash of three bytes in filtered, -1 for none
+    unsigned char *chunk;
+    size_t chunk_length;
+} PngWriter;
+
+static const uint16_t png_length_base[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+static const uint8_t png_length_extra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+static const uint16_t png_distance_base[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+static const uint8_t png_distance_extra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+static uint32_t png_crc(PngWriter *pw, uint32_t crc, const unsigned char *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc = pw->crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+// Adler-32 of the uncompressed stream, reduced once per block instead of per byte.
+static void png_adler(PngWriter *pw, const unsigned char *data, size_t length) {
+    uint32_t a = pw->adler_a, b = pw->adler_b;
+    while (length > 0) {
+        size_t n = (length < POSTER_ADLER_BLOCK) ? length : POSTER_ADLER_BLOCK;
+        for (size_t i = 0; i < n; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += n;
+        length -= n;
+    }
+    pw->adler_a = a;
+    pw->adler_b = b;
+}
+
+static void png_put_u32(unsigned char *dst, uint32_t v) {
+    dst[0] = (unsigned char)(v >> 24);
+    dst[1] = (unsigned char)(v >> 16);
+    dst[2] = (unsigned char)(v >> 8);
+    dst[3] = (unsigned char)v;
+}
+
+static void png_write_chunk(PngWriter *pw, const char *type, const unsigned char *data, size_t length) {
+    unsigned char header[8];
+    png_put_u32(header, (uint32_t)length);
+    memcpy(header + 4, type, 4);
+    uint32_t crc = png_crc(pw, 0xffffffff, header + 4, 4);
+    crc = png_crc(pw, crc, data, length) ^ 0xffffffff;
+    unsigned char footer[4];
+    png_put_u32(footer, crc);
+    fwrite(header, 1, 8, pw->file);
+    if (length > 0) {
+        fwrite(data, 1, length, pw->file);
+    }
+    fwrite(footer, 1, 4, pw->file);
+}
+
+static void png_flush_chunk(PngWriter *pw) {
+    if (pw->chunk_length > 0) {
+        png_write_chunk(pw, "IDAT", pw->chunk, pw->chunk_length);
+        pw->chunk_length = 0;
+    }
+}
+
+// Appends count bits, least significant first, moving whole bytes to the chunk.
+static void png_put_bits(PngWriter *pw, uint32_t bits, int count) {
+    pw->bit_buffer |= (uint64_t)bits << pw->bit_count;
+    pw->bit_count += count;
+    while (pw->bit_count >= 8) {
+        pw->chunk[pw->chunk_length++] = (unsigned char)pw->bit_buffer;
+        pw->bit_buffer >>= 8;
+        pw->bit_count -= 8;
+    }
+}
+
+static void png_put_symbol(PngWriter *pw, int symbol) {
+    png_put_bits(pw, pw->literal_code[symbol], pw->literal_bits[symbol]);
+}
+
+static uint32_t png_reverse_bits(uint32_t code, int count) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < count; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    return reversed;
+}
+
+static void png_put_match(PngWriter *pw, int length, int distance) {
+    int l = 28;
+    while (png_length_base[l] > length) {
+        l--;
+    }
+    png_put_symbol(pw, 257 + l);
+    png_put_bits(pw, (uint32_t)(length - png_length_base[l]), png_length_extra[l]);
+    int d = 29;
+    while (png_distance_base[d] > distance) {
+        d--;
+    }
+    png_put_bits(pw, png_reverse_bits((uint32_t)d, 5), 5);
+    png_put_bits(pw, (uint32_t)(distance - png_distance_base[d]), png_distance_extra[d]);
+}
+
+bool png_writer_open(PngWriter *pw, const char *path, int width, int height) {
+    memset(pw, 0, sizeof(*pw));
+    pw->file = fopen(path, "wb");
+    if (pw->file == NULL) {
+        return false;
+    }
+    pw->width = width;
+    pw->height = height;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+        }
+        pw->crc_table[n] = c;
+    }
+    for (int symbol = 0; symbol < 288; symbol++) {
+        uint32_t code;
+        int bits;
+        if (symbol < 144) {
+            code = 0x30 + symbol, bits = 8;
+        } else if (symbol < 256) {
+            code = 0x190 + (symbol - 144), bits = 9;
+        } else if (symbol < 280) {
+            code = symbol - 256, bits = 7;
+        } else {
+            code = 0xc0 + (symbol - 280), bits = 8;
+        }
+        pw->literal_code[symbol] = (uint16_t)png_reverse_bits(code, bits);
+        pw->literal_bits[symbol] = (uint8_t)bits;
+    }
+    pw->adler_a = 1;
+    pw->previous_row = calloc((size_t)width * 3, 1);
+    pw->sub_row = malloc((size_t)width * 3);
+    pw->head = malloc(sizeof(int32_t) << POSTER_HASH_BITS);
+    pw->chunk = malloc(POSTER_CHUNK + 2 * POSTER_MAX_MATCH);
+
+    static const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    fwrite(signature, 1, 8, pw->file);
+    unsigned char ihdr[13];
+    png_put_u32(ihdr, (uint32_t)width);
+    png_put_u32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;  // bit depth
+    ihdr[9] = 2;  // truecolor rgb
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    png_write_chunk(pw, "IHDR", ihdr, sizeof(ihdr));
+    pw->chunk[pw->chunk_length++] = 0x78;  // zlib header: deflate, 32k window
+    pw->chunk[pw->chunk_length++] = 0x01;
+    return true;
+}
+
+// Residuals of the sub (1) or up (2) filter over a row, with the sum of
+// their magnitudes.
+static long png_filter(int filter, const unsigned char *row, const unsigned char *above, size_t length, unsigned char *out) {
+    long cost = 0;
+    size_t first = (filter == 1) ? 3 : 0; // the first pixel has nothing to its left
+    for (size_t i = 0; i < first; i++) {
+        out[i] = row[i];
+        cost += abs((signed char)out[i]);
+    }
+    const unsigned char *predicted = (filter == 1) ? row : above;
+    for (size_t i = first; i < length; i++) {
+        out[i] = (unsigned char)(row[i] - predicted[i - first]);
+        cost += abs((signed char)out[i]);
+    }
+    return cost;
+}
+
+// Filters one row into dst (filter byte first) with up, or sub where that
+// leaves a smaller sum of magnitudes, the usual heuristic narrowed to the
+// two filters that pay off on flat plots. A row repeating the one above
+// stops at up.
+static void png_filter_row(PngWriter *pw, const unsigned char *row, unsigned char *dst) {
+    size_t length = (size_t)pw->width * 3;
+    dst[0] = 2;
+    long up = png_filter(2, row, pw->previous_row, length, dst + 1);
+    if (up > 0 && png_filter(1, row, NULL, length, pw->sub_row) < up) {
+        dst[0] = 1;
+        memcpy(dst + 1, pw->sub_row, length);
+    }
+    memcpy(pw->previous_row, row, length);
+}
+
+static int png_match_length(const unsigned char *data, size_t position, size_t distance, size_t end) {
+    size_t limit = (end - position < POSTER_MAX_MATCH) ? end - position : POSTER_MAX_MATCH;
+    size_t length = 0;
+    while (length < limit && data[position + length] == data[position + length - distance]) {
+        length++;
+    }
+    return (int)length;
+}
+
+static uint32_t png_hash(const unsigned char *data) {
+    uint32_t v = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16);
+    return (v * 2654435761u) >> (32 - POSTER_HASH_BITS);
+}
+
+// Appends rows (each 3*width bytes, without filter byte) as one fixed
+// Huffman block. Matches stay inside the band.
+void png_writer_write_rows(PngWriter *pw, const unsigned char *rgb, int row_count) {
+    size_t row_size = (size_t)pw->width * 3 + 1;
+    size_t size = row_size * row_count;
+    if (size > pw->filtered_capacity) {
+        pw->filtered = realloc(pw->filtered, size);
+        pw->filtered_capacity = size;
+    }
+    unsigned char *data = pw->filtered;
+    for (int y = 0; y < row_count; y++) {
+        png_filter_row(pw, rgb + (size_t)y * pw->width * 3, data + (size_t)y * row_size);
+    }
+    png_adler(pw, data, size);
+
+    memset(pw->head, 0xff, sizeof(int32_t) << POSTER_HASH_BITS);
+    png_put_bits(pw, 2, 3);  // not final, fixed Huffman codes
+    size_t position = 0;
+    while (position < size) {
+        int length = 0;
+        size_t distance = 0;
+        static const size_t neighbours[2] = { 1, 3 };
+        for (int n = 0; n < 2; n++) {
+            if (position >= neighbours[n] && length < POSTER_MAX_MATCH) {
+                int l = png_match_length(data, position, neighbours[n], size);
+                if (l > length) {
+                    length = l;
+                    distance = neighbours[n];
+                }
+            }
+        }
+        if (position + 3 <= size) {
+            uint32_t h = png_hash(data + position);
+            int32_t candidate = pw->head[h];
+            pw->head[h] = (int32_t)position;
+            if (length < POSTER_MAX_MATCH && candidate >= 0 && position - candidate <= POSTER_WINDOW) {
+                int l = png_match_length(data, position, position - candidate, size);
+                if (l > length) {
+                    length = l;
+                    distance = position - candidate;
+                }
+            }
+        }
+        if (length >= 3) {
+            png_put_match(pw, length, (int)distance);
+            position += length;
+        } else {
+            png_put_symbol(pw, data[position]);
+            position++;
+        }
+        if (pw->chunk_length >= POSTER_CHUNK) {
+            png_flush_chunk(pw);
+        }
+    }
+    png_put_symbol(pw, 256);  // end of block
+    png_flush_chunk(pw);
+}
+
+void png_writer_close(PngWriter *pw) {
+    // Empty final block, padded to a byte, then the adler32 of all uncompressed data.
+    png_put_bits(pw, 3, 3);
+    png_put_symbol(pw, 256);
+    png_put_bits(pw, 0, (8 - pw->bit_count) % 8);
+    png_put_u32(pw->chunk + pw->chunk_length, (pw->adler_b << 16) | pw->adler_a);
+    pw->chunk_length += 4;
+    png_flush_chunk(pw);
+    png_write_chunk(pw, "IEND", NULL, 0);
+    fclose(pw->file);
+    free(pw->previous_row);
+    free(pw->sub_row);
+    free(pw->filtered);
+    free(pw->head);
+    free(pw->chunk);
+}
+
+// size is the poster width, the height follows the window's aspect ratio.
+bool poster_export(Scene *scene, const char *path, int size) {
+    float zoom = (float)size / layout.width;
+    int width = size;
+    int height = (int)(layout.height * zoom);
+    PngWriter pw;
+    if (size <= 0 || !png_writer_open(&pw, path, width, height)) {
+        TraceLog(LOG_WARNING, "POSTER: Failed to open [%s]", path);
+        return false;
+    }
+    double start_time = GetTime();
+
+    // A font rasterized at the final size keeps the text sharp, up to 512 px
+    // where its atlas reaches 4096 square.
+    Font screen_font = scene->font;
+    int font_size = (int)(32 * zoom);
+    scene->font = LoadFontEx("arial.ttf", (font_size > 512) ? 512 : font_size, NULL, 0);
+    SetTextureFilter(scene->font.texture, TEXTURE_FILTER_BILINEAR);
+
+    // Cached dashboard circles and curves would be scaled up from screen resolution.
+    scene->dashboard.direct = true;
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        scene->trigonometric_functions[i].curve_scale = zoom;
+        scene->trigonometric_functions[i].dirty = true;
+    }
+    scene_settle(scene);
+
+    RenderTexture2D tile = LoadRenderTexture(POSTER_TILE, POSTER_TILE);
+    unsigned char *band = malloc((size_t)width * POSTER_TILE * 3);
+
+    bool read_back = true;
+    for (int tile_y = 0; tile_y < height && read_back; tile_y += POSTER_TILE) {
+        int band_height = (height - tile_y < POSTER_TILE) ? (height - tile_y) : POSTER_TILE;
+        for (int tile_x = 0; tile_x < width; tile_x += POSTER_TILE) {
+            int tile_width = (width - tile_x < POSTER_TILE) ? (width - tile_x) : POSTER_TILE;
+            BeginTextureMode(tile);
+            ClearBackground(BLACK);
+            BeginMode2D((Camera2D){ .offset = {(float)-tile_x, (float)-tile_y}, .zoom = zoom });
+            scene_draw(scene);
+            EndMode2D();
+            EndTextureMode();
+
+            unsigned char *pixels = rlReadTexturePixels(tile.texture.id, POSTER_TILE, POSTER_TILE, tile.texture.format);
+            if (pixels == NULL) {
+                read_back = false;
+                break;
+            }
+            for (int y = 0; y < band_height; y++) {
+                // Render texture rows are bottom-up.
+                const unsigned char *src = pixels + (size_t)(POSTER_TILE - 1 - y) * POSTER_TILE * 4;
+                unsigned char *dst = band + ((size_t)y * width + tile_x) * 3;
+                for (int x = 0; x < tile_width; x++) {
+                    dst[x*3+0] = src[x*4+0];
+                    dst[x*3+1] = src[x*4+1];
+                    dst[x*3+2] = src[x*4+2];
+                }
+            }
+            RL_FREE(pixels);
+        }
+        if (read_back) {
+            png_writer_write_rows(&pw, band, band_height);
+        }
+    }
+
+    png_writer_close(&pw);
+    free(band);
+    UnloadRenderTexture(tile);
+    UnloadFont(scene->font);
+    scene->font = screen_font;
+    scene->dashboard.direct = false;
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        scene->trigonometric_functions[i].curve_scale = 1;
+        scene->trigonometric_functions[i].dirty = true;
+    }
+    if (!read_back) {
+        remove(path);
+        TraceLog(LOG_WARNING, "POSTER: Failed to read back a tile, [%s] not written", path);
+        return false;
+    }
+    TraceLog(LOG_INFO, "POSTER: %dx%d written to [%s] in %.2fs", width, height, path, GetTime() - start_time);
+    return true;
+}
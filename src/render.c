@@ -0,0 +1,382 @@
+#include "main.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Every draw function goes through these wrappers. With no vector writer
+// active they forward to raylib, otherwise the same calls are streamed into
+// an SVG or PDF file, so an export replays exactly what is on screen.
+
+#define VECTOR_PDF_MAX_OBJECTS 8
+
+typedef enum VectorFormat {
+    VECTOR_FORMAT_SVG,
+    VECTOR_FORMAT_PDF,
+} VectorFormat;
+
+typedef struct VectorWriter {
+    FILE *file;
+    VectorFormat format;
+    Vector2 size;
+    long pdf_offsets[VECTOR_PDF_MAX_OBJECTS];
+    long pdf_stream_start;
+} VectorWriter;
+
+static VectorWriter *render_vector_writer = NULL;
+
+static inline float render_color_channel(unsigned char channel) {
+    return channel / 255.0f;
+}
+
+static void vector_pdf_begin_object(VectorWriter *vw, int id) {
+    vw->pdf_offsets[id] = ftell(vw->file);
+    fprintf(vw->file, "%d 0 obj\n", id);
+}
+
+bool vector_writer_open(VectorWriter *vw, const char *path, VectorFormat format, Vector2 size) {
+    vw->file = fopen(path, "wb");
+    if (vw->file == NULL) {
+        return false;
+    }
+    vw->format = format;
+    vw->size = size;
+    if (format == VECTOR_FORMAT_SVG) {
+        fprintf(
+            vw->file,
+            "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%g\" height=\"%g\" viewBox=\"0 0 %g %g\">\n"
+            "<rect width=\"100%%\" height=\"100%%\" fill=\"black\"/>\n",
+            size.x, size.y, size.x, size.y
+        );
+    } else {
+        // Objects: 1 catalog, 2 pages, 3 page, 4 font, 5 content stream, 6 stream length.
+        fprintf(vw->file, "%%PDF-1.4\n");
+        vector_pdf_begin_object(vw, 1);
+        fprintf(vw->file, "<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+        vector_pdf_begin_object(vw, 2);
+        fprintf(vw->file, "<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n");
+        vector_pdf_begin_object(vw, 3);
+        fprintf(
+            vw->file,
+            "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %g %g] /Resources << /Font << /F1 4 0 R >> >> /Contents 5 0 R >>\nendobj\n",
+            size.x, size.y
+        );
+        vector_pdf_begin_object(vw, 4);
+        fprintf(vw->file, "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>\nendobj\n");
+        vector_pdf_begin_object(vw, 5);
+        fprintf(vw->file, "<< /Length 6 0 R >>\nstream\n");
+        vw->pdf_stream_start = ftell(vw->file);
+        // Flip to raylib's top-left origin, black background, round caps and joins.
+        fprintf(vw->file, "1 0 0 -1 0 %g cm\n0 0 0 rg 0 0 %g %g re f\n1 J 1 j\n", size.y, size.x, size.y);
+    }
+    return true;
+}
+
+void vector_writer_close(VectorWriter *vw) {
+    if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "</svg>\n");
+    } else {
+        long stream_length = ftell(vw->file) - vw->pdf_stream_start;
+        fprintf(vw->file, "endstream\nendobj\n");
+        vector_pdf_begin_object(vw, 6);
+        fprintf(vw->file, "%ld\nendobj\n", stream_length);
+        long xref = ftell(vw->file);
+        fprintf(vw->file, "xref\n0 7\n0000000000 65535 f \n");
+        for (int i = 1; i <= 6; i++) {
+            fprintf(vw->file, "%010ld 00000 n \n", vw->pdf_offsets[i]);
+        }
+        fprintf(vw->file, "trailer\n<< /Size 7 /Root 1 0 R >>\nstartxref\n%ld\n%%%%EOF\n", xref);
+    }
+    fclose(vw->file);
+}
+
+void render_begin_vector(VectorWriter *vw) {
+    render_vector_writer = vw;
+}
+
+void render_end_vector(void) {
+    render_vector_writer = NULL;
+}
+
+// Cached render targets have no vector form, callers draw the real thing instead.
+bool render_is_vector(void) {
+    return render_vector_writer != NULL;
+}
+
+// Draws the contents of a render target into dest. Render target rows are
+// bottom-up, hence the negative source height.
+void render_target(RenderTexture2D target, Rectangle dest) {
+    Rectangle source = { 0, 0, (float)target.texture.width, -(float)target.texture.height };
+    DrawTexturePro(target.texture, source, dest, (Vector2){0,0}, 0, WHITE);
+}
+
+// PDF output has no transparency group, so alpha is folded into the color
+// against the black background everything is drawn on.
+static void vector_pdf_color(VectorWriter *vw, Color color, bool stroke) {
+    float a = render_color_channel(color.a);
+    fprintf(
+        vw->file,
+        stroke ? "%.3f %.3f %.3f RG\n" : "%.3f %.3f %.3f rg\n",
+        render_color_channel(color.r) * a,
+        render_color_channel(color.g) * a,
+        render_color_channel(color.b) * a
+    );
+}
+
+static void vector_svg_paint(VectorWriter *vw, const char *attribute, Color color) {
+    fprintf(vw->file, " %s=\"#%02x%02x%02x\"", attribute, color.r, color.g, color.b);
+    if (color.a != 255) {
+        fprintf(vw->file, " %s-opacity=\"%.3f\"", attribute, render_color_channel(color.a));
+    }
+}
+
+static void vector_pdf_circle_path(VectorWriter *vw, Vector2 center, float radius) {
+    const float k = 0.5523f * radius;
+    float x = center.x, y = center.y, r = radius;
+    fprintf(vw->file, "%.2f %.2f m\n", x + r, y);
+    fprintf(vw->file, "%.2f %.2f %.2f %.2f %.2f %.2f c\n", x + r, y + k, x + k, y + r, x, y + r);
+    fprintf(vw->file, "%.2f %.2f %.2f %.2f %.2f %.2f c\n", x - k, y + r, x - r, y + k, x - r, y);
+    fprintf(vw->file, "%.2f %.2f %.2f %.2f %.2f %.2f c\n", x - r, y - k, x - k, y - r, x, y - r);
+    fprintf(vw->file, "%.2f %.2f %.2f %.2f %.2f %.2f c\n", x + k, y - r, x + r, y - k, x + r, y);
+}
+
+void render_line(Vector2 start, Vector2 end, float thick, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (vw == NULL) {
+        if (thick <= LINE_SMALL) {
+            DrawLineV(start, end, color);
+        } else {
+            DrawLineEx(start, end, thick, color);
+        }
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<line x1=\"%.2f\" y1=\"%.2f\" x2=\"%.2f\" y2=\"%.2f\" stroke-width=\"%g\"", start.x, start.y, end.x, end.y, thick);
+        vector_svg_paint(vw, "stroke", color);
+        fprintf(vw->file, "/>\n");
+    } else {
+        vector_pdf_color(vw, color, true);
+        fprintf(vw->file, "%g w %.2f %.2f m %.2f %.2f l S\n", thick, start.x, start.y, end.x, end.y);
+    }
+}
+
+// One polyline through count points, a single draw call in the window.
+void render_line_strip(const Vector2 *points, int count, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (count < 2) {
+        return;
+    }
+    if (vw == NULL) {
+        DrawLineStrip(points, count, color);
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<polyline fill=\"none\" stroke-width=\"1\"");
+        vector_svg_paint(vw, "stroke", color);
+        fprintf(vw->file, " points=\"");
+        for (int i = 0; i < count; i++) {
+            fprintf(vw->file, "%.2f,%.2f ", points[i].x, points[i].y);
+        }
+        fprintf(vw->file, "\"/>\n");
+    } else {
+        vector_pdf_color(vw, color, true);
+        fprintf(vw->file, "1 w %.2f %.2f m\n", points[0].x, points[0].y);
+        for (int i = 1; i < count; i++) {
+            fprintf(vw->file, "%.2f %.2f l\n", points[i].x, points[i].y);
+        }
+        fprintf(vw->file, "S\n");
+    }
+}
+
+void render_circle(Vector2 center, float radius, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (vw == NULL) {
+        DrawCircleV(center, radius, color);
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\"", center.x, center.y, radius);
+        vector_svg_paint(vw, "fill", color);
+        fprintf(vw->file, "/>\n");
+    } else {
+        vector_pdf_color(vw, color, false);
+        vector_pdf_circle_path(vw, center, radius);
+        fprintf(vw->file, "f\n");
+    }
+}
+
+void render_circle_lines(Vector2 center, float radius, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (vw == NULL) {
+        DrawCircleLinesV(center, radius, color);
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"none\" stroke-width=\"1\"", center.x, center.y, radius);
+        vector_svg_paint(vw, "stroke", color);
+        fprintf(vw->file, "/>\n");
+    } else {
+        vector_pdf_color(vw, color, true);
+        fprintf(vw->file, "1 w\n");
+        vector_pdf_circle_path(vw, center, radius);
+        fprintf(vw->file, "S\n");
+    }
+}
+
+// Angles in degrees, measured like raylib: clockwise on screen from the +x axis.
+static void render_vector_sector(VectorWriter *vw, Vector2 center, float radius, float start_angle, float end_angle, bool filled, Color color) {
+    int segments = (int)(fabsf(end_angle - start_angle) / 4) + 1;
+    if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<path d=\"M%.2f %.2f", center.x, center.y);
+    } else {
+        vector_pdf_color(vw, color, !filled);
+        fprintf(vw->file, "1 w %.2f %.2f m\n", center.x, center.y);
+    }
+    for (int i = 0; i <= segments; i++) {
+        float angle = start_angle + (end_angle - start_angle) * i / segments;
+        float s, c;
+        trig_sincosd(angle, &s, &c);
+        Vector2 p = { center.x + c * radius, center.y + s * radius };
+        fprintf(vw->file, (vw->format == VECTOR_FORMAT_SVG) ? " L%.2f %.2f" : "%.2f %.2f l\n", p.x, p.y);
+    }
+    if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, " Z\"");
+        if (filled) {
+            vector_svg_paint(vw, "fill", color);
+        } else {
+            fprintf(vw->file, " fill=\"none\" stroke-width=\"1\"");
+            vector_svg_paint(vw, "stroke", color);
+        }
+        fprintf(vw->file, "/>\n");
+    } else {
+        fprintf(vw->file, filled ? "h f\n" : "h S\n");
+    }
+}
+
+void render_circle_sector(Vector2 center, float radius, float start_angle, float end_angle, int segments, Color color) {
+    if (render_vector_writer == NULL) {
+        DrawCircleSector(center, radius, start_angle, end_angle, segments, color);
+    } else {
+        render_vector_sector(render_vector_writer, center, radius, start_angle, end_angle, true, color);
+    }
+}
+
+void render_circle_sector_lines(Vector2 center, float radius, float start_angle, float end_angle, int segments, Color color) {
+    if (render_vector_writer == NULL) {
+        DrawCircleSectorLines(center, radius, start_angle, end_angle, segments, color);
+    } else {
+        render_vector_sector(render_vector_writer, center, radius, start_angle, end_angle, false, color);
+    }
+}
+
+void render_rectangle(Rectangle rec, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (vw == NULL) {
+        DrawRectangleRec(rec, color);
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\"", rec.x, rec.y, rec.width, rec.height);
+        vector_svg_paint(vw, "fill", color);
+        fprintf(vw->file, "/>\n");
+    } else {
+        vector_pdf_color(vw, color, false);
+        fprintf(vw->file, "%.2f %.2f %.2f %.2f re f\n", rec.x, rec.y, rec.width, rec.height);
+    }
+}
+
+void render_rectangle_lines(Rectangle rec, float thick, Color color) {
+    VectorWriter *vw = render_vector_writer;
+    if (vw == NULL) {
+        DrawRectangleLinesEx(rec, thick, color);
+    } else if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(vw->file, "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" fill=\"none\" stroke-width=\"%g\"", rec.x, rec.y, rec.width, rec.height, thick);
+        vector_svg_paint(vw, "stroke", color);
+        fprintf(vw->file, "/>\n");
+    } else {
+        vector_pdf_color(vw, color, true);
+        fprintf(vw->file, "%g w %.2f %.2f %.2f %.2f re S\n", thick, rec.x, rec.y, rec.width, rec.height);
+    }
+}
+
+static void render_vector_text(VectorWriter *vw, Vector2 position, Vector2 dimensions, float rotation, float size, const char *text, Color color) {
+    if (vw->format == VECTOR_FORMAT_SVG) {
+        fprintf(
+            vw->file,
+            "<text x=\"%.2f\" y=\"%.2f\" transform=\"rotate(%g %.2f %.2f)\" font-family=\"Arial, Helvetica, sans-serif\" font-size=\"%g\" text-anchor=\"middle\" dominant-baseline=\"central\"",
+            position.x, position.y, rotation, position.x, position.y, size
+        );
+        vector_svg_paint(vw, "fill", color);
+        fprintf(vw->file, ">");
+        for (const char *c = text; *c; c++) {
+            switch (*c) {
+            case '<': fprintf(vw->file, "&lt;"); break;
+            case '>': fprintf(vw->file, "&gt;"); break;
+            case '&': fprintf(vw->file, "&amp;"); break;
+            default: fputc(*c, vw->file); break;
+            }
+        }
+        fprintf(vw->file, "</text>\n");
+    } else {
+        // The text matrix un-flips the page transform and rotates around the
+        // text center, then the baseline is placed roughly a third below it.
+        float c, s;
+        trig_sincosd(rotation, &s, &c);
+        float dx = -dimensions.x / 2, dy = size * 0.35f;
+        vector_pdf_color(vw, color, false);
+        fprintf(
+            vw->file,
+            "BT /F1 %g Tf %.4f %.4f %.4f %.4f %.2f %.2f Tm (",
+            size, c, s, s, -c,
+            position.x + dx * c - dy * s,
+            position.y + dx * s + dy * c
+        );
+        for (const char *t = text; *t; t++) {
+            if (*t == '(' || *t == ')' || *t == '\\') {
+                fputc('\\', vw->file);
+            }
+            fputc(*t, vw->file);
+        }
+        fprintf(vw->file, ") Tj ET\n");
+    }
+}
+
+void draw_text_centered(Font *font, TextFlags flags, Vector2 position, float rotation, const char *text, Color color) {
+    float size = (has_flag(flags, TEXT_FLAG_LARGE) ? 40 : 30) * layout.text_scale;
+    int spacing = 2;
+    Vector2 text_dimensions = MeasureTextEx(*font, text, size, spacing);
+    Vector2 text_origin = {
+        text_dimensions.x/2,
+        text_dimensions.y/2
+    };
+    const float padding = 5;
+    if (has_flag(flags, TEXT_FLAG_BACKING_RECTANGLE)) {
+        render_rectangle(
+            (Rectangle) {
+                position.x - (text_dimensions.x/2) - padding,
+                position.y - (text_dimensions.y/2) - padding,
+                text_dimensions.x + (padding*2),
+                text_dimensions.y + (padding*2),
+            },
+            (Color) {0,0,0,128}
+        );
+    }
+    if (render_vector_writer == NULL) {
+        DrawTextPro(*font, text, position, text_origin, rotation, size, spacing, color);
+    } else {
+        render_vector_text(render_vector_writer, position, text_dimensions, rotation, size, text, color);
+    }
+}
+
+// Loads only the glyph metrics of a font, which is all MeasureTextEx needs.
+// Used for exports without a window, where no texture atlas can be created.
+Font render_load_font_metrics(const char *path) {
+    Font font = {0};
+    int data_size = 0;
+    unsigned char *data = LoadFileData(path, &data_size);
+    if (data == NULL) {
+        return font;
+    }
+    font.baseSize = 32;
+    font.glyphCount = 95;
+    font.glyphs = LoadFontData(data, data_size, font.baseSize, NULL, font.glyphCount, FONT_DEFAULT);
+    UnloadFileData(data);
+    if (font.glyphs == NULL) {
+        font.glyphCount = 0;
+        return font;
+    }
+    font.recs = calloc(font.glyphCount, sizeof(Rectangle));
+    for (int i = 0; i < font.glyphCount; i++) {
+        font.recs[i].width = (float)font.glyphs[i].image.width;
+        font.recs[i].height = (float)font.glyphs[i].image.height;
+    }
+    return font;
+}
@@ -0,0 +1,339 @@
+#include "main.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENE_SIGNIFICANT_ANGLES_COUNT 16
+
+typedef struct Scene {
+    Font font;
+    UnitCircle unit_circle;
+    TrigonometricFunction *trigonometric_functions;
+    int trigonometric_functions_count;
+    int trigonometric_functions_capacity;
+    float significant_angles[SCENE_SIGNIFICANT_ANGLES_COUNT];
+    int significant_angles_count;
+    Dataset *dataset;
+    SineFitter sine_fitter;
+    bool sine_fit_visible;
+    SpectrumPanel spectrum;
+    ApproximantBench approximant_bench;
+    int cordic_steps; // CORDIC micro-rotations drawn on the unit circle, 0 for none
+    Swarm swarm;
+    Epicycle epicycle;
+    Dashboard dashboard; // replaces everything else while on
+    HitIndex hit_index;
+    ExpressionEditor expression_editor;
+} Scene;
+
+// Copies the cached layout rectangles into the scene, called after every layout_update.
+void scene_apply_layout(Scene *scene) {
+    UnitCircle *unit_circle = &scene->unit_circle;
+    unit_circle->position = (Vector2){layout.unit_circle.x,layout.unit_circle.y};
+    unit_circle->radius = layout.unit_circle.width/2;
+    unit_circle->center = (Vector2){
+        unit_circle->position.x + unit_circle->radius,
+        unit_circle->position.y + unit_circle->radius
+    };
+    unit_circle_update_degrees(unit_circle, unit_circle->deg);
+
+    layout_set_panel_count(scene->trigonometric_functions_count);
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        scene->trigonometric_functions[i].position = layout_panel_position(i);
+        scene->trigonometric_functions[i].size = layout.panel_size;
+        scene->trigonometric_functions[i].dirty = true;
+    }
+
+    scene->spectrum.position = (Vector2){layout.spectrum.x,layout.spectrum.y};
+    scene->spectrum.size = (Vector2){layout.spectrum.width,layout.spectrum.height};
+    dashboard_apply_layout(&scene->dashboard);
+
+    // The unit circle wins where its bounding box overlaps anything else.
+    HitIndex *hit_index = &scene->hit_index;
+    hit_index_clear(hit_index);
+    hit_index_add(hit_index, layout.unit_circle, HIT_UNIT_CIRCLE, 0, 2);
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        TrigonometricFunction *tf = &scene->trigonometric_functions[i];
+        if (!layout_panel_visible(tf->position)) {
+            continue;
+        }
+        hit_index_add(hit_index, (Rectangle){tf->position.x,tf->position.y,tf->size.x,tf->size.y}, HIT_PANEL, i, 1);
+    }
+    hit_index_build(hit_index, layout.width, layout.height);
+}
+
+// Panels live in a growable array that may move on any add, including the
+// ones scene_sync_plugins makes at runtime; it rebases the pointers the scene
+// keeps into the array (spectrum source, edited panel) with scene_rebase_functions.
+int scene_add_function(Scene *scene, TrigonometricFunction tf) {
+    if (scene->trigonometric_functions_count == scene->trigonometric_functions_capacity) {
+        int capacity = (scene->trigonometric_functions_capacity == 0) ? 4 : scene->trigonometric_functions_capacity * 2;
+        scene->trigonometric_functions = realloc(scene->trigonometric_functions, sizeof(TrigonometricFunction) * capacity);
+        scene->trigonometric_functions_capacity = capacity;
+    }
+    tf.dirty = true;
+    scene->trigonometric_functions[scene->trigonometric_functions_count] = tf;
+    return scene->trigonometric_functions_count++;
+}
+
+// Keeps pointers held by the scene valid when the panel array moves.
+static void scene_rebase_functions(Scene *scene, TrigonometricFunction *old_base) {
+    TrigonometricFunction *base = scene->trigonometric_functions;
+    if (base == old_base) {
+        return;
+    }
+    if (scene->spectrum.source_panel != NULL) {
+        scene->spectrum.source_panel = base + (scene->spectrum.source_panel - old_base);
+    }
+    if (scene->expression_editor.target != NULL) {
+        scene->expression_editor.target = base + (scene->expression_editor.target - old_base);
+    }
+}
+
+// Binds every function of every loaded plugin to a panel, matched by plugin
+// and name, so a reload swaps the kernel of the existing panel in place.
+void scene_sync_plugins(Scene *scene, PluginHost *host) {
+    TrigonometricFunction *old_base = scene->trigonometric_functions;
+    bool added = false;
+    for (int p = 0; p < host->entry_count; p++) {
+        const TrigPlugin *plugin = host->entries[p].plugin;
+        for (uint32_t f = 0; plugin != NULL && f < plugin->function_count; f++) {
+            const TrigPluginFunction *pf = &plugin->functions[f];
+            TrigonometricFunction *tf = NULL;
+            for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+                TrigonometricFunction *candidate = &scene->trigonometric_functions[i];
+                if (candidate->plugin == p + 1 && strncmp(candidate->name, pf->name, sizeof(candidate->name) - 1) == 0) {
+                    tf = candidate;
+                }
+            }
+            if (tf == NULL) {
+                int index = scene_add_function(scene, (TrigonometricFunction) {
+                    .function = trig_sin,
+                    .domain = (Domain) {0,PI*2},
+                    .plugin = p + 1,
+                });
+                tf = &scene->trigonometric_functions[index];
+                snprintf(tf->name, sizeof(tf->name), "%s", pf->name);
+                added = true;
+            }
+            tf->evaluate_batch = pf->evaluate_batch;
+            trigonometric_function_invalidate_approximation(tf);
+            tf->range = (Range) {pf->range_min,pf->range_max};
+            tf->color = (Color) {pf->color >> 24, (pf->color >> 16) & 0xff, (pf->color >> 8) & 0xff, pf->color & 0xff};
+            tf->dirty = true;
+        }
+    }
+    scene_rebase_functions(scene, old_base);
+    if (added) {
+        scene_apply_layout(scene);
+    }
+}
+
+// Replaces the panels with the ones listed in a config file, see
+// trigonometric_function_parse for the line format. Blank lines and lines
+// starting with '#' are skipped. Keeps the current panels if none are valid.
+bool scene_load_functions(Scene *scene, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "PANELS: Failed to open [%s]", path);
+        return false;
+    }
+    static const Color palette[] = { SIN_COL, COS_COL, TAN_COL };
+    int previous_count = scene->trigonometric_functions_count;
+    char line[256];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        char *start = line;
+        while (*start == ' ' || *start == '\t') {
+            start++;
+        }
+        if (*start == '#' || *start == '\n' || *start == '\r' || *start == '\0') {
+            continue;
+        }
+        TrigonometricFunction tf;
+        int added = scene->trigonometric_functions_count - previous_count;
+        if (!trigonometric_function_parse(&tf, start, palette[added % 3])) {
+            TraceLog(LOG_WARNING, "PANELS: [%s:%d] invalid panel", path, line_number);
+            continue;
+        }
+        scene_add_function(scene, tf);
+    }
+    fclose(file);
+
+    int added = scene->trigonometric_functions_count - previous_count;
+    if (added == 0) {
+        return false;
+    }
+    for (int i = 0; i < previous_count; i++) {
+        trigonometric_function_free(&scene->trigonometric_functions[i]);
+    }
+    memmove(scene->trigonometric_functions, scene->trigonometric_functions + previous_count, sizeof(TrigonometricFunction) * added);
+    scene->trigonometric_functions_count = added;
+    scene_apply_layout(scene);
+    TraceLog(LOG_INFO, "PANELS: %d panels loaded from [%s]", added, path);
+    return true;
+}
+
+void scene_init(Scene *scene, Font font) {
+    scene->font = font;
+    scene->unit_circle = (UnitCircle){0};
+    scene->hit_index = (HitIndex){0};
+    scene->expression_editor = (ExpressionEditor){0};
+
+    scene->trigonometric_functions = NULL;
+    scene->trigonometric_functions_count = 0;
+    scene->trigonometric_functions_capacity = 0;
+    scene_add_function(scene, (TrigonometricFunction) {
+        .name = "sin",
+        .function = trig_sin,
+        .range = (Range) {-1,1},
+        .domain = (Domain) {0,PI*2},
+        .color = SIN_COL,
+    });
+    scene_add_function(scene, (TrigonometricFunction) {
+        .name = "cos",
+        .function = trig_cos,
+        .range = (Range) {-1,1},
+        .domain = (Domain) {0,PI*2},
+        .color = COS_COL,
+    });
+    scene_add_function(scene, (TrigonometricFunction) {
+        .name = "tan",
+        .function = trig_tan,
+        .range = (Range) {-5,5},
+        .domain = (Domain) {0,PI*2},
+        .color = TAN_COL,
+    });
+
+    scene->significant_angles_count = SCENE_SIGNIFICANT_ANGLES_COUNT;
+    {
+        for (int i = 0; i < 4; i++) {
+            int idx = 4*i;
+            float deg = 90*i;
+            scene->significant_angles[idx+0] = deg+30;
+            scene->significant_angles[idx+1] = deg+45;
+            scene->significant_angles[idx+2] = deg+60;
+            scene->significant_angles[idx+3] = deg+90;
+        }
+    }
+
+    scene->dataset = NULL;
+    scene->sine_fitter = (SineFitter){0};
+    scene->sine_fit_visible = false;
+    scene->cordic_steps = 0;
+    scene->swarm = (Swarm){0};
+    scene->epicycle = (Epicycle){0};
+    scene->dashboard = (Dashboard){0};
+    spectrum_init(&scene->spectrum);
+    approximant_bench_init(&scene->approximant_bench);
+
+    scene_apply_layout(scene);
+
+    { // Unit circle initial angle
+        UnitCircle *unit_circle = &scene->unit_circle;
+        Vector2 angle45 = {
+            unit_circle->center.x + 1,
+            unit_circle->center.y - 1,
+        };
+        unit_circle_update_towards(unit_circle, angle45);
+    }
+}
+
+void scene_deinit(Scene *scene) {
+    spectrum_deinit(&scene->spectrum);
+    approximant_bench_deinit(&scene->approximant_bench);
+    swarm_free(&scene->swarm);
+    epicycle_free(&scene->epicycle);
+    dashboard_free(&scene->dashboard);
+    hit_index_free(&scene->hit_index);
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        trigonometric_function_free(&scene->trigonometric_functions[i]);
+    }
+    free(scene->trigonometric_functions);
+    if (scene->dataset != NULL) {
+        if (scene->sine_fitter.running) {
+            pthread_join(scene->sine_fitter.thread, NULL);
+        }
+        dataset_close(scene->dataset);
+    }
+}
+
+// Draws everything except the background, through the render_* layer so the
+// same call sequence can target the window or a vector file.
+void scene_draw(Scene *scene) {
+    Font *font = &scene->font;
+    UnitCircle *unit_circle = &scene->unit_circle;
+
+    if (scene->dashboard.count > 0) {
+        dashboard_draw(&scene->dashboard, font, scene->significant_angles, scene->significant_angles_count);
+        return;
+    }
+
+    unit_circle_draw_tan(unit_circle, font); // drawn early to not block texts outside of unit circle
+    unit_circle_draw_base(unit_circle);
+    unit_circle_draw_quadrants(unit_circle, font);
+    unit_circle_draw_angles_on_circumference(unit_circle, font, scene->significant_angles, scene->significant_angles_count);
+    unit_circle_draw_right_angle(unit_circle);
+    unit_circle_draw_triangle(unit_circle, font);
+    if (scene->cordic_steps > 0) {
+        unit_circle_draw_cordic(unit_circle, font, scene->cordic_steps);
+    }
+    swarm_draw_circle(&scene->swarm, unit_circle, font);
+    epicycle_draw(&scene->epicycle, unit_circle, font);
+
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        TrigonometricFunction *tf = &(scene->trigonometric_functions[i]);
+        if (layout_panel_visible(tf->position)) {
+            trigonometric_function_draw(tf, font, unit_circle->rad);
+            approximant_draw(&scene->approximant_bench, tf, font);
+            partial_sum_draw(tf, font);
+            swarm_draw_panel(&scene->swarm, tf);
+        }
+    }
+    if (scene->dataset != NULL && layout_panel_visible(scene->trigonometric_functions[0].position)) {
+        dataset_draw(scene->dataset, &(scene->trigonometric_functions[0]), DATA_COL);
+        if (scene->sine_fit_visible) {
+            SineFit *fit = &scene->sine_fitter.result;
+            sine_fit_draw(fit, &(scene->trigonometric_functions[0]), FIT_COL);
+            draw_text_centered(
+                font,
+                TEXT_FLAG_NONE,
+                layout.status_label,
+                0,
+                TextFormat("%.3f*sin(%.3fx%+.3f)%+.3f  rms: %.3g", fit->a, fit->b, fit->c, fit->d, fit->rms_residual),
+                FIT_COL
+            );
+        } else if (scene->sine_fitter.running) {
+            draw_text_centered(font, TEXT_FLAG_NONE, layout.status_label, 0, "fitting...", FIT_COL);
+        }
+    }
+
+    spectrum_draw(&scene->spectrum, font);
+    expression_editor_draw(&scene->expression_editor, font);
+
+    draw_text_centered(font, TEXT_FLAG_NONE, layout.deg_label, 0, TextFormat("deg: %.2f", unit_circle->deg), MAIN_COL);
+    draw_text_centered(font, TEXT_FLAG_NONE, layout.rad_label, 0, TextFormat("rad: %.2f", unit_circle->rad), MAIN_COL);
+}
+
+// Lets every panel finish its background work, so an export drawn once
+// shows the final plots.
+void scene_settle(Scene *scene) {
+    for (int i = 0; i < scene->trigonometric_functions_count; i++) {
+        trigonometric_function_settle(&scene->trigonometric_functions[i]);
+    }
+}
+
+bool scene_export_vector(Scene *scene, const char *path, VectorFormat format) {
+    scene_settle(scene);
+    VectorWriter vw;
+    if (!vector_writer_open(&vw, path, format, (Vector2){layout.width,layout.height})) {
+        TraceLog(LOG_WARNING, "EXPORT: Failed to open [%s]", path);
+        return false;
+    }
+    render_begin_vector(&vw);
+    scene_draw(scene);
+    render_end_vector();
+    vector_writer_close(&vw);
+    return true;
+}
@@ -0,0 +1,635 @@
+#include "main.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#define SINE_FIT_FFT_SIZE (1 << 16)
+#define SINE_FIT_MAX_THREADS 64
+#define SINE_FIT_MAX_ITERATIONS 10
+#define SINE_FIT_LANES 8
+#define SINE_FIT_RENORMALIZE_INTERVAL 4096
+
+// Fitted model: a*sin(b*x + c) + d, with x in the dataset's domain units.
+typedef struct SineFit {
+    double a;
+    double b;
+    double c;
+    double d;
+    double rms_residual;
+    double max_residual;
+    int iterations;
+    double seconds;
+    bool valid;
+} SineFit;
+
+typedef enum SineFitPass {
+    SINE_FIT_PASS_LINEAR,
+    SINE_FIT_PASS_GAUSS_NEWTON,
+    SINE_FIT_PASS_RESIDUAL,
+} SineFitPass;
+
+// Parameters are kept in sample-index units, centered on the middle sample
+// so that the frequency column of the Jacobian stays well conditioned.
+typedef struct SineFitParams {
+    double a;
+    double w;
+    double c;
+    double d;
+    double center;
+} SineFitParams;
+
+typedef struct SineFitJob {
+    const float *samples;
+    uint64_t start;
+    uint64_t end;
+    SineFitPass pass;
+    SineFitParams params;
+    double normal[4][4];
+    double rhs[4];
+    double squared_residual;
+    double max_residual;
+} SineFitJob;
+
+// Per-lane sums of one block, so the lanes never add into the same value.
+typedef struct SineFitLanes {
+    double normal[4][4][SINE_FIT_LANES];
+    double rhs[4][SINE_FIT_LANES];
+    double squared_residual[SINE_FIT_LANES];
+    double max_residual[SINE_FIT_LANES];
+} SineFitLanes;
+
+// Workers live for one fit and run their job once per pass.
+typedef struct SineFitPool {
+    SineFitJob *jobs;
+    int job_count;
+    pthread_t threads[SINE_FIT_MAX_THREADS];
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t finish;
+    int generation; // bumped to start a pass
+    int pending; // workers still running the current pass
+    bool quit;
+} SineFitPool;
+
+typedef struct SineFitWorker {
+    SineFitPool *pool;
+    int index;
+} SineFitWorker;
+
+typedef struct SineFitter {
+    Dataset *dataset;
+    SineFit result;
+    pthread_t thread;
+    atomic_bool done;
+    bool running;
+} SineFitter;
+
+// Exact phasors for the lanes at the start of a block.
+static inline void sine_fit_seed(const SineFitParams *p, uint64_t block, double *s, double *c, double *t) {
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        t[l] = (double)(block + l) - p->center;
+        s[l] = sin(p->w * t[l] + p->c);
+        c[l] = cos(p->w * t[l] + p->c);
+    }
+}
+
+static inline void sine_fit_advance(double *s, double *c, double *t, double step_cos, double step_sin) {
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        double next_s = s[l] * step_cos + c[l] * step_sin;
+        c[l] = c[l] * step_cos - s[l] * step_sin;
+        s[l] = next_s;
+        t[l] += SINE_FIT_LANES;
+    }
+}
+
+// Adds the lane sums of a block to the job and clears them.
+static void sine_fit_reduce(SineFitJob *job, SineFitLanes *lanes) {
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        for (int r = 0; r < 4; r++) {
+            for (int k = 0; k < 4; k++) {
+                job->normal[r][k] += lanes->normal[r][k][l];
+            }
+            job->rhs[r] += lanes->rhs[r][l];
+        }
+        job->squared_residual += lanes->squared_residual[l];
+        job->max_residual = fmax(job->max_residual, lanes->max_residual[l]);
+    }
+    memset(lanes, 0, sizeof(*lanes));
+}
+
+// Run with c = 0: for a fixed frequency the model is linear in (a*cos c, a*sin c, d).
+static inline void sine_fit_lane_linear(SineFitLanes *lanes, int l, double y, double s, double c) {
+    double j[3] = { s, c, 1 };
+    for (int r = 0; r < 3; r++) {
+        for (int k = 0; k < 3; k++) {
+            lanes->normal[r][k][l] += j[r] * j[k];
+        }
+        lanes->rhs[r][l] += j[r] * y;
+    }
+}
+
+// Only the upper triangle of the normal matrix is summed.
+static inline void sine_fit_lane_gauss_newton(SineFitLanes *lanes, int l, const SineFitParams *p, double y, double s, double c, double t) {
+    double residual = y - (p->a * s + p->d);
+    double j[4] = { s, p->a * t * c, p->a * c, 1 };
+    for (int r = 0; r < 4; r++) {
+        for (int k = r; k < 4; k++) {
+            lanes->normal[r][k][l] += j[r] * j[k];
+        }
+        lanes->rhs[r][l] += j[r] * residual;
+    }
+    lanes->squared_residual[l] += residual * residual;
+}
+
+static inline void sine_fit_lane_residual(SineFitLanes *lanes, int l, const SineFitParams *p, double y, double s) {
+    double residual = fabs(y - (p->a * s + p->d));
+    lanes->squared_residual[l] += residual * residual;
+    lanes->max_residual[l] = fmax(lanes->max_residual[l], residual);
+}
+
+#ifdef __SSE2__
+// Two lanes of SineFitLanes as one vector.
+static inline __m128d sine_fit_load_samples(const float *y) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)y)));
+}
+
+static inline void sine_fit_add(double *sum, __m128d value) {
+    _mm_storeu_pd(sum, _mm_add_pd(_mm_loadu_pd(sum), value));
+}
+#endif
+
+// One sample per lane, SINE_FIT_LANES consecutive samples from y.
+static inline void sine_fit_group_linear(SineFitLanes *lanes, const float *y, const double *s, const double *c) {
+#ifdef __SSE2__
+    for (int l = 0; l < SINE_FIT_LANES; l += 2) {
+        __m128d ys = sine_fit_load_samples(y + l);
+        __m128d j[3] = { _mm_loadu_pd(s + l), _mm_loadu_pd(c + l), _mm_set1_pd(1) };
+        for (int r = 0; r < 3; r++) {
+            for (int k = 0; k < 3; k++) {
+                sine_fit_add(&lanes->normal[r][k][l], _mm_mul_pd(j[r], j[k]));
+            }
+            sine_fit_add(&lanes->rhs[r][l], _mm_mul_pd(j[r], ys));
+        }
+    }
+#else
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        sine_fit_lane_linear(lanes, l, y[l], s[l], c[l]);
+    }
+#endif
+}
+
+static inline void sine_fit_group_gauss_newton(SineFitLanes *lanes, const SineFitParams *p, const float *y, const double *s, const double *c, const double *t) {
+#ifdef __SSE2__
+    __m128d a = _mm_set1_pd(p->a);
+    __m128d d = _mm_set1_pd(p->d);
+    for (int l = 0; l < SINE_FIT_LANES; l += 2) {
+        __m128d sv = _mm_loadu_pd(s + l);
+        __m128d ac = _mm_mul_pd(a, _mm_loadu_pd(c + l));
+        __m128d residual = _mm_sub_pd(sine_fit_load_samples(y + l), _mm_add_pd(_mm_mul_pd(a, sv), d));
+        __m128d j[4] = { sv, _mm_mul_pd(ac, _mm_loadu_pd(t + l)), ac, _mm_set1_pd(1) };
+        for (int r = 0; r < 4; r++) {
+            for (int k = r; k < 4; k++) {
+                sine_fit_add(&lanes->normal[r][k][l], _mm_mul_pd(j[r], j[k]));
+            }
+            sine_fit_add(&lanes->rhs[r][l], _mm_mul_pd(j[r], residual));
+        }
+        sine_fit_add(&lanes->squared_residual[l], _mm_mul_pd(residual, residual));
+    }
+#else
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        sine_fit_lane_gauss_newton(lanes, l, p, y[l], s[l], c[l], t[l]);
+    }
+#endif
+}
+
+static inline void sine_fit_group_residual(SineFitLanes *lanes, const SineFitParams *p, const float *y, const double *s) {
+#ifdef __SSE2__
+    __m128d a = _mm_set1_pd(p->a);
+    __m128d d = _mm_set1_pd(p->d);
+    __m128d sign = _mm_set1_pd(-0.0);
+    for (int l = 0; l < SINE_FIT_LANES; l += 2) {
+        __m128d difference = _mm_sub_pd(sine_fit_load_samples(y + l), _mm_add_pd(_mm_mul_pd(a, _mm_loadu_pd(s + l)), d));
+        __m128d residual = _mm_andnot_pd(sign, difference);
+        sine_fit_add(&lanes->squared_residual[l], _mm_mul_pd(residual, residual));
+        _mm_storeu_pd(&lanes->max_residual[l], _mm_max_pd(_mm_loadu_pd(&lanes->max_residual[l]), residual));
+    }
+#else
+    for (int l = 0; l < SINE_FIT_LANES; l++) {
+        sine_fit_lane_residual(lanes, l, p, y[l], s[l]);
+    }
+#endif
+}
+
+// Walks the samples of one job with SINE_FIT_LANES interleaved phasors advanced
+// by complex rotation, so the inner loop has no libm calls. Each pass has its
+// own loop and every lane its own sums, reduced once per block; the phasors
+// are recomputed exactly at each block, every SINE_FIT_RENORMALIZE_INTERVAL
+// samples, to bound the drift of the recurrence.
+static void sine_fit_job_run(SineFitJob *job) {
+    const SineFitParams p = job->params;
+    const float *y = job->samples;
+    const double step_cos = cos(p.w * SINE_FIT_LANES);
+    const double step_sin = sin(p.w * SINE_FIT_LANES);
+    memset(job->normal, 0, sizeof(job->normal));
+    memset(job->rhs, 0, sizeof(job->rhs));
+    job->squared_residual = 0;
+    job->max_residual = 0;
+    SineFitLanes lanes = {0};
+    double s[SINE_FIT_LANES], c[SINE_FIT_LANES], t[SINE_FIT_LANES];
+
+    for (uint64_t block = job->start; block < job->end; block += SINE_FIT_RENORMALIZE_INTERVAL) {
+        uint64_t block_end = block + SINE_FIT_RENORMALIZE_INTERVAL;
+        if (block_end > job->end) {
+            block_end = job->end;
+        }
+        sine_fit_seed(&p, block, s, c, t);
+        uint64_t i = block;
+        switch (job->pass) {
+        case SINE_FIT_PASS_LINEAR:
+            for (; i + SINE_FIT_LANES <= block_end; i += SINE_FIT_LANES) {
+                sine_fit_group_linear(&lanes, y + i, s, c);
+                sine_fit_advance(s, c, t, step_cos, step_sin);
+            }
+            for (int l = 0; i + l < block_end; l++) {
+                sine_fit_lane_linear(&lanes, l, y[i + l], s[l], c[l]);
+            }
+            break;
+        case SINE_FIT_PASS_GAUSS_NEWTON:
+            for (; i + SINE_FIT_LANES <= block_end; i += SINE_FIT_LANES) {
+                sine_fit_group_gauss_newton(&lanes, &p, y + i, s, c, t);
+                sine_fit_advance(s, c, t, step_cos, step_sin);
+            }
+            for (int l = 0; i + l < block_end; l++) {
+                sine_fit_lane_gauss_newton(&lanes, l, &p, y[i + l], s[l], c[l], t[l]);
+            }
+            break;
+        case SINE_FIT_PASS_RESIDUAL:
+            for (; i + SINE_FIT_LANES <= block_end; i += SINE_FIT_LANES) {
+                sine_fit_group_residual(&lanes, &p, y + i, s);
+                sine_fit_advance(s, c, t, step_cos, step_sin);
+            }
+            for (int l = 0; i + l < block_end; l++) {
+                sine_fit_lane_residual(&lanes, l, &p, y[i + l], s[l]);
+            }
+            break;
+        }
+        sine_fit_reduce(job, &lanes);
+    }
+}
+
+static void *sine_fit_worker_run(void *arg) {
+    SineFitWorker *worker = arg;
+    SineFitPool *pool = worker->pool;
+    int seen = 0;
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->quit && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->mutex);
+        }
+        if (pool->quit) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        sine_fit_job_run(&pool->jobs[worker->index]);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->finish);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+// Job 0 runs on the calling thread, the others on workers started here once.
+static void sine_fit_pool_init(SineFitPool *pool, SineFitWorker *workers, SineFitJob *jobs, int job_count) {
+    *pool = (SineFitPool){ .jobs = jobs, .job_count = job_count };
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->finish, NULL);
+    for (int i = 1; i < job_count; i++) {
+        workers[i] = (SineFitWorker){ pool, i };
+        if (pthread_create(&pool->threads[i], NULL, sine_fit_worker_run, &workers[i]) != 0) {
+            // Whatever did not get a worker runs on the calling thread.
+            pool->job_count = i;
+            break;
+        }
+    }
+}
+
+static void sine_fit_pool_deinit(SineFitPool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+    for (int i = 1; i < pool->job_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->finish);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->mutex);
+}
+
+// Runs every job with the same pass and parameters, summed into jobs[0].
+static void sine_fit_run_pass(SineFitPool *pool, int job_count, SineFitPass pass, SineFitParams params) {
+    SineFitJob *jobs = pool->jobs;
+    for (int i = 0; i < job_count; i++) {
+        jobs[i].pass = pass;
+        jobs[i].params = params;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    pool->pending = pool->job_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    sine_fit_job_run(&jobs[0]);
+    for (int i = pool->job_count; i < job_count; i++) {
+        sine_fit_job_run(&jobs[i]);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->finish, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    for (int i = 1; i < job_count; i++) {
+        for (int r = 0; r < 4; r++) {
+            for (int k = 0; k < 4; k++) {
+                jobs[0].normal[r][k] += jobs[i].normal[r][k];
+            }
+            jobs[0].rhs[r] += jobs[i].rhs[r];
+        }
+        jobs[0].squared_residual += jobs[i].squared_residual;
+        if (jobs[i].max_residual > jobs[0].max_residual) {
+            jobs[0].max_residual = jobs[i].max_residual;
+        }
+    }
+}
+
+// Gaussian elimination with partial pivoting, solves m*x = rhs in place.
+static bool sine_fit_solve(double m[4][4], double *rhs, int n) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < n; r++) {
+            if (fabs(m[r][col]) > fabs(m[pivot][col])) {
+                pivot = r;
+            }
+        }
+        if (fabs(m[pivot][col]) < 1e-300) {
+            return false;
+        }
+        for (int k = 0; k < n; k++) {
+            double t = m[col][k]; m[col][k] = m[pivot][k]; m[pivot][k] = t;
+        }
+        double t = rhs[col]; rhs[col] = rhs[pivot]; rhs[pivot] = t;
+        for (int r = col + 1; r < n; r++) {
+            double factor = m[r][col] / m[col][col];
+            for (int k = col; k < n; k++) {
+                m[r][k] -= factor * m[col][k];
+            }
+            rhs[r] -= factor * rhs[col];
+        }
+    }
+    for (int r = n - 1; r >= 0; r--) {
+        for (int k = r + 1; k < n; k++) {
+            rhs[r] -= m[r][k] * rhs[k];
+        }
+        rhs[r] /= m[r][r];
+    }
+    return true;
+}
+
+// Peak of the Hann-windowed spectrum of n blocks of stride samples from
+// first, in radians per sample, with parabolic interpolation of the peak bin.
+// Each block is averaged rather than point sampled, so noise above the
+// decimated band does not fold back onto the peak.
+static double sine_fit_spectrum_peak(const float *samples, uint64_t first, int n, uint64_t stride, float *re, float *im) {
+    double mean = 0;
+    for (int i = 0; i < n; i++) {
+        const float *block = samples + first + (uint64_t)i * stride;
+        double sum = 0;
+        for (uint64_t k = 0; k < stride; k++) {
+            sum += block[k];
+        }
+        re[i] = (float)(sum / (double)stride);
+        mean += re[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; i++) {
+        float window = 0.5f - 0.5f * cosf(2 * PI * i / (n - 1));
+        re[i] = (float)(re[i] - mean) * window;
+        im[i] = 0;
+    }
+    fft_forward(re, im, n);
+    fft_magnitudes(re, im, n);
+    int peak = 1;
+    for (int i = 2; i < n/2; i++) {
+        if (re[i] > re[peak]) {
+            peak = i;
+        }
+    }
+    double offset = 0;
+    if (peak > 1 && peak < n/2 - 1) {
+        double l = logf(re[peak-1] + 1e-30f);
+        double m = logf(re[peak] + 1e-30f);
+        double r = logf(re[peak+1] + 1e-30f);
+        double denominator = l - 2*m + r;
+        if (denominator != 0) {
+            offset = 0.5 * (l - r) / denominator;
+        }
+    }
+    return 2 * TRIG_PI * (peak + offset) / ((double)n * (double)stride);
+}
+
+// Phase of the tone at w radians per sample in the middle of length samples
+// from first, up to a constant shared by every call with the same w.
+static double sine_fit_phase(const float *samples, uint64_t first, int length, double w) {
+    const double step_cos = cos(w);
+    const double step_sin = sin(w);
+    double c = cos(w * (length - 1) / 2);
+    double s = sin(w * (length - 1) / 2);
+    double re = 0, im = 0;
+    for (int t = 0; t < length; t++) {
+        double y = samples[first + (uint64_t)t];
+        re += y * c;
+        im += y * s;
+        double next_c = c * step_cos + s * step_sin;
+        s = s * step_cos - c * step_sin;
+        c = next_c;
+    }
+    return atan2(im, re);
+}
+
+// Estimates the dominant frequency in radians per sample, NaN without memory.
+//
+// The spectrum of the whole dataset decimated to SINE_FIT_FFT_SIZE blocks is
+// fine but cannot tell a tone above its band from the alias it folds onto.
+// One chunk at the full rate can, but only to a bin of 1/SINE_FIT_FFT_SIZE.
+// A tone the chunk places in the upper half of the decimated band or above
+// is taken from the chunk instead, then pinned down from the phase it gains
+// between two chunks. The chunks move apart by 4x at a time, which keeps
+// the phase error under half a turn, until they span the dataset.
+static double sine_fit_estimate_frequency(const float *samples, uint64_t count) {
+    int n = SINE_FIT_FFT_SIZE;
+    while ((uint64_t)n > count && n > 8) {
+        n >>= 1;
+    }
+    uint64_t stride = count / (uint64_t)n;
+    float *re = malloc(sizeof(float) * n * 2);
+    if (re == NULL) {
+        return NAN;
+    }
+    float *im = re + n;
+    double w = sine_fit_spectrum_peak(samples, 0, n, stride, re, im);
+    if (stride > 1) {
+        double chunk = sine_fit_spectrum_peak(samples, (count - (uint64_t)n) / 2, n, 1, re, im);
+        if (chunk > TRIG_PI / (2 * (double)stride) && chunk > 4 * 2 * TRIG_PI / n) {
+            w = chunk;
+            uint64_t span = count - (uint64_t)n;
+            for (uint64_t distance = (uint64_t)n; distance < span; ) {
+                distance = (distance * 4 < span) ? distance * 4 : span;
+                uint64_t first = (span - distance) / 2;
+                double gained = sine_fit_phase(samples, first + distance, n, w) - sine_fit_phase(samples, first, n, w);
+                w += remainder(gained - w * (double)distance, 2 * TRIG_PI) / (double)distance;
+            }
+        }
+    }
+    free(re);
+    return w;
+}
+
+SineFit sine_fit_dataset(Dataset *ds) {
+    SineFit fit = {0};
+    double start_time = platform_time_seconds();
+    if (ds->count < 16) {
+        return fit;
+    }
+
+    int job_count = platform_cpu_count();
+    if (job_count > SINE_FIT_MAX_THREADS) {
+        job_count = SINE_FIT_MAX_THREADS;
+    }
+    SineFitJob jobs[SINE_FIT_MAX_THREADS];
+    for (int i = 0; i < job_count; i++) {
+        jobs[i].samples = ds->samples;
+        jobs[i].start = ds->count * i / job_count;
+        jobs[i].end = ds->count * (i + 1) / job_count;
+    }
+
+    SineFitParams p = {
+        .w = sine_fit_estimate_frequency(ds->samples, ds->count),
+        .center = (double)(ds->count / 2),
+    };
+    if (isnan(p.w)) {
+        return fit;
+    }
+
+    SineFitPool pool;
+    SineFitWorker workers[SINE_FIT_MAX_THREADS];
+    sine_fit_pool_init(&pool, workers, jobs, job_count);
+    sine_fit_run_pass(&pool, job_count, SINE_FIT_PASS_LINEAR, p);
+    if (!sine_fit_solve(jobs[0].normal, jobs[0].rhs, 3)) {
+        sine_fit_pool_deinit(&pool);
+        return fit;
+    }
+    // p*sin(u) + q*cos(u) = a*sin(u + c)
+    p.a = sqrt(jobs[0].rhs[0]*jobs[0].rhs[0] + jobs[0].rhs[1]*jobs[0].rhs[1]);
+    p.c = atan2(jobs[0].rhs[1], jobs[0].rhs[0]);
+    p.d = jobs[0].rhs[2];
+
+    for (fit.iterations = 0; fit.iterations < SINE_FIT_MAX_ITERATIONS; fit.iterations++) {
+        sine_fit_run_pass(&pool, job_count, SINE_FIT_PASS_GAUSS_NEWTON, p);
+        for (int r = 0; r < 4; r++) {
+            for (int k = 0; k < r; k++) {
+                jobs[0].normal[r][k] = jobs[0].normal[k][r];
+            }
+        }
+        if (!sine_fit_solve(jobs[0].normal, jobs[0].rhs, 4)) {
+            break;
+        }
+        p.a += jobs[0].rhs[0];
+        p.w += jobs[0].rhs[1];
+        p.c += jobs[0].rhs[2];
+        p.d += jobs[0].rhs[3];
+        if (fabs(jobs[0].rhs[1]) * (double)ds->count < 1e-9 && fabs(jobs[0].rhs[2]) < 1e-9) {
+            fit.iterations++;
+            break;
+        }
+    }
+
+    sine_fit_run_pass(&pool, job_count, SINE_FIT_PASS_RESIDUAL, p);
+    sine_fit_pool_deinit(&pool);
+
+    if (p.a < 0) {
+        p.a = -p.a;
+        p.c += TRIG_PI;
+    }
+    // x = i*x_step, so a*sin(w*(i - center) + c) = a*sin((w/x_step)*x + c - w*center)
+    fit.a = p.a;
+    fit.b = p.w / ds->x_step;
+    fit.c = remainder(p.c - p.w * p.center, 2 * TRIG_PI);
+    fit.d = p.d;
+    fit.rms_residual = sqrt(jobs[0].squared_residual / (double)ds->count);
+    fit.max_residual = jobs[0].max_residual;
+    fit.seconds = platform_time_seconds() - start_time;
+    fit.valid = isfinite(fit.a) && isfinite(fit.b) && isfinite(fit.c) && isfinite(fit.d);
+    return fit;
+}
+
+static void *sine_fitter_run(void *arg) {
+    SineFitter *fitter = arg;
+    fitter->result = sine_fit_dataset(fitter->dataset);
+    atomic_store_explicit(&fitter->done, true, memory_order_release);
+    return NULL;
+}
+
+void sine_fitter_start(SineFitter *fitter, Dataset *ds) {
+    if (fitter->running) {
+        return;
+    }
+    fitter->dataset = ds;
+    atomic_init(&fitter->done, false);
+    fitter->running = pthread_create(&fitter->thread, NULL, sine_fitter_run, fitter) == 0;
+}
+
+// Returns true once, on the frame the background fit finishes.
+bool sine_fitter_poll(SineFitter *fitter) {
+    if (!fitter->running || !atomic_load_explicit(&fitter->done, memory_order_acquire)) {
+        return false;
+    }
+    pthread_join(fitter->thread, NULL);
+    fitter->running = false;
+    SineFit *f = &fitter->result;
+    TraceLog(
+        LOG_INFO,
+        "SINE_FIT: a=%g b=%g c=%g d=%g rms=%g max=%g iterations=%d time=%.3fs",
+        f->a, f->b, f->c, f->d, f->rms_residual, f->max_residual, f->iterations, f->seconds
+    );
+    return true;
+}
+
+void sine_fit_draw(SineFit *fit, TrigonometricFunction *tf, Color color) {
+    const int segments = (int)tf->size.x / 2;
+    float top = tf->position.y;
+    float bottom = tf->position.y + tf->size.y;
+    Vector2 prev = {0};
+    for (int j = 0; j <= segments; j++) {
+        double x = tf->domain.min + (tf->domain.max - tf->domain.min) * j / segments;
+        float y = trigonometric_function_value_to_y(tf, (float)(fit->a * sin(fit->b * x + fit->c) + fit->d));
+        Vector2 next = {
+            tf->position.x + tf->size.x * j / segments,
+            (y < top) ? top : ((y > bottom) ? bottom : y),
+        };
+        if (j > 0) {
+            render_line(prev, next, LINE_SMALL * 2, color);
+        }
+        prev = next;
+    }
+}
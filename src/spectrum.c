@@ -0,0 +1,216 @@
+#include "main.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPECTRUM_SIZE 4096
+#define SPECTRUM_BINS (SPECTRUM_SIZE/2 + 1)
+#define SPECTRUM_FLOOR_DB -100.0f
+
+// What the spectrum was computed from. A new request is only posted to the
+// worker when this changes, and the worker always skips to the newest one.
+// The expression is copied so an edit on the main thread never frees the
+// code the worker is running.
+typedef struct SpectrumSource {
+    float (*function)(float);
+    void (*evaluate_batch)(const float *x, float *out, int count);
+    Expression expression;
+    Dataset *dataset;
+    Domain domain;
+    PartialSumSeries partial_sum_series; // copied like the expression
+    float partial_sum_point;
+    int partial_sum_terms; // 0 unless the panel plots a partial sum
+} SpectrumSource;
+
+typedef struct SpectrumPanel {
+    TrigonometricFunction *source_panel;
+    Dataset *dataset;
+    Vector2 position;
+    Vector2 size;
+    SpectrumSource requested;
+    SpectrumSource computing;
+    SpectrumSource pending;
+    uint64_t request_generation;
+    uint64_t result_generation;
+    float magnitudes[SPECTRUM_BINS];
+    float peak_db;
+    float work_x[SPECTRUM_SIZE];
+    float work_re[SPECTRUM_SIZE];
+    float work_im[SPECTRUM_SIZE];
+    float work_db[SPECTRUM_BINS];
+    pthread_t worker;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool quit;
+} SpectrumPanel;
+
+static inline bool spectrum_source_equals(const SpectrumSource *a, const SpectrumSource *b) {
+    return (
+        a->function == b->function &&
+        a->evaluate_batch == b->evaluate_batch &&
+        strcmp(a->expression.source, b->expression.source) == 0 &&
+        a->dataset == b->dataset &&
+        a->domain.min == b->domain.min &&
+        a->domain.max == b->domain.max &&
+        a->partial_sum_series == b->partial_sum_series &&
+        a->partial_sum_point == b->partial_sum_point &&
+        a->partial_sum_terms == b->partial_sum_terms
+    );
+}
+
+static void spectrum_compute(SpectrumPanel *sp, SpectrumSource *source) {
+    double step = (source->domain.max - source->domain.min) / SPECTRUM_SIZE;
+    for (int i = 0; i < SPECTRUM_SIZE; i++) {
+        sp->work_x[i] = (float)(source->domain.min + step * i);
+    }
+    if (source->dataset == NULL && source->partial_sum_terms > 0) {
+        for (int i = 0; i < SPECTRUM_SIZE; i++) {
+            sp->work_re[i] = partial_sum_evaluate_terms(source->partial_sum_series, source->partial_sum_point, source->partial_sum_terms, sp->work_x[i]);
+        }
+    } else if (source->dataset == NULL && source->expression.source[0] != '\0') {
+        expression_evaluate_batch(&source->expression, sp->work_x, sp->work_re, SPECTRUM_SIZE);
+    } else if (source->dataset == NULL && source->evaluate_batch != NULL) {
+        source->evaluate_batch(sp->work_x, sp->work_re, SPECTRUM_SIZE);
+    } else if (source->dataset == NULL) {
+        trig_evaluate_batch(source->function, sp->work_x, sp->work_re, SPECTRUM_SIZE);
+    }
+    for (int i = 0; i < SPECTRUM_SIZE; i++) {
+        float value = sp->work_re[i];
+        if (source->dataset != NULL) {
+            double index = (source->domain.min + step * i) / source->dataset->x_step;
+            value = (index >= 0 && index < (double)source->dataset->count) ? source->dataset->samples[(uint64_t)index] : 0;
+        } else if (!isfinite(value)) {
+            value = 0;
+        }
+        float window = 0.5f - 0.5f * cosf(2 * PI * i / (SPECTRUM_SIZE - 1));
+        sp->work_re[i] = value * window;
+        sp->work_im[i] = 0;
+    }
+    fft_forward(sp->work_re, sp->work_im, SPECTRUM_SIZE);
+    fft_magnitudes(sp->work_re, sp->work_im, SPECTRUM_SIZE);
+    for (int i = 0; i < SPECTRUM_BINS; i++) {
+        float db = 20 * log10f(sp->work_re[i] / (SPECTRUM_SIZE/4) + 1e-12f);
+        sp->work_db[i] = (db < SPECTRUM_FLOOR_DB) ? SPECTRUM_FLOOR_DB : db;
+    }
+}
+
+static void *spectrum_worker(void *arg) {
+    SpectrumPanel *sp = arg;
+    pthread_mutex_lock(&sp->mutex);
+    while (true) {
+        while (!sp->quit && sp->result_generation == sp->request_generation) {
+            pthread_cond_wait(&sp->cond, &sp->mutex);
+        }
+        if (sp->quit) {
+            break;
+        }
+        uint64_t generation = sp->request_generation;
+        sp->computing = sp->requested;
+        pthread_mutex_unlock(&sp->mutex);
+
+        spectrum_compute(sp, &sp->computing);
+
+        pthread_mutex_lock(&sp->mutex);
+        memcpy(sp->magnitudes, sp->work_db, sizeof(sp->magnitudes));
+        sp->peak_db = SPECTRUM_FLOOR_DB;
+        for (int i = 1; i < SPECTRUM_BINS; i++) {
+            if (sp->magnitudes[i] > sp->peak_db) {
+                sp->peak_db = sp->magnitudes[i];
+            }
+        }
+        sp->result_generation = generation;
+    }
+    pthread_mutex_unlock(&sp->mutex);
+    return NULL;
+}
+
+void spectrum_init(SpectrumPanel *sp) {
+    memset(sp, 0, sizeof(*sp));
+    for (int i = 0; i < SPECTRUM_BINS; i++) {
+        sp->magnitudes[i] = SPECTRUM_FLOOR_DB;
+    }
+    pthread_mutex_init(&sp->mutex, NULL);
+    pthread_cond_init(&sp->cond, NULL);
+    pthread_create(&sp->worker, NULL, spectrum_worker, sp);
+}
+
+void spectrum_deinit(SpectrumPanel *sp) {
+    pthread_mutex_lock(&sp->mutex);
+    sp->quit = true;
+    pthread_cond_signal(&sp->cond);
+    pthread_mutex_unlock(&sp->mutex);
+    pthread_join(sp->worker, NULL);
+    pthread_cond_destroy(&sp->cond);
+    pthread_mutex_destroy(&sp->mutex);
+}
+
+void spectrum_set_source(SpectrumPanel *sp, TrigonometricFunction *tf, Dataset *ds) {
+    sp->source_panel = tf;
+    sp->dataset = ds;
+}
+
+// Called once per frame, posts a request only when the source panel changed.
+void spectrum_update(SpectrumPanel *sp) {
+    if (sp->source_panel == NULL) {
+        return;
+    }
+    SpectrumSource *source = &sp->pending;
+    *source = (SpectrumSource) {
+        .function = sp->source_panel->function,
+        .evaluate_batch = sp->source_panel->evaluate_batch,
+        .dataset = sp->dataset,
+        .domain = sp->source_panel->domain,
+    };
+    if (sp->source_panel->expression != NULL) {
+        source->expression = *sp->source_panel->expression;
+    }
+    if (sp->source_panel->partial_sum != NULL) {
+        source->partial_sum_series = sp->source_panel->partial_sum->series;
+        source->partial_sum_point = sp->source_panel->partial_sum->point;
+        source->partial_sum_terms = sp->source_panel->partial_sum->terms;
+    }
+    pthread_mutex_lock(&sp->mutex);
+    if (sp->request_generation == 0 || !spectrum_source_equals(source, &sp->requested)) {
+        sp->requested = *source;
+        sp->request_generation++;
+        pthread_cond_signal(&sp->cond);
+    }
+    pthread_mutex_unlock(&sp->mutex);
+}
+
+void spectrum_draw(SpectrumPanel *sp, Font *font) {
+    if (sp->source_panel == NULL) {
+        return;
+    }
+    TrigonometricFunction *tf = sp->source_panel;
+    render_rectangle_lines((Rectangle){sp->position.x, sp->position.y, sp->size.x, sp->size.y}, LINE_SMALL, MAIN_COL);
+
+    pthread_mutex_lock(&sp->mutex);
+    float top_db = sp->peak_db;
+    float bottom_db = top_db + SPECTRUM_FLOOR_DB;
+    int columns = (int)sp->size.x;
+    for (int c = 0; c < columns; c++) {
+        // Each column shows the loudest bin it covers, so narrow peaks survive decimation.
+        int first = 1 + (SPECTRUM_BINS - 1) * c / columns;
+        int last = 1 + (SPECTRUM_BINS - 1) * (c + 1) / columns;
+        float db = SPECTRUM_FLOOR_DB;
+        for (int i = first; i < last && i < SPECTRUM_BINS; i++) {
+            if (sp->magnitudes[i] > db) {
+                db = sp->magnitudes[i];
+            }
+        }
+        float fraction = (db - bottom_db) / (top_db - bottom_db);
+        if (fraction <= 0) {
+            continue;
+        }
+        float x = sp->position.x + c + 0.5f;
+        float bottom = sp->position.y + sp->size.y;
+        render_line((Vector2){x, bottom}, (Vector2){x, bottom - fraction * sp->size.y}, LINE_SMALL, sp->dataset ? DATA_COL : tf->color);
+    }
+    pthread_mutex_unlock(&sp->mutex);
+
+    double nyquist = SPECTRUM_SIZE / 2 / (tf->domain.max - tf->domain.min);
+    draw_text_centered(font, TEXT_FLAG_NONE, (Vector2){sp->position.x, sp->position.y + sp->size.y + layout.small_label_offset}, 0, "0", MAIN_COL);
+    draw_text_centered(font, TEXT_FLAG_NONE, (Vector2){sp->position.x + sp->size.x, sp->position.y + sp->size.y + layout.small_label_offset}, 0, TextFormat("%.4g", nyquist), MAIN_COL);
+    draw_text_centered(font, TEXT_FLAG_NONE, (Vector2){sp->position.x + sp->size.x/2, sp->position.y - layout.small_label_offset}, 0, TextFormat("|fft(%s)|", tf->name), tf->color);
+}
@@ -0,0 +1,302 @@
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+// Many angles on the unit circle at once. The points are kept as a structure
+// of arrays (phase, speed, angle, sin, cos) so the per-frame update runs four
+// lanes at a time and feeds the batch trig kernels directly. Every point sits
+// at the unit circle's angle plus its own phase, which advances at its own
+// speed: a sweep starts all phases together with speeds rising across the
+// swarm, so it fans out into spirals, particles start scattered with random
+// speeds. Drawing bins the points per pixel of the circumference and per
+// column of each panel, so 100k points cost a few thousand lines.
+
+#define SWARM_DEFAULT_COUNT 100000
+#define SWARM_MIN_COUNT 10
+#define SWARM_MAX_COUNT 1000000
+#define SWARM_SWEEP_SPEED (PI*2) // rad/s of the fastest point of a sweep
+#define SWARM_PARTICLE_SPEED 1.0f // rad/s, both ways
+#define SWARM_MAX_DT 0.1f // keeps a stalled frame from wrapping a phase more than once
+#define SWARM_CIRCLE_BIN_PIXELS 2
+#define SWARM_CIRCLE_MAX_BINS 4096
+#define SWARM_AXIS_MAX_BINS 2048
+#define SWARM_CHUNK 1024
+#define SWARM_LINE 3
+
+typedef enum SwarmMode {
+    SWARM_OFF,
+    SWARM_SWEEP,
+    SWARM_PARTICLES,
+    SWARM_MODE_COUNT,
+} SwarmMode;
+
+typedef struct Swarm {
+    SwarmMode mode;
+    int count;
+    float *phase; // all five arrays share one allocation of 5*count floats
+    float *speed;
+    float *rad; // unit circle angle + phase, in [0, 2pi)
+    float *sin;
+    float *cos;
+    int circle_bins[SWARM_CIRCLE_MAX_BINS];
+    int axis_bins[2][SWARM_AXIS_MAX_BINS]; // sin along the vertical diameter, cos along the horizontal one
+    int column_count[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS];
+    float column_top[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS];
+    float column_bottom[TRIGONOMETRIC_FUNCTION_MAX_COLUMNS];
+} Swarm;
+
+static const char *const swarm_mode_names[SWARM_MODE_COUNT] = { "off", "sweep", "particles" };
+
+void swarm_free(Swarm *sw) {
+    free(sw->phase);
+    *sw = (Swarm){0};
+}
+
+// Restarts the swarm with count points in the given mode.
+void swarm_set(Swarm *sw, SwarmMode mode, int count) {
+    count = (count < SWARM_MIN_COUNT) ? SWARM_MIN_COUNT : (count > SWARM_MAX_COUNT) ? SWARM_MAX_COUNT : count;
+    if (mode == SWARM_OFF) {
+        swarm_free(sw);
+        return;
+    }
+    if (count != sw->count || sw->phase == NULL) {
+        free(sw->phase);
+        sw->phase = malloc(sizeof(float) * 5 * (size_t)count);
+        sw->speed = sw->phase + count;
+        sw->rad = sw->speed + count;
+        sw->sin = sw->rad + count;
+        sw->cos = sw->sin + count;
+    }
+    sw->mode = mode;
+    sw->count = count;
+    uint32_t state = 12345;
+    for (int i = 0; i < count; i++) {
+        if (mode == SWARM_SWEEP) {
+            sw->phase[i] = 0;
+            sw->speed[i] = (float)(SWARM_SWEEP_SPEED * i / count);
+        } else {
+            state = state * 1664525u + 1013904223u;
+            sw->phase[i] = (float)((state >> 8) / 16777216.0 * PI*2);
+            state = state * 1664525u + 1013904223u;
+            sw->speed[i] = (float)(((state >> 8) / 16777216.0 * 2 - 1) * SWARM_PARTICLE_SPEED);
+        }
+    }
+}
+
+// Next mode, keeping the point count (or starting at the default).
+void swarm_cycle(Swarm *sw) {
+    SwarmMode mode = (SwarmMode)((sw->mode + 1) % SWARM_MODE_COUNT);
+    swarm_set(sw, mode, (sw->count > 0) ? sw->count : SWARM_DEFAULT_COUNT);
+}
+
+void swarm_scale_count(Swarm *sw, float factor) {
+    if (sw->mode != SWARM_OFF) {
+        swarm_set(sw, sw->mode, (int)(sw->count * factor));
+    }
+}
+
+// Advances every phase by dt and places the points around base, the unit
+// circle's angle in [0, 2pi]. Phases and angles are wrapped with masks.
+void swarm_update(Swarm *sw, float base, float dt) {
+    if (sw->mode == SWARM_OFF) {
+        return;
+    }
+    const float turn = PI*2;
+    dt = (dt > SWARM_MAX_DT) ? SWARM_MAX_DT : dt;
+    int i = 0;
+#ifdef __SSE__
+    const __m128 dt4 = _mm_set1_ps(dt);
+    const __m128 turn4 = _mm_set1_ps(turn);
+    const __m128 base4 = _mm_set1_ps(base);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= sw->count; i += 4) {
+        __m128 p = _mm_add_ps(_mm_loadu_ps(sw->phase + i), _mm_mul_ps(_mm_loadu_ps(sw->speed + i), dt4));
+        p = _mm_add_ps(p, _mm_and_ps(_mm_cmplt_ps(p, zero), turn4));
+        p = _mm_sub_ps(p, _mm_and_ps(_mm_cmpge_ps(p, turn4), turn4));
+        _mm_storeu_ps(sw->phase + i, p);
+        __m128 r = _mm_add_ps(p, base4);
+        _mm_storeu_ps(sw->rad + i, _mm_sub_ps(r, _mm_and_ps(_mm_cmpge_ps(r, turn4), turn4)));
+    }
+#endif
+    for (; i < sw->count; i++) {
+        float p = sw->phase[i] + sw->speed[i] * dt;
+        p += (p < 0) ? turn : 0;
+        p -= (p >= turn) ? turn : 0;
+        sw->phase[i] = p;
+        float r = p + base;
+        sw->rad[i] = r - ((r >= turn) ? turn : 0);
+    }
+    trig_evaluate_batch_kind(TRIG_SIN, sw->rad, sw->sin, sw->count);
+    trig_evaluate_batch_kind(TRIG_COS, sw->rad, sw->cos, sw->count);
+}
+
+static inline Color swarm_density_color(int count, int max_count) {
+    float density = logf(1 + count) / logf(1 + max_count);
+    return ColorAlpha(SWARM_COL, 0.2f + 0.8f * density);
+}
+
+// Ticks across one diameter where the swarm's sin (axis 0) or cos (axis 1) lands.
+static void swarm_draw_axis(Swarm *sw, UnitCircle *uc, int axis) {
+    int bins = (int)(uc->radius * 2 / SWARM_CIRCLE_BIN_PIXELS);
+    bins = (bins < 16) ? 16 : (bins > SWARM_AXIS_MAX_BINS) ? SWARM_AXIS_MAX_BINS : bins;
+    int *counts = sw->axis_bins[axis];
+    const float *values = (axis == 0) ? sw->sin : sw->cos;
+    memset(counts, 0, sizeof(int) * bins);
+    const float scale = bins / 2.0f;
+    for (int i = 0; i < sw->count; i++) {
+        int b = (int)((values[i] + 1) * scale);
+        counts[(b < 0) ? 0 : (b < bins) ? b : bins - 1]++;
+    }
+    int max_count = 1;
+    for (int b = 0; b < bins; b++) {
+        max_count = (counts[b] > max_count) ? counts[b] : max_count;
+    }
+    const float half = POINT_RADIUS / 2;
+    for (int b = 0; b < bins; b++) {
+        if (counts[b] == 0) {
+            continue;
+        }
+        float offset = ((b + 0.5f) / scale - 1) * uc->radius;
+        Color color = ColorAlpha((axis == 0) ? SIN_COL : COS_COL, swarm_density_color(counts[b], max_count).a / 255.0f);
+        if (axis == 0) {
+            float y = uc->center.y - offset;
+            render_line((Vector2){uc->center.x - half, y}, (Vector2){uc->center.x + half, y}, SWARM_LINE, color);
+        } else {
+            float x = uc->center.x + offset;
+            render_line((Vector2){x, uc->center.y - half}, (Vector2){x, uc->center.y + half}, SWARM_LINE, color);
+        }
+    }
+}
+
+// One radial tick per occupied pixel of the circumference, and the sin and
+// cos projections on the diameters like the triangle's corners.
+void swarm_draw_circle(Swarm *sw, UnitCircle *uc, Font *font) {
+    if (sw->mode == SWARM_OFF) {
+        return;
+    }
+    int bins = (int)(uc->radius * PI*2 / SWARM_CIRCLE_BIN_PIXELS);
+    bins = (bins < 16) ? 16 : (bins > SWARM_CIRCLE_MAX_BINS) ? SWARM_CIRCLE_MAX_BINS : bins;
+    memset(sw->circle_bins, 0, sizeof(int) * bins);
+    const float scale = bins / (PI*2);
+    for (int i = 0; i < sw->count; i++) {
+        int b = (int)(sw->rad[i] * scale);
+        sw->circle_bins[(b < bins) ? b : bins - 1]++;
+    }
+    int max_count = 1;
+    for (int b = 0; b < bins; b++) {
+        max_count = (sw->circle_bins[b] > max_count) ? sw->circle_bins[b] : max_count;
+    }
+    for (int b = 0; b < bins; b++) {
+        if (sw->circle_bins[b] == 0) {
+            continue;
+        }
+        float s, c;
+        trig_sincos((b + 0.5f) / scale, &s, &c);
+        Vector2 direction = { c, -s };
+        render_line(
+            vec2_in_direction(uc->center, direction, uc->radius - POINT_RADIUS),
+            vec2_in_direction(uc->center, direction, uc->radius + POINT_RADIUS),
+            SWARM_LINE,
+            swarm_density_color(sw->circle_bins[b], max_count)
+        );
+    }
+    swarm_draw_axis(sw, uc, 0);
+    swarm_draw_axis(sw, uc, 1);
+    draw_text_centered(
+        font,
+        TEXT_FLAG_BACKING_RECTANGLE,
+        (Vector2){uc->center.x, uc->center.y + uc->radius * 1.4f + layout.label_offset},
+        0,
+        TextFormat("%s: %d points", swarm_mode_names[sw->mode], sw->count),
+        SWARM_COL
+    );
+}
+
+// Every point at its first turn inside the panel's domain, like the single
+// marker, binned per curve column with the extent of its values. The sin,
+// cos and tan panels take the swarm's own columns; anything else is read off
+// the panel's sampled curve, which is what is drawn at that pixel anyway and
+// saves evaluating expressions at 100k scattered arguments.
+void swarm_draw_panel(Swarm *sw, TrigonometricFunction *tf) {
+    int columns = tf->curve_count;
+    if (sw->mode == SWARM_OFF || columns <= 0 || (tf->expression != NULL && tf->expression->relation != EXPRESSION_RELATION_NONE)) {
+        return;
+    }
+    bool builtin = tf->expression == NULL && tf->evaluate_batch == NULL && tf->partial_sum == NULL;
+    const float turn = PI*2;
+    // Offsets from the domain start are rad - start, plus a turn when negative.
+    const float start = (float)(tf->domain.min - floor(tf->domain.min / turn) * turn);
+    const float span = (float)(tf->domain.max - tf->domain.min);
+    const float column_scale = columns / span;
+    const float func_min = tf->position.y;
+    const float func_max = tf->position.y + tf->size.y;
+    float offset[SWARM_CHUNK], y[SWARM_CHUNK];
+    for (int j = 0; j < columns; j++) {
+        sw->column_count[j] = 0;
+        sw->column_top[j] = INFINITY;
+        sw->column_bottom[j] = -INFINITY;
+    }
+
+    for (int done = 0; done < sw->count; done += SWARM_CHUNK) {
+        int n = (sw->count - done < SWARM_CHUNK) ? sw->count - done : SWARM_CHUNK;
+        const float *rad = sw->rad + done;
+        const float *sin = sw->sin + done;
+        const float *cos = sw->cos + done;
+        for (int k = 0; k < n; k++) {
+            float o = rad[k] - start;
+            offset[k] = o + ((o < 0) ? turn : 0);
+        }
+        if (builtin && (tf->function == trig_sin || tf->function == trig_cos || tf->function == trig_tan)) {
+            if (tf->function == trig_tan) {
+                for (int k = 0; k < n; k++) {
+                    y[k] = sin[k] / cos[k];
+                }
+            } else {
+                memcpy(y, (tf->function == trig_sin) ? sin : cos, sizeof(float) * n);
+            }
+            for (int k = 0; k < n; k++) {
+                bool inside = y[k] >= tf->range.min && y[k] <= tf->range.max;
+                y[k] = inside ? trigonometric_function_value_to_y(tf, y[k]) : NAN;
+            }
+        } else {
+            for (int k = 0; k < n; k++) {
+                float c = offset[k] * column_scale;
+                int j = (c < columns - 1) ? (int)c : columns - 1;
+                float value = tf->curve[j].y + (tf->curve[j + 1].y - tf->curve[j].y) * (c - j);
+                // The curve is clamped to the panel, points on its edges are out of range.
+                y[k] = (value > func_min && value < func_max) ? value : NAN;
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            if (!(offset[k] <= span && y[k] == y[k])) {
+                continue;
+            }
+            int j = (int)(offset[k] * column_scale);
+            j = (j < columns) ? j : columns - 1;
+            sw->column_count[j]++;
+            sw->column_top[j] = (y[k] < sw->column_top[j]) ? y[k] : sw->column_top[j];
+            sw->column_bottom[j] = (y[k] > sw->column_bottom[j]) ? y[k] : sw->column_bottom[j];
+        }
+    }
+
+    int max_count = 1;
+    for (int j = 0; j < columns; j++) {
+        max_count = (sw->column_count[j] > max_count) ? sw->column_count[j] : max_count;
+    }
+    const float column_width = tf->size.x / columns;
+    for (int j = 0; j < columns; j++) {
+        if (sw->column_count[j] == 0) {
+            continue;
+        }
+        float px = tf->position.x + (j + 0.5f) * column_width;
+        render_line(
+            (Vector2){px, sw->column_top[j] - 1},
+            (Vector2){px, sw->column_bottom[j] + 1},
+            SWARM_LINE,
+            swarm_density_color(sw->column_count[j], max_count)
+        );
+    }
+}
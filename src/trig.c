@@ -0,0 +1,438 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+// Evaluation kernels shared by the visualizer and the headless tools, so a
+// table written by trig_table holds exactly what the panels plot.
+
+#define TRIG_PI 3.14159265358979323846
+#define TRIG_DEG2RAD (TRIG_PI/180.0)
+
+typedef enum TrigKind {
+    TRIG_SIN,
+    TRIG_COS,
+    TRIG_TAN,
+    TRIG_KIND_COUNT,
+} TrigKind;
+
+typedef enum TrigUnit {
+    TRIG_UNIT_RADIANS,
+    TRIG_UNIT_DEGREES,
+} TrigUnit;
+
+static const char *const trig_kind_names[TRIG_KIND_COUNT] = { "sin", "cos", "tan" };
+
+// Range reduction: x = k*pi/2 + r with |r| <= pi/4, r held in double.
+// Below TRIG_REDUCE_MEDIUM_LIMIT one Cody-Waite step with pi/2 split into a
+// 25 bit head and a tail is exact enough for float results (as in musl's
+// __rem_pio2f): k < 2^28, so k*head fits the 53 bit double exactly. Larger arguments multiply the 24 bit mantissa by the window
+// of 2/pi bits that survives mod 4 (Payne-Hanek), so sin(1e38) is still the
+// correctly reduced value and not whatever a float pi multiple leaves over.
+// The sin/cos/tan kernels on r are musl's double polynomials; with the final
+// rounding to float the error stays within 1 ulp over the whole float range.
+
+#define TRIG_REDUCE_MEDIUM_LIMIT 421657440.0f // 2^28 * pi/2
+#define TRIG_2_OVER_PI 6.36619772367581382433e-01
+#define TRIG_PIO2_HEAD 1.57079631090164184570e+00 // 25 bits of pi/2
+#define TRIG_PIO2_TAIL 1.58932547735281966916e-08 // pi/2 - TRIG_PIO2_HEAD
+
+// Bits of 2/pi, enough for the largest float exponent plus a 96 bit window.
+static const uint32_t trig_two_over_pi_bits[] = {
+    0xA2F9836E, 0x4E441529, 0xFC2757D1, 0xF534DDC0, 0xDB629599,
+    0x3C439041, 0xFE5163AB, 0xDEBBC561, 0xB7246E3A, 0x424DD2E0,
+};
+
+static inline double trig_kernel_sin(double r) {
+    const double s1 = -0x15555554cbac77.0p-55, s2 = 0x111110896efbb2.0p-59;
+    const double s3 = -0x1a00f9e2cae774.0p-65, s4 = 0x16cd878c3b46a7.0p-71;
+    double z = r*r, w = z*z, s = z*r;
+    return (r + s*(s1 + z*s2)) + s*w*(s3 + z*s4);
+}
+
+static inline double trig_kernel_cos(double r) {
+    const double c0 = -0x1ffffffd0c5e81.0p-54, c1 = 0x155553e1053a42.0p-57;
+    const double c2 = -0x16c087e80f1e27.0p-62, c3 = 0x199342e0ee5069.0p-68;
+    double z = r*r, w = z*z;
+    return ((1.0 + z*c0) + w*c1) + (w*z)*(c2 + z*c3);
+}
+
+// tan(r), or -1/tan(r) = tan(r + pi/2) for odd quadrants.
+static inline double trig_kernel_tan(double r, bool odd) {
+    const double t0 = 0x15554d3418c99f.0p-54, t1 = 0x1112fd38999f72.0p-55;
+    const double t2 = 0x1b54c91d865afe.0p-57, t3 = 0x191df3908c33ce.0p-58;
+    const double t4 = 0x185dadfcecf44e.0p-61, t5 = 0x1362b9bf971bcd.0p-59;
+    double z = r*r, w = z*z, s = z*r;
+    double t = (r + s*(t0 + z*t1)) + (s*w)*((t2 + z*t3) + w*(t4 + z*t5));
+    return odd ? -1.0/t : t;
+}
+
+// |x| >= TRIG_REDUCE_MEDIUM_LIMIT and finite. x = m*2^e with a 24 bit m and
+// e >= 5; the bits of 2/pi before position e-1 only add multiples of 4 to
+// x*2/pi, so the product with the next 96 bits gives quadrant and fraction.
+static int trig_reduce_large(float x, double *r) {
+    union { float f; uint32_t u; } bits = { fabsf(x) };
+    uint64_t m = (bits.u & 0x7fffff) | 0x800000;
+    int e = (int)(bits.u >> 23) - 150;
+    int first = e - 2; // zero based index of bit e-1
+    int word = first / 32, shift = first % 32;
+    uint32_t window[3];
+    for (int i = 0; i < 3; i++) {
+        uint64_t pair = ((uint64_t)trig_two_over_pi_bits[word + i] << 32) | trig_two_over_pi_bits[word + i + 1];
+        window[i] = (uint32_t)(pair >> (32 - shift));
+    }
+    // m*window is 120 bits; bits 94 and 95 are the quadrant, the rest the fraction.
+    uint64_t p0 = m * window[2], p1 = m * window[1], p2 = m * window[0];
+    uint64_t low = p0 + (p1 << 32);
+    uint64_t high = p2 + (p1 >> 32) + (low < p0);
+    int quadrant = (int)(high >> 30) & 3;
+    uint64_t fraction = (high << 34) | (low >> 30);
+    if (fraction >> 63) {
+        quadrant = (quadrant + 1) & 3; // round to the nearest quadrant, fraction becomes negative
+    }
+    *r = (double)(int64_t)fraction * (TRIG_PI/2 / 18446744073709551616.0);
+    if (x < 0) {
+        *r = -*r;
+        quadrant = -quadrant;
+    }
+    return quadrant;
+}
+
+// Returns the quadrant k (only k & 3 matters) and writes r.
+static inline int trig_reduce(float x, double *r) {
+    if (fabsf(x) < TRIG_REDUCE_MEDIUM_LIMIT) {
+        // Through int like the SSE2 path, which also keeps the sign of -0.
+        int k = (int)rint((double)x * TRIG_2_OVER_PI);
+        *r = ((double)x - k*TRIG_PIO2_HEAD) - k*TRIG_PIO2_TAIL;
+        return k;
+    }
+    if (!isfinite(x)) {
+        *r = x - x;
+        return 0;
+    }
+    return trig_reduce_large(x, r);
+}
+
+// Degrees reduce exactly: below TRIG_REDUCE_DEGREES_LIMIT k*90 and x - k*90
+// fit a double, beyond it fmod by 360 (exact too) comes first. r stays in
+// degrees, so multiples of 90 give r = 0 and exact 0 and +-1, and 30, 45 and
+// 60 land on the kernel's best inputs for pi/6 and pi/4, which round to 0.5,
+// sqrt(0.5), 1 and so on.
+#define TRIG_REDUCE_DEGREES_LIMIT 1073741824.0f // 2^30
+#define TRIG_1_OVER_90 (1.0/90.0)
+
+static inline int trig_reduce_degrees(float x, double *r) {
+    double d = x;
+    if (!(fabsf(x) < TRIG_REDUCE_DEGREES_LIMIT)) {
+        d = isfinite(x) ? fmod(d, 360.0) : d - d;
+    }
+    int k = (int)rint(d * TRIG_1_OVER_90);
+    *r = (d - k*90.0) * TRIG_DEG2RAD;
+    return k;
+}
+
+// kind(k*pi/2 + r), zeros come out positive.
+static inline float trig_quadrant_value(TrigKind kind, int k, double r) {
+    if (kind == TRIG_TAN) {
+        return (float)trig_kernel_tan(r, k & 1);
+    }
+    k += (kind == TRIG_COS); // cos(x) = sin(x + pi/2)
+    double v = (k & 1) ? trig_kernel_cos(r) : trig_kernel_sin(r);
+    return (float)(((k & 2) ? -v : v) + 0.0);
+}
+
+float trig_sin(float rad) {
+    double r;
+    int k = trig_reduce(rad, &r);
+    return trig_quadrant_value(TRIG_SIN, k, r);
+}
+
+float trig_cos(float rad) {
+    double r;
+    int k = trig_reduce(rad, &r);
+    return trig_quadrant_value(TRIG_COS, k, r);
+}
+
+float trig_tan(float rad) {
+    double r;
+    int k = trig_reduce(rad, &r);
+    return trig_quadrant_value(TRIG_TAN, k, r);
+}
+
+// Both from one reduction.
+void trig_sincos(float rad, float *sin_out, float *cos_out) {
+    double r;
+    int k = trig_reduce(rad, &r);
+    *sin_out = trig_quadrant_value(TRIG_SIN, k, r);
+    *cos_out = trig_quadrant_value(TRIG_COS, k, r);
+}
+
+float trig_sind(float deg) {
+    double r;
+    int k = trig_reduce_degrees(deg, &r);
+    return trig_quadrant_value(TRIG_SIN, k, r);
+}
+
+float trig_cosd(float deg) {
+    double r;
+    int k = trig_reduce_degrees(deg, &r);
+    return trig_quadrant_value(TRIG_COS, k, r);
+}
+
+float trig_tand(float deg) {
+    double r;
+    int k = trig_reduce_degrees(deg, &r);
+    return trig_quadrant_value(TRIG_TAN, k, r);
+}
+
+void trig_sincosd(float deg, float *sin_out, float *cos_out) {
+    double r;
+    int k = trig_reduce_degrees(deg, &r);
+    *sin_out = trig_quadrant_value(TRIG_SIN, k, r);
+    *cos_out = trig_quadrant_value(TRIG_COS, k, r);
+}
+
+static float (*const trig_functions[TRIG_KIND_COUNT])(float) = { trig_sin, trig_cos, trig_tan };
+static float (*const trig_functions_degrees[TRIG_KIND_COUNT])(float) = { trig_sind, trig_cosd, trig_tand };
+static double (*const trig_functions_double[TRIG_KIND_COUNT])(double) = { sin, cos, tan };
+
+#ifdef __SSE2__
+// trig_quadrant_value on two lanes, same operations as the scalar code so
+// batch and single evaluation agree bit for bit.
+static inline __m128d trig_quadrant_value_pd(TrigKind kind, __m128i k, __m128d r) {
+    __m128d z = _mm_mul_pd(r, r), w = _mm_mul_pd(z, z), s = _mm_mul_pd(z, r);
+    // Quadrant bits widened to 64 bit lanes.
+    __m128i q = _mm_shuffle_epi32(k, _MM_SHUFFLE(1,1,0,0));
+    if (kind == TRIG_COS) {
+        q = _mm_add_epi32(q, _mm_set1_epi32(1));
+    }
+    __m128d odd = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    if (kind == TRIG_TAN) {
+        const double t0 = 0x15554d3418c99f.0p-54, t1 = 0x1112fd38999f72.0p-55;
+        const double t2 = 0x1b54c91d865afe.0p-57, t3 = 0x191df3908c33ce.0p-58;
+        const double t4 = 0x185dadfcecf44e.0p-61, t5 = 0x1362b9bf971bcd.0p-59;
+        __m128d u = _mm_add_pd(_mm_set1_pd(t0), _mm_mul_pd(z, _mm_set1_pd(t1)));
+        __m128d v = _mm_add_pd(_mm_set1_pd(t2), _mm_mul_pd(z, _mm_set1_pd(t3)));
+        __m128d y = _mm_add_pd(_mm_set1_pd(t4), _mm_mul_pd(z, _mm_set1_pd(t5)));
+        __m128d t = _mm_add_pd(_mm_add_pd(r, _mm_mul_pd(s, u)), _mm_mul_pd(_mm_mul_pd(s, w), _mm_add_pd(v, _mm_mul_pd(w, y))));
+        __m128d inverse = _mm_div_pd(_mm_set1_pd(-1.0), t);
+        return _mm_or_pd(_mm_and_pd(odd, inverse), _mm_andnot_pd(odd, t));
+    }
+    const double s1 = -0x15555554cbac77.0p-55, s2 = 0x111110896efbb2.0p-59;
+    const double s3 = -0x1a00f9e2cae774.0p-65, s4 = 0x16cd878c3b46a7.0p-71;
+    const double c0 = -0x1ffffffd0c5e81.0p-54, c1 = 0x155553e1053a42.0p-57;
+    const double c2 = -0x16c087e80f1e27.0p-62, c3 = 0x199342e0ee5069.0p-68;
+    __m128d sin_r = _mm_add_pd(
+        _mm_add_pd(r, _mm_mul_pd(s, _mm_add_pd(_mm_set1_pd(s1), _mm_mul_pd(z, _mm_set1_pd(s2))))),
+        _mm_mul_pd(_mm_mul_pd(s, w), _mm_add_pd(_mm_set1_pd(s3), _mm_mul_pd(z, _mm_set1_pd(s4))))
+    );
+    __m128d cos_r = _mm_add_pd(
+        _mm_add_pd(_mm_add_pd(_mm_set1_pd(1.0), _mm_mul_pd(z, _mm_set1_pd(c0))), _mm_mul_pd(w, _mm_set1_pd(c1))),
+        _mm_mul_pd(_mm_mul_pd(w, z), _mm_add_pd(_mm_set1_pd(c2), _mm_mul_pd(z, _mm_set1_pd(c3))))
+    );
+    __m128d result = _mm_or_pd(_mm_and_pd(odd, cos_r), _mm_andnot_pd(odd, sin_r));
+    __m128d sign = _mm_castsi128_pd(_mm_slli_epi64(_mm_and_si128(q, _mm_set1_epi32(2)), 62));
+    return _mm_add_pd(_mm_xor_pd(result, sign), _mm_setzero_pd());
+}
+
+static inline __m128d trig_evaluate_pd(TrigKind kind, TrigUnit unit, __m128d x) {
+    if (unit == TRIG_UNIT_DEGREES) {
+        __m128i k = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(TRIG_1_OVER_90)));
+        __m128d r = _mm_mul_pd(_mm_sub_pd(x, _mm_mul_pd(_mm_cvtepi32_pd(k), _mm_set1_pd(90.0))), _mm_set1_pd(TRIG_DEG2RAD));
+        return trig_quadrant_value_pd(kind, k, r);
+    }
+    __m128i k = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(TRIG_2_OVER_PI)));
+    __m128d kd = _mm_cvtepi32_pd(k);
+    __m128d r = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(kd, _mm_set1_pd(TRIG_PIO2_HEAD))), _mm_mul_pd(kd, _mm_set1_pd(TRIG_PIO2_TAIL)));
+    return trig_quadrant_value_pd(kind, k, r);
+}
+#endif
+
+// out[i] = kind(x[i]) with x in the given unit; x and out may be the same
+// array. Groups of four arguments below the exact reduction limit run in
+// SSE2 double lanes, anything else (huge, infinite, NaN) goes through the
+// scalar path.
+void trig_evaluate_batch_unit(TrigKind kind, TrigUnit unit, const float *x, float *out, int count) {
+    float (*function)(float) = (unit == TRIG_UNIT_DEGREES) ? trig_functions_degrees[kind] : trig_functions[kind];
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 limit = _mm_set1_ps((unit == TRIG_UNIT_DEGREES) ? TRIG_REDUCE_DEGREES_LIMIT : TRIG_REDUCE_MEDIUM_LIMIT);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_and_ps(v, abs_mask), limit)) != 0xf) {
+            for (int l = 0; l < 4; l++) {
+                out[i + l] = function(x[i + l]);
+            }
+            continue;
+        }
+        __m128 low = _mm_cvtpd_ps(trig_evaluate_pd(kind, unit, _mm_cvtps_pd(v)));
+        __m128 high = _mm_cvtpd_ps(trig_evaluate_pd(kind, unit, _mm_cvtps_pd(_mm_movehl_ps(v, v))));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(low, high));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = function(x[i]);
+    }
+}
+
+void trig_evaluate_batch_kind(TrigKind kind, const float *x, float *out, int count) {
+    trig_evaluate_batch_unit(kind, TRIG_UNIT_RADIANS, x, out, count);
+}
+
+// Batch form of any float function, taking the vector path for the built-in kernels.
+void trig_evaluate_batch(float (*function)(float), const float *x, float *out, int count) {
+    for (int k = 0; k < TRIG_KIND_COUNT; k++) {
+        if (function == trig_functions[k]) {
+            trig_evaluate_batch_kind((TrigKind)k, x, out, count);
+            return;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        out[i] = function(x[i]);
+    }
+}
+
+// angle(i) = start + step*i, evaluated in the unit's own precision like the
+// panels do; degrees go through the degree kernels without converting.
+void trig_evaluate_range_float(TrigKind kind, TrigUnit unit, double start, double step, uint64_t first, uint64_t count, float *out) {
+    for (uint64_t i = 0; i < count; i++) {
+        out[i] = (float)(start + step * (double)(first + i));
+    }
+    trig_evaluate_batch_unit(kind, unit, out, out, (int)count);
+}
+
+// Same quadrants as trig_quadrant_value, on libm's double kernels.
+static inline double trig_quadrant_value_double(TrigKind kind, int k, double r) {
+    if (kind == TRIG_TAN) {
+        return (k & 1) ? -1.0/tan(r) : tan(r);
+    }
+    k += (kind == TRIG_COS);
+    double v = (k & 1) ? cos(r) : sin(r);
+    return ((k & 2) ? -v : v) + 0.0;
+}
+
+// Degrees are reduced exactly before converting, like trig_reduce_degrees,
+// so multiples of 90 give the same exact zeros and infinities as the float
+// tables and the panels instead of whatever deg*pi/180 rounds to.
+void trig_evaluate_range_double(TrigKind kind, TrigUnit unit, double start, double step, uint64_t first, uint64_t count, double *out) {
+    if (unit == TRIG_UNIT_RADIANS) {
+        double (*function)(double) = trig_functions_double[kind];
+        for (uint64_t i = 0; i < count; i++) {
+            out[i] = function(start + step * (double)(first + i));
+        }
+        return;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        double d = fmod(start + step * (double)(first + i), 360.0);
+        int k = (int)rint(d * TRIG_1_OVER_90);
+        out[i] = trig_quadrant_value_double(kind, k, (d - k*90.0) * TRIG_DEG2RAD);
+    }
+}
+
+// atan2 for pointer and sensor positions, without the quadrant branches of
+// the asin/acos route. An odd minimax polynomial of degree 15 gives atan(t)
+// on t = min(|x|,|y|)/max(|x|,|y|) in [0,1] to 3.7e-8, then pi/2 - a, pi - a
+// and the sign of y fold it into (-pi, pi] by selects. With the float
+// rounding of pi - a the result stays within 3.2e-7 rad (1.5 ulp of pi) of
+// the exact angle. atan2(0, 0) is 0, NaN in gives NaN; infinite arguments are not
+// handled (inf/inf), positions are finite.
+#define TRIG_ATAN_C0 9.999993356e-01f
+#define TRIG_ATAN_C1 -3.332986078e-01f
+#define TRIG_ATAN_C2 1.994656566e-01f
+#define TRIG_ATAN_C3 -1.390862958e-01f
+#define TRIG_ATAN_C4 9.642197409e-02f
+#define TRIG_ATAN_C5 -5.591232793e-02f
+#define TRIG_ATAN_C6 2.186295871e-02f
+#define TRIG_ATAN_C7 -4.054567450e-03f
+
+#ifdef __SSE2__
+// Four lanes of trig_atan2; the scalar form runs one lane of this too, as
+// compilers turn the selects of the plain C version into branches that
+// mispredict on every other pointer position.
+static inline __m128 trig_atan2_ps(__m128 y, __m128 x) {
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 ax = _mm_andnot_ps(sign_mask, x);
+    __m128 ay = _mm_andnot_ps(sign_mask, y);
+    // _mm_max_ps(a, b) is a > b ? a : b, the same NaN choice as the C version.
+    __m128 high = _mm_max_ps(ax, ay);
+    __m128 low = _mm_min_ps(ay, ax);
+    __m128 high_zero = _mm_cmpeq_ps(high, zero);
+    __m128 t = _mm_div_ps(low, _mm_or_ps(_mm_and_ps(high_zero, _mm_set1_ps(1.0f)), _mm_andnot_ps(high_zero, high)));
+    __m128 z = _mm_mul_ps(t, t);
+    __m128 p = _mm_set1_ps(TRIG_ATAN_C7);
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C6));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C4));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C2));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C1));
+    p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(TRIG_ATAN_C0));
+    __m128 a = _mm_mul_ps(t, p);
+    __m128 steep = _mm_cmpgt_ps(ay, ax);
+    a = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps((float)(TRIG_PI/2)), a)), _mm_andnot_ps(steep, a));
+    __m128 left = _mm_cmplt_ps(x, zero);
+    a = _mm_or_ps(_mm_and_ps(left, _mm_sub_ps(_mm_set1_ps((float)TRIG_PI), a)), _mm_andnot_ps(left, a));
+    return _mm_or_ps(_mm_andnot_ps(sign_mask, a), _mm_and_ps(sign_mask, y));
+}
+#endif
+
+float trig_atan2(float y, float x) {
+#ifdef __SSE2__
+    return _mm_cvtss_f32(trig_atan2_ps(_mm_set_ss(y), _mm_set_ss(x)));
+#else
+    float ax = fabsf(x), ay = fabsf(y);
+    float high = (ax > ay) ? ax : ay;
+    float low = (ay < ax) ? ay : ax;
+    float t = low / ((high == 0) ? 1.0f : high);
+    float z = t * t;
+    float p = TRIG_ATAN_C7;
+    p = p * z + TRIG_ATAN_C6;
+    p = p * z + TRIG_ATAN_C5;
+    p = p * z + TRIG_ATAN_C4;
+    p = p * z + TRIG_ATAN_C3;
+    p = p * z + TRIG_ATAN_C2;
+    p = p * z + TRIG_ATAN_C1;
+    p = p * z + TRIG_ATAN_C0;
+    float a = t * p;
+    a = (ay > ax) ? (float)(TRIG_PI/2) - a : a;
+    a = (x < 0) ? (float)TRIG_PI - a : a;
+    return copysignf(a, y);
+#endif
+}
+
+// The direction of (x, y) as an angle in [0, 2pi), for positions around a
+// center; same error as trig_atan2 plus the rounding of the wrap.
+#ifdef __SSE2__
+static inline __m128 trig_angle_ps(__m128 y, __m128 x) {
+    __m128 a = trig_atan2_ps(y, x);
+    __m128 negative = _mm_cmplt_ps(a, _mm_setzero_ps());
+    // Adding +0 also turns the -0 of a negative zero y into 0.
+    return _mm_add_ps(a, _mm_and_ps(negative, _mm_set1_ps((float)(TRIG_PI*2))));
+}
+#endif
+
+float trig_angle(float y, float x) {
+#ifdef __SSE2__
+    return _mm_cvtss_f32(trig_angle_ps(_mm_set_ss(y), _mm_set_ss(x)));
+#else
+    float a = trig_atan2(y, x);
+    return a + ((a < 0) ? (float)(TRIG_PI*2) : 0.0f);
+#endif
+}
+
+// out[i] = trig_angle(y[i], x[i]), bit for bit; out may alias either input.
+void trig_angle_batch(const float *y, const float *x, float *out, int count) {
+    int i = 0;
+#ifdef __SSE2__
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, trig_angle_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = trig_angle(y[i], x[i]);
+    }
+}
@@ -0,0 +1,344 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.c"
+#include "trig.c"
+
+// Measures the accuracy and speed of the float kernels the visualizer can
+// use. Every float input of a range (all 2^32 bit patterns by default) is
+// evaluated by each selected kernel, compared against a double or long double
+// reference in units of the float ulp of the reference, and timed. One JSON
+// object per kernel is printed, so runs can be diffed to track regressions.
+
+#define TRIG_AUDIT_MAX_THREADS 256
+#define TRIG_AUDIT_BATCH 4096
+#define TRIG_AUDIT_BLOCK (TRIG_AUDIT_BATCH * 16) // keys claimed by a thread at a time
+#define TRIG_AUDIT_MAX_KERNELS 32
+// Bucket i counts errors <= 2^(i-1) ulp; then one bucket above the last
+// edge and one for wrong NaN/infinity classification.
+#define TRIG_AUDIT_EDGES 22
+#define TRIG_AUDIT_BUCKETS (TRIG_AUDIT_EDGES + 2)
+
+typedef enum TrigAuditFunction {
+    TRIG_AUDIT_SIN,
+    TRIG_AUDIT_COS,
+    TRIG_AUDIT_TAN,
+    TRIG_AUDIT_ASIN,
+    TRIG_AUDIT_ACOS,
+} TrigAuditFunction;
+
+typedef struct TrigAuditKernel {
+    const char *name;
+    float (*scalar)(float);     // called per input when set
+    TrigKind kind;              // otherwise trig_evaluate_batch_unit(kind, unit, ...)
+    TrigUnit unit;              // also the unit of the reference
+    TrigAuditFunction function;
+} TrigAuditKernel;
+
+static float trig_audit_sinf(float x) { return sinf(x); }
+static float trig_audit_cosf(float x) { return cosf(x); }
+static float trig_audit_tanf(float x) { return tanf(x); }
+static float trig_audit_asinf(float x) { return asinf(x); }
+static float trig_audit_acosf(float x) { return acosf(x); }
+
+static const TrigAuditKernel trig_audit_kernels[] = {
+    { "sinf",       trig_audit_sinf,  0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_SIN },
+    { "cosf",       trig_audit_cosf,  0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_COS },
+    { "tanf",       trig_audit_tanf,  0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_TAN },
+    { "asinf",      trig_audit_asinf, 0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_ASIN },
+    { "acosf",      trig_audit_acosf, 0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_ACOS },
+    { "trig_sin",   trig_sin,         0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_SIN },
+    { "trig_cos",   trig_cos,         0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_COS },
+    { "trig_tan",   trig_tan,         0,        TRIG_UNIT_RADIANS, TRIG_AUDIT_TAN },
+    { "batch_sin",  NULL,             TRIG_SIN, TRIG_UNIT_RADIANS, TRIG_AUDIT_SIN },
+    { "batch_cos",  NULL,             TRIG_COS, TRIG_UNIT_RADIANS, TRIG_AUDIT_COS },
+    { "batch_tan",  NULL,             TRIG_TAN, TRIG_UNIT_RADIANS, TRIG_AUDIT_TAN },
+    { "trig_sind",  trig_sind,        0,        TRIG_UNIT_DEGREES, TRIG_AUDIT_SIN },
+    { "trig_cosd",  trig_cosd,        0,        TRIG_UNIT_DEGREES, TRIG_AUDIT_COS },
+    { "trig_tand",  trig_tand,        0,        TRIG_UNIT_DEGREES, TRIG_AUDIT_TAN },
+    { "batch_sind", NULL,             TRIG_SIN, TRIG_UNIT_DEGREES, TRIG_AUDIT_SIN },
+    { "batch_cosd", NULL,             TRIG_COS, TRIG_UNIT_DEGREES, TRIG_AUDIT_COS },
+    { "batch_tand", NULL,             TRIG_TAN, TRIG_UNIT_DEGREES, TRIG_AUDIT_TAN },
+};
+#define TRIG_AUDIT_KERNEL_COUNT ((int)(sizeof(trig_audit_kernels) / sizeof(trig_audit_kernels[0])))
+
+typedef struct TrigAuditOptions {
+    const TrigAuditKernel *kernels[TRIG_AUDIT_MAX_KERNELS];
+    int kernel_count;
+    uint32_t first_key;     // inputs are the floats with first_key <= key <= last_key
+    uint32_t last_key;
+    bool extended;          // long double reference instead of double
+    int thread_count;
+    atomic_uint_fast64_t next_key;
+} TrigAuditOptions;
+
+typedef struct TrigAuditStats {
+    uint64_t count;
+    double sum_ulp;
+    double max_ulp;
+    float worst_input;
+    float worst_output;
+    double seconds;
+    uint64_t histogram[TRIG_AUDIT_BUCKETS];
+} TrigAuditStats;
+
+typedef struct TrigAuditJob {
+    TrigAuditOptions *options;
+    TrigAuditStats stats[TRIG_AUDIT_MAX_KERNELS];
+} TrigAuditJob;
+
+// Order preserving map between floats and unsigned keys: -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN.
+static inline uint32_t trig_audit_key(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return (u >> 31) ? ~u : (u | 0x80000000u);
+}
+
+static inline float trig_audit_float(uint32_t key) {
+    uint32_t u = (key >> 31) ? (key & 0x7fffffffu) : ~key;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Degrees are reduced exactly (fmod and k*90 are exact in double) before
+// converting, so the reference does not inherit the error of x*pi/180.
+static long double trig_audit_reference(const TrigAuditKernel *k, float x, bool extended) {
+    long double r = x;
+    int quadrant = 0;
+    if (k->unit == TRIG_UNIT_DEGREES && isfinite(x)) {
+        double d = fmod((double)x, 360.0);
+        quadrant = (int)rint(d / 90);
+        r = (long double)(d - quadrant * 90.0) * (3.14159265358979323846264338327950288L / 180);
+    }
+    long double s, c;
+    if (extended) {
+        s = sinl(r);
+        c = cosl(r);
+    } else {
+        s = sin((double)r);
+        c = cos((double)r);
+    }
+    switch (k->function) {
+    case TRIG_AUDIT_ASIN: return extended ? asinl(x) : asin(x);
+    case TRIG_AUDIT_ACOS: return extended ? acosl(x) : acos(x);
+    case TRIG_AUDIT_TAN:
+        if (k->unit == TRIG_UNIT_RADIANS) {
+            return extended ? tanl(r) : tan((double)r);
+        }
+        return (quadrant & 1) ? -c / s : s / c;
+    default: break;
+    }
+    quadrant += (k->function == TRIG_AUDIT_COS);
+    long double v = (quadrant & 1) ? c : s;
+    return (quadrant & 2) ? -v : v;
+}
+
+// Error in ulps of the reference rounded to float; -1 for a NaN/infinity mismatch.
+static double trig_audit_ulp_error(float got, long double reference) {
+    if (isnan(reference) || isnan(got)) {
+        return (isnan(reference) && isnan(got)) ? 0 : -1;
+    }
+    float rounded = (float)reference;
+    if (isinf(rounded) || isinf(got)) {
+        return (rounded == got) ? 0 : -1;
+    }
+    int exponent;
+    frexpl(reference, &exponent);
+    int ulp_exponent = (exponent - 24 < -149) ? -149 : exponent - 24;
+    return (double)(fabsl((long double)got - reference) / ldexpl(1, ulp_exponent));
+}
+
+static void trig_audit_record(TrigAuditStats *st, float x, float got, double error) {
+    st->count++;
+    if (error < 0) {
+        st->histogram[TRIG_AUDIT_BUCKETS - 1]++;
+        return;
+    }
+    st->sum_ulp += error;
+    if (error > st->max_ulp) {
+        st->max_ulp = error;
+        st->worst_input = x;
+        st->worst_output = got;
+    }
+    int bucket = 0;
+    for (double edge = 0.5; bucket < TRIG_AUDIT_EDGES && error > edge; edge *= 2) {
+        bucket++;
+    }
+    st->histogram[bucket]++;
+}
+
+// Threads claim blocks of keys from a shared counter: NaNs and tiny inputs
+// are much cheaper than huge arguments, so fixed slices would not balance.
+static void *trig_audit_job_run(void *arg) {
+    TrigAuditJob *job = arg;
+    TrigAuditOptions *o = job->options;
+    float x[TRIG_AUDIT_BATCH];
+    float out[TRIG_AUDIT_BATCH];
+    uint64_t end = (uint64_t)o->last_key + 1;
+    for (uint64_t block = atomic_fetch_add(&o->next_key, TRIG_AUDIT_BLOCK); block < end; block = atomic_fetch_add(&o->next_key, TRIG_AUDIT_BLOCK)) {
+        uint64_t block_end = (end - block < TRIG_AUDIT_BLOCK) ? end : block + TRIG_AUDIT_BLOCK;
+        for (uint64_t key = block; key < block_end; key += TRIG_AUDIT_BATCH) {
+            int n = (block_end - key < TRIG_AUDIT_BATCH) ? (int)(block_end - key) : TRIG_AUDIT_BATCH;
+            for (int i = 0; i < n; i++) {
+                x[i] = trig_audit_float((uint32_t)(key + i));
+            }
+            for (int k = 0; k < o->kernel_count; k++) {
+                const TrigAuditKernel *kernel = o->kernels[k];
+                TrigAuditStats *st = &job->stats[k];
+                double start = platform_time_seconds();
+                if (kernel->scalar != NULL) {
+                    for (int i = 0; i < n; i++) {
+                        out[i] = kernel->scalar(x[i]);
+                    }
+                } else {
+                    trig_evaluate_batch_unit(kernel->kind, kernel->unit, x, out, n);
+                }
+                st->seconds += platform_time_seconds() - start;
+                for (int i = 0; i < n; i++) {
+                    trig_audit_record(st, x[i], out[i], trig_audit_ulp_error(out[i], trig_audit_reference(kernel, x[i], o->extended)));
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static void trig_audit_print(const TrigAuditOptions *o, const TrigAuditKernel *kernel, const TrigAuditStats *st, double wall_seconds) {
+    uint64_t compared = st->count - st->histogram[TRIG_AUDIT_BUCKETS - 1];
+    printf("{\"kernel\":\"%s\",\"reference\":\"%s\"", kernel->name, o->extended ? "long double" : "double");
+    printf(",\"first\":\"%a\",\"last\":\"%a\"", trig_audit_float(o->first_key), trig_audit_float(o->last_key));
+    printf(",\"inputs\":%llu,\"threads\":%d", (unsigned long long)st->count, o->thread_count);
+    printf(",\"max_ulp\":%.6g,\"mean_ulp\":%.6g", st->max_ulp, (compared > 0) ? st->sum_ulp / compared : 0.0);
+    printf(",\"worst_input\":\"%a\",\"worst_output\":\"%a\"", st->worst_input, st->worst_output);
+    printf(",\"class_mismatches\":%llu", (unsigned long long)st->histogram[TRIG_AUDIT_BUCKETS - 1]);
+    printf(",\"ns_per_element\":%.4f", (st->count > 0) ? st->seconds * 1e9 / st->count : 0.0);
+    printf(",\"wall_seconds\":%.3f,\"histogram_ulp_edges\":[", wall_seconds);
+    double edge = 0.5;
+    for (int i = 0; i < TRIG_AUDIT_EDGES; i++, edge *= 2) {
+        printf((i == 0) ? "%g" : ",%g", edge);
+    }
+    printf("],\"histogram\":[");
+    for (int i = 0; i < TRIG_AUDIT_EDGES + 1; i++) {
+        printf((i == 0) ? "%llu" : ",%llu", (unsigned long long)st->histogram[i]);
+    }
+    printf("]}\n");
+}
+
+static void trig_audit_usage(const char *program) {
+    printf("%s [Options]\n", program);
+    printf("Options:\n");
+    printf("   -k <a,b,...>       kernels (all): ");
+    for (int k = 0; k < TRIG_AUDIT_KERNEL_COUNT; k++) {
+        printf((k == 0) ? "%s" : ",%s", trig_audit_kernels[k].name);
+    }
+    printf("\n");
+    printf("   -s <start>         first input (every float, including NaNs)\n");
+    printf("   -e <end>           last input, inclusive\n");
+    printf("   -r double|long     reference precision (double)\n");
+    printf("   -j <threads>       worker threads (all cores)\n");
+    printf("Prints one JSON object per kernel. The histogram counts errors up to each\n");
+    printf("edge, then above the last edge; NaN/infinity mismatches are counted apart.\n");
+}
+
+static bool trig_audit_select(TrigAuditOptions *o, const char *list) {
+    char names[1024];
+    snprintf(names, sizeof(names), "%s", list);
+    o->kernel_count = 0;
+    for (char *name = strtok(names, ","); name != NULL; name = strtok(NULL, ",")) {
+        int found = -1;
+        for (int k = 0; k < TRIG_AUDIT_KERNEL_COUNT; k++) {
+            if (strcmp(name, trig_audit_kernels[k].name) == 0) {
+                found = k;
+            }
+        }
+        if (found < 0 || o->kernel_count == TRIG_AUDIT_MAX_KERNELS) {
+            fprintf(stderr, "unknown kernel: %s\n", name);
+            return false;
+        }
+        o->kernels[o->kernel_count++] = &trig_audit_kernels[found];
+    }
+    return o->kernel_count > 0;
+}
+
+int main(int argc, char **argv) {
+    TrigAuditOptions o = {
+        .first_key = 0,
+        .last_key = UINT32_MAX,
+        .thread_count = platform_cpu_count(),
+    };
+    for (int k = 0; k < TRIG_AUDIT_KERNEL_COUNT; k++) {
+        o.kernels[o.kernel_count++] = &trig_audit_kernels[k];
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL || strcmp(arg, "-h") == 0) {
+            trig_audit_usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "-k") == 0) {
+            if (!trig_audit_select(&o, value)) {
+                return 1;
+            }
+        } else if (strcmp(arg, "-s") == 0) {
+            o.first_key = trig_audit_key(strtof(value, NULL));
+        } else if (strcmp(arg, "-e") == 0) {
+            o.last_key = trig_audit_key(strtof(value, NULL));
+        } else if (strcmp(arg, "-r") == 0) {
+            o.extended = strcmp(value, "long") == 0;
+        } else if (strcmp(arg, "-j") == 0) {
+            o.thread_count = atoi(value);
+        } else {
+            trig_audit_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (o.first_key > o.last_key) {
+        fprintf(stderr, "empty range\n");
+        return 1;
+    }
+    if (o.thread_count < 1) {
+        o.thread_count = 1;
+    } else if (o.thread_count > TRIG_AUDIT_MAX_THREADS) {
+        o.thread_count = TRIG_AUDIT_MAX_THREADS;
+    }
+
+    atomic_init(&o.next_key, o.first_key);
+    TrigAuditJob *jobs = calloc((size_t)o.thread_count, sizeof(TrigAuditJob));
+    pthread_t threads[TRIG_AUDIT_MAX_THREADS];
+    double start_time = platform_time_seconds();
+    for (int t = 0; t < o.thread_count; t++) {
+        jobs[t].options = &o;
+        pthread_create(&threads[t], NULL, trig_audit_job_run, &jobs[t]);
+    }
+    for (int t = 0; t < o.thread_count; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double wall_seconds = platform_time_seconds() - start_time;
+
+    for (int k = 0; k < o.kernel_count; k++) {
+        TrigAuditStats total = {0};
+        for (int t = 0; t < o.thread_count; t++) {
+            const TrigAuditStats *st = &jobs[t].stats[k];
+            total.count += st->count;
+            total.sum_ulp += st->sum_ulp;
+            total.seconds += st->seconds;
+            if (st->max_ulp > total.max_ulp) {
+                total.max_ulp = st->max_ulp;
+                total.worst_input = st->worst_input;
+                total.worst_output = st->worst_output;
+            }
+            for (int b = 0; b < TRIG_AUDIT_BUCKETS; b++) {
+                total.histogram[b] += st->histogram[b];
+            }
+        }
+        trig_audit_print(&o, o.kernels[k], &total, wall_seconds);
+    }
+    free(jobs);
+    return 0;
+}
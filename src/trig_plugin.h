@@ -0,0 +1,43 @@
+#ifndef TRIG_PLUGIN_H
+#define TRIG_PLUGIN_H
+
+#include <stdint.h>
+
+// ABI between the visualizer and function kernel plugins. A plugin is a
+// shared library (.dll/.so) placed in the plugin directory that exports
+//
+//     TRIG_PLUGIN_EXPORT const TrigPlugin *trig_plugin_describe(void);
+//
+// The returned description and everything it points to must stay valid
+// until the library is unloaded. Bump TRIG_PLUGIN_ABI_VERSION on any change
+// to these structs; the host refuses plugins built against another version.
+
+#define TRIG_PLUGIN_ABI_VERSION 1
+#define TRIG_PLUGIN_ENTRY "trig_plugin_describe"
+
+#ifdef _WIN32
+    #define TRIG_PLUGIN_EXPORT __declspec(dllexport)
+#else
+    #define TRIG_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Writes f(x[i]) to out[i] for i < count; called from any thread.
+typedef void (*TrigPluginEvaluateBatch)(const float *x, float *out, int count);
+
+typedef struct TrigPluginFunction {
+    const char *name;       // panel label, at most 15 characters are shown
+    uint32_t color;         // 0xRRGGBBAA
+    float range_min;        // vertical range of the panel
+    float range_max;
+    TrigPluginEvaluateBatch evaluate_batch;
+} TrigPluginFunction;
+
+typedef struct TrigPlugin {
+    uint32_t abi_version;   // TRIG_PLUGIN_ABI_VERSION the plugin was built with
+    uint32_t function_count;
+    const TrigPluginFunction *functions;
+} TrigPlugin;
+
+typedef const TrigPlugin *(*TrigPluginDescribe)(void);
+
+#endif
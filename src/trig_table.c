@@ -0,0 +1,230 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platform.c"
+#include "trig.c"
+
+#define TRIG_TABLE_MAX_THREADS 256
+#define TRIG_TABLE_BATCH 4096
+// CSV records are padded to a fixed width so every thread knows where its
+// slice of the mapped file starts without formatting the ones before it.
+#define TRIG_TABLE_CSV_FLOAT_FIELD 16
+#define TRIG_TABLE_CSV_DOUBLE_FIELD 25
+
+typedef enum TrigTableFormat {
+    TRIG_TABLE_FORMAT_BINARY,
+    TRIG_TABLE_FORMAT_CSV,
+} TrigTableFormat;
+
+typedef struct TrigTableOptions {
+    TrigKind kind;
+    TrigUnit unit;
+    bool is_double;
+    TrigTableFormat format;
+    double start;
+    double end;
+    uint64_t count;
+    int thread_count;
+    const char *out_path;
+} TrigTableOptions;
+
+typedef struct TrigTableJob {
+    const TrigTableOptions *options;
+    char *out;
+    uint64_t first;
+    uint64_t count;
+    double step;
+} TrigTableJob;
+
+static int trig_table_record_size(const TrigTableOptions *o) {
+    if (o->format == TRIG_TABLE_FORMAT_BINARY) {
+        return o->is_double ? (int)sizeof(double) : (int)sizeof(float);
+    }
+    int field = o->is_double ? TRIG_TABLE_CSV_DOUBLE_FIELD : TRIG_TABLE_CSV_FLOAT_FIELD;
+    return field * 2 + 2;
+}
+
+static void trig_table_write_field(char *dst, int width, int precision, double value) {
+    char field[64];
+    int length = snprintf(field, sizeof(field), "%.*e", precision, value);
+    if (length > width) {
+        length = width;
+    }
+    memset(dst, ' ', width - length);
+    memcpy(dst + width - length, field, length);
+}
+
+static void *trig_table_job_run(void *arg) {
+    TrigTableJob *job = arg;
+    const TrigTableOptions *o = job->options;
+    int record_size = trig_table_record_size(o);
+    float values_float[TRIG_TABLE_BATCH];
+    double values_double[TRIG_TABLE_BATCH];
+
+    for (uint64_t done = 0; done < job->count; done += TRIG_TABLE_BATCH) {
+        uint64_t first = job->first + done;
+        uint64_t count = (job->count - done < TRIG_TABLE_BATCH) ? (job->count - done) : TRIG_TABLE_BATCH;
+        char *dst = job->out + first * (uint64_t)record_size;
+
+        if (o->format == TRIG_TABLE_FORMAT_BINARY) {
+            if (o->is_double) {
+                trig_evaluate_range_double(o->kind, o->unit, o->start, job->step, first, count, (double *)dst);
+            } else {
+                trig_evaluate_range_float(o->kind, o->unit, o->start, job->step, first, count, (float *)dst);
+            }
+            continue;
+        }
+
+        if (o->is_double) {
+            trig_evaluate_range_double(o->kind, o->unit, o->start, job->step, first, count, values_double);
+        } else {
+            trig_evaluate_range_float(o->kind, o->unit, o->start, job->step, first, count, values_float);
+        }
+        int width = o->is_double ? TRIG_TABLE_CSV_DOUBLE_FIELD : TRIG_TABLE_CSV_FLOAT_FIELD;
+        int precision = o->is_double ? 17 : 9;
+        for (uint64_t i = 0; i < count; i++) {
+            double angle = o->start + job->step * (double)(first + i);
+            double value = o->is_double ? values_double[i] : values_float[i];
+            if (!o->is_double) {
+                angle = (float)angle;
+            }
+            char *record = dst + i * (uint64_t)record_size;
+            trig_table_write_field(record, width, precision, angle);
+            record[width] = ',';
+            trig_table_write_field(record + width + 1, width, precision, value);
+            record[record_size - 1] = '\n';
+        }
+    }
+    return NULL;
+}
+
+static void trig_table_usage(const char *program) {
+    printf("%s [Options] -o <file>\n", program);
+    printf("Options:\n");
+    printf("   -f sin|cos|tan     function (sin)\n");
+    printf("   -u rad|deg         angle unit (rad)\n");
+    printf("   -t float|double    value type (float)\n");
+    printf("   -s <start>         first angle (0)\n");
+    printf("   -e <end>           last angle, inclusive (2pi or 360)\n");
+    printf("   -n <count>         number of angles (1000000)\n");
+    printf("   -j <threads>       worker threads (all cores)\n");
+    printf("   -csv               write fixed-width \"angle,value\" lines instead of raw values\n");
+}
+
+int main(int argc, char **argv) {
+    TrigTableOptions o = {
+        .kind = TRIG_SIN,
+        .unit = TRIG_UNIT_RADIANS,
+        .format = TRIG_TABLE_FORMAT_BINARY,
+        .count = 1000000,
+        .thread_count = platform_cpu_count(),
+    };
+    bool has_end = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "-csv") == 0) {
+            o.format = TRIG_TABLE_FORMAT_CSV;
+            continue;
+        }
+        if (value == NULL || strcmp(arg, "-h") == 0) {
+            trig_table_usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "-f") == 0) {
+            o.kind = TRIG_KIND_COUNT;
+            for (int k = 0; k < TRIG_KIND_COUNT; k++) {
+                if (strcmp(value, trig_kind_names[k]) == 0) {
+                    o.kind = (TrigKind)k;
+                }
+            }
+            if (o.kind == TRIG_KIND_COUNT) {
+                fprintf(stderr, "unknown function: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "-u") == 0) {
+            o.unit = (strcmp(value, "deg") == 0) ? TRIG_UNIT_DEGREES : TRIG_UNIT_RADIANS;
+        } else if (strcmp(arg, "-t") == 0) {
+            o.is_double = strcmp(value, "double") == 0;
+        } else if (strcmp(arg, "-s") == 0) {
+            o.start = atof(value);
+        } else if (strcmp(arg, "-e") == 0) {
+            o.end = atof(value);
+            has_end = true;
+        } else if (strcmp(arg, "-n") == 0) {
+            o.count = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "-j") == 0) {
+            o.thread_count = atoi(value);
+        } else if (strcmp(arg, "-o") == 0) {
+            o.out_path = value;
+        } else {
+            trig_table_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (o.out_path == NULL || o.count == 0) {
+        trig_table_usage(argv[0]);
+        return 1;
+    }
+    if (!has_end) {
+        o.end = (o.unit == TRIG_UNIT_DEGREES) ? 360 : TRIG_PI*2;
+    }
+    if (o.thread_count < 1) {
+        o.thread_count = 1;
+    } else if (o.thread_count > TRIG_TABLE_MAX_THREADS) {
+        o.thread_count = TRIG_TABLE_MAX_THREADS;
+    }
+
+    uint64_t size = o.count * (uint64_t)trig_table_record_size(&o);
+    MappedFile out;
+    if (!platform_map_file_write(o.out_path, size, &out)) {
+        fprintf(stderr, "failed to map %s (%llu bytes)\n", o.out_path, (unsigned long long)size);
+        return 1;
+    }
+
+    double step = (o.count > 1) ? (o.end - o.start) / (double)(o.count - 1) : 0;
+    double start_time = platform_time_seconds();
+
+    TrigTableJob jobs[TRIG_TABLE_MAX_THREADS];
+    pthread_t threads[TRIG_TABLE_MAX_THREADS];
+    bool started[TRIG_TABLE_MAX_THREADS];
+    for (int i = 0; i < o.thread_count; i++) {
+        uint64_t first = o.count * (uint64_t)i / (uint64_t)o.thread_count;
+        uint64_t last = o.count * (uint64_t)(i + 1) / (uint64_t)o.thread_count;
+        jobs[i] = (TrigTableJob) {
+            .options = &o,
+            .out = out.data,
+            .first = first,
+            .count = last - first,
+            .step = step,
+        };
+        // A slice without a thread is written by this one.
+        started[i] = pthread_create(&threads[i], NULL, trig_table_job_run, &jobs[i]) == 0;
+        if (!started[i]) {
+            trig_table_job_run(&jobs[i]);
+        }
+    }
+    for (int i = 0; i < o.thread_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    double compute_time = platform_time_seconds() - start_time;
+    platform_unmap_file(&out);
+    double total_time = platform_time_seconds() - start_time;
+
+    printf(
+        "%s %llu angles -> %s: %.3f GB in %.3fs (%.2f GB/s compute, %.2f GB/s including flush)\n",
+        trig_kind_names[o.kind],
+        (unsigned long long)o.count,
+        o.out_path,
+        (double)size * 1e-9,
+        total_time,
+        (double)size * 1e-9 / compute_time,
+        (double)size * 1e-9 / total_time
+    );
+    return 0;
+}
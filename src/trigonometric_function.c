@@ -1,66 +1,418 @@
 #include "main.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-#define TRIGONOMETRIC_FUNCTION_RESOLUTION 32
+#define TRIGONOMETRIC_FUNCTION_TICKS 4
+#define TRIGONOMETRIC_FUNCTION_MIN_SPAN 1e-12
+#define TRIGONOMETRIC_FUNCTION_MAX_SPAN 1e12
+
+float trigonometric_function_value_to_y(TrigonometricFunction *tf, float value) {
+    return tf->position.y - (value / (tf->range.max - tf->range.min) * tf->size.y) + (tf->size.y/2);
+}
+
+float trigonometric_function_domain_to_x(TrigonometricFunction *tf, double x) {
+    return tf->position.x + (float)((x - tf->domain.min) / (tf->domain.max - tf->domain.min)) * tf->size.x;
+}
+
+double trigonometric_function_x_to_domain(TrigonometricFunction *tf, float screen_x) {
+    double relative_x = (screen_x - tf->position.x) / tf->size.x;
+    return tf->domain.min + relative_x * (tf->domain.max - tf->domain.min);
+}
+
+float trigonometric_function_evaluate(TrigonometricFunction *tf, float x) {
+    if (tf->partial_sum != NULL) {
+        return partial_sum_evaluate(tf->partial_sum, x);
+    }
+    if (tf->expression != NULL) {
+        return expression_evaluate(tf->expression, x);
+    }
+    if (tf->evaluate_batch != NULL) {
+        float out;
+        tf->evaluate_batch(&x, &out, 1);
+        return out;
+    }
+    return tf->function(x);
+}
+
+void trigonometric_function_evaluate_batch(TrigonometricFunction *tf, const float *x, float *out, int count) {
+    if (tf->expression != NULL) {
+        expression_evaluate_batch(tf->expression, x, out, count);
+        return;
+    }
+    if (tf->evaluate_batch != NULL) {
+        tf->evaluate_batch(x, out, count);
+        return;
+    }
+    trig_evaluate_batch(tf->function, x, out, count);
+}
+
+static void trigonometric_function_evaluate_exact(void *user, const float *x, float *out, int count) {
+    trigonometric_function_evaluate_batch(user, x, out, count);
+}
+
+// Must be called whenever the function itself changes.
+void trigonometric_function_invalidate_approximation(TrigonometricFunction *tf) {
+    if (tf->approximation != NULL) {
+        tf->approximation->valid = false;
+    }
+    tf->dirty = true;
+}
+
+// Expressions and plugins are plotted from a Chebyshev fit to a quarter pixel
+// of the panel's range. The fit spans three times the visible domain, so
+// panning and zooming in reuse it. Built-in kernels are sampled directly,
+// partial sums come from their own cache.
+static void trigonometric_function_sample(TrigonometricFunction *tf, const float *x, float *out, int count) {
+    if (tf->partial_sum != NULL) {
+        partial_sum_sample(tf->partial_sum, x, out, count);
+        return;
+    }
+    if (tf->expression == NULL && tf->evaluate_batch == NULL) {
+        trigonometric_function_evaluate_batch(tf, x, out, count);
+        return;
+    }
+    float tolerance = (tf->range.max - tf->range.min) / tf->size.y * 0.25f;
+    if (tf->approximation == NULL) {
+        tf->approximation = calloc(1, sizeof(Chebyshev));
+    }
+    if (!chebyshev_covers(tf->approximation, tf->domain, tf->range, tolerance)) {
+        double span = tf->domain.max - tf->domain.min;
+        Domain domain = { tf->domain.min - span, tf->domain.max + span };
+        chebyshev_build(tf->approximation, domain, tf->range, tolerance, trigonometric_function_evaluate_exact, tf);
+    }
+    chebyshev_evaluate_batch(tf->approximation, x, out, count, trigonometric_function_evaluate_exact, tf);
+}
+
+// Takes ownership of a compiled expression, replacing the current one and
+// any partial sum the panel plotted instead.
+void trigonometric_function_set_expression(TrigonometricFunction *tf, Expression *expression) {
+    partial_sum_release(tf);
+    free(tf->expression);
+    tf->expression = expression;
+    trigonometric_function_invalidate_approximation(tf);
+}
+
+// Releases everything the panel owns.
+void trigonometric_function_free(TrigonometricFunction *tf) {
+    free(tf->expression);
+    free(tf->approximation);
+    implicit_plot_free(tf->implicit);
+    free(tf->approximant_plots);
+    free(tf->partial_sum);
+    tf->expression = NULL;
+    tf->approximation = NULL;
+    tf->implicit = NULL;
+    tf->approximant_plots = NULL;
+    tf->partial_sum = NULL;
+}
+
+// Curves are sampled at float positions, so the span is kept wide enough for
+// neighbouring samples to land on different floats. Around 0 that allows
+// tiny views, around 1e6 the narrowest is a few hundred radians.
+static void trigonometric_function_set_domain(TrigonometricFunction *tf, double min, double max) {
+    enum { MAX_STEPS = TRIGONOMETRIC_FUNCTION_SCREEN_COLUMNS * TRIGONOMETRIC_FUNCTION_SUBSAMPLES };
+    double center = (min + max) / 2;
+    double half_span = (max - min) / 2;
+    double min_half_span = fmax(fabs(center) * FLT_EPSILON * MAX_STEPS, TRIGONOMETRIC_FUNCTION_MIN_SPAN) / 2;
+    half_span = fmin(fmax(half_span, min_half_span), TRIGONOMETRIC_FUNCTION_MAX_SPAN / 2);
+    tf->domain = (Domain) {center - half_span, center + half_span};
+    tf->dirty = true;
+}
+
+void trigonometric_function_pan(TrigonometricFunction *tf, double fraction) {
+    double offset = (tf->domain.max - tf->domain.min) * fraction;
+    trigonometric_function_set_domain(tf, tf->domain.min + offset, tf->domain.max + offset);
+}
+
+// Scales the span by factor, keeping the domain value under anchor in place.
+void trigonometric_function_zoom_at(TrigonometricFunction *tf, double factor, double anchor) {
+    trigonometric_function_set_domain(tf, anchor + (tf->domain.min - anchor) * factor, anchor + (tf->domain.max - anchor) * factor);
+}
+
+void trigonometric_function_zoom(TrigonometricFunction *tf, double factor) {
+    trigonometric_function_zoom_at(tf, factor, (tf->domain.min + tf->domain.max) / 2);
+}
+
+void trigonometric_function_reset_domain(TrigonometricFunction *tf) {
+    tf->domain = (Domain) {0,PI*2};
+    tf->dirty = true;
+}
+
+// One registry entry per line: <name> <function> <range_min> <range_max> [rrggbb]
+// where <function> is sin, cos, tan, one of the fixed-point CORDIC kernels
+// (sin_q15, cos_q31, ...), a partial sum series (square_sum, sawtooth_sum,
+// triangle_sum, sin_taylor, cos_taylor) or a double-quoted expression of x.
+bool trigonometric_function_parse(TrigonometricFunction *tf, const char *line, Color default_color) {
+    char name[sizeof(tf->name)];
+    char function[EXPRESSION_MAX_SOURCE];
+    char color[16] = "";
+    float range_min, range_max;
+    int fields;
+    if (strchr(line, '"') != NULL) {
+        fields = sscanf(line, "%15s \"%127[^\"]\" %f %f %15s", name, function, &range_min, &range_max, color);
+    } else {
+        fields = sscanf(line, "%15s %127s %f %f %15s", name, function, &range_min, &range_max, color);
+    }
+    if (fields < 4 || range_min >= range_max) {
+        return false;
+    }
+    float (*f)(float) = trig_sin;
+    Expression *expression = NULL;
+    bool builtin = false;
+    for (int k = 0; k < TRIG_KIND_COUNT; k++) {
+        if (strcmp(function, trig_kind_names[k]) == 0) {
+            f = trig_functions[k];
+            builtin = true;
+        }
+    }
+    for (int k = 0; k < CORDIC_FUNCTION_COUNT; k++) {
+        if (strcmp(function, cordic_functions[k].name) == 0) {
+            f = cordic_functions[k].function;
+            builtin = true;
+        }
+    }
+    PartialSum *partial_sum = builtin ? NULL : partial_sum_create(function);
+    if (partial_sum != NULL) {
+        f = partial_sum->restore_function;
+        builtin = true;
+    }
+    if (!builtin) {
+        expression = malloc(sizeof(Expression));
+        const char *error = expression_compile(expression, function);
+        if (error != NULL) {
+            TraceLog(LOG_WARNING, "PANELS: \"%s\": %s", function, error);
+            free(expression);
+            return false;
+        }
+    }
+    *tf = (TrigonometricFunction) {
+        .function = f,
+        .expression = expression,
+        .partial_sum = partial_sum,
+        .range = (Range) {range_min,range_max},
+        .domain = (Domain) {0,PI*2},
+        .color = default_color,
+        .dirty = true,
+    };
+    memcpy(tf->name, name, sizeof(name));
+    unsigned int rgb;
+    if (color[0] != '\0' && sscanf(color, "%6x", &rgb) == 1) {
+        tf->color = (Color) {(rgb >> 16) & 0xff, (rgb >> 8) & 0xff, rgb & 0xff, 255};
+    }
+    return true;
+}
+
+// Resamples the clamped curve, only done when the panel is dirty. The panel
+// is split into columns a couple of pixels wide whatever the domain, so the
+// cost stays the same at any zoom; a poster's curve_scale makes them a couple
+// of its pixels wide. Each column keeps the extent of its
+// subsamples, which draws a function oscillating faster than the pixels as
+// the band it fills instead of an aliased line.
+static void trigonometric_function_update_curve(TrigonometricFunction *tf) {
+    enum { MAX_SAMPLES = TRIGONOMETRIC_FUNCTION_MAX_COLUMNS * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + 1 };
+    float scale = (tf->curve_scale > 1) ? tf->curve_scale : 1;
+    int max_columns = (int)fminf(TRIGONOMETRIC_FUNCTION_SCREEN_COLUMNS * scale, TRIGONOMETRIC_FUNCTION_MAX_COLUMNS);
+    int columns = (int)(tf->size.x * scale / TRIGONOMETRIC_FUNCTION_COLUMN_WIDTH);
+    columns = (columns > max_columns) ? max_columns : (columns < 1) ? 1 : columns;
+    int sample_count = columns * TRIGONOMETRIC_FUNCTION_SUBSAMPLES + 1;
+    double step = (tf->domain.max - tf->domain.min) / (sample_count - 1);
+    double first = tf->domain.min;
+    if (tf->partial_sum != NULL) {
+        // A pan keeps partial sums' cached samples if they stay on one grid:
+        // the step rounded to 12 bits, the first sample on a multiple of it.
+        int exponent;
+        frexp(step, &exponent);
+        step = ldexp(nearbyint(ldexp(step, 12 - exponent)), exponent - 12);
+        first = floor(tf->domain.min / step) * step;
+    }
+    float func_min = tf->position.y;
+    float func_max = (tf->position.y + tf->size.y);
+    float xs[MAX_SAMPLES];
+    float values[MAX_SAMPLES];
+    for (int j = 0; j < sample_count; j++) {
+        xs[j] = (float)(first + step*j);
+    }
+    trigonometric_function_sample(tf, xs, values, sample_count);
+    for (int j = 0; j < sample_count; j++) {
+        float y = trigonometric_function_value_to_y(tf, values[j]);
+        values[j] = fminf(fmaxf(y, func_min), func_max); // fmaxf drops a NaN, pinning it to the edge
+    }
+    // Built-in kernels repeat every 2pi, so a column spanning a period covers their range.
+    bool full_columns = tf->expression == NULL && tf->evaluate_batch == NULL && tf->partial_sum == NULL && step * TRIGONOMETRIC_FUNCTION_SUBSAMPLES >= PI*2;
+    for (int j = 0; j <= columns; j++) {
+        const float *column = values + j * TRIGONOMETRIC_FUNCTION_SUBSAMPLES;
+        tf->curve[j] = (Vector2) {trigonometric_function_domain_to_x(tf, first + step*TRIGONOMETRIC_FUNCTION_SUBSAMPLES*j), column[0]};
+        if (j == columns) {
+            break;
+        }
+        float top = column[0], bottom = column[0];
+        for (int k = 1; k <= TRIGONOMETRIC_FUNCTION_SUBSAMPLES; k++) {
+            top = fminf(top, column[k]);
+            bottom = fmaxf(bottom, column[k]);
+        }
+        tf->curve_top[j] = full_columns ? func_min : top;
+        tf->curve_bottom[j] = full_columns ? func_max : bottom;
+    }
+    tf->curve_count = columns;
+    tf->dirty = false;
+}
+
+// Grid step of about span/TRIGONOMETRIC_FUNCTION_TICKS from 1, 2, 5 times a
+// power of ten, or from fractions and multiples of pi while the view is a few
+// turns wide. Returns the step and sets *pi_denominator for pi steps (0 otherwise).
+static double trigonometric_function_tick_step(double span, int *pi_denominator) {
+    double raw = span / TRIGONOMETRIC_FUNCTION_TICKS;
+    *pi_denominator = 0;
+    if (raw >= PI/4 * 0.75 && raw <= PI * 4) {
+        static const int denominators[] = {4, 2, 1};
+        for (int i = 0; i < 3; i++) {
+            if (PI / denominators[i] >= raw * 0.75) {
+                *pi_denominator = denominators[i];
+                return PI / denominators[i];
+            }
+        }
+        *pi_denominator = 1;
+        return (raw <= PI * 2 * 1.5) ? PI * 2 : PI * 4;
+    }
+    double magnitude = pow(10, floor(log10(raw)));
+    double normalized = raw / magnitude;
+    double nice = (normalized < 1.5) ? 1 : (normalized < 3.5) ? 2 : (normalized < 7.5) ? 5 : 10;
+    return nice * magnitude;
+}
+
+// Labels as "3pi/2" for pi steps, otherwise with just enough significant
+// digits to tell neighbouring ticks apart.
+static const char *trigonometric_function_tick_label(double value, double step, int pi_denominator, double largest) {
+    if (pi_denominator != 0) {
+        long long n = llround(value / (PI / pi_denominator));
+        long long d = pi_denominator;
+        while (d > 1 && n % 2 == 0) {
+            n /= 2;
+            d /= 2;
+        }
+        if (n == 0) {
+            return "0";
+        }
+        const char *numerator = (n == 1) ? "pi" : (n == -1) ? "-pi" : TextFormat("%lldpi", n);
+        return (d == 1) ? numerator : TextFormat("%s/%lld", numerator, d);
+    }
+    if (fabs(value) < step / 2) {
+        return "0";
+    }
+    int digits = (int)floor(log10(largest)) - (int)floor(log10(step)) + 2;
+    digits = (digits < 1) ? 1 : (digits > 15) ? 15 : digits;
+    return TextFormat("%.*g", digits, value);
+}
+
+// Blocks until what the panel refines in the background is final, for
+// exports that draw it only once.
+void trigonometric_function_settle(TrigonometricFunction *tf) {
+    if (tf->expression == NULL || tf->expression->relation == EXPRESSION_RELATION_NONE) {
+        return;
+    }
+    if (tf->implicit == NULL) {
+        tf->implicit = implicit_plot_create();
+    }
+    implicit_plot_update(tf->implicit, tf);
+    implicit_plot_wait(tf->implicit);
+}
+
+// Relations have no value at the current angle, only the region or curve
+// and the name are drawn.
+static void trigonometric_function_draw_implicit(TrigonometricFunction *tf, Font *font) {
+    if (tf->implicit == NULL) {
+        tf->implicit = implicit_plot_create();
+    }
+    implicit_plot_update(tf->implicit, tf);
+    implicit_plot_draw(tf->implicit, tf);
+    tf->dirty = false;
+    draw_text_centered(
+        font,
+        layout.panel_compact ? TEXT_FLAG_NONE : TEXT_FLAG_LARGE,
+        (Vector2){tf->position.x + (tf->size.x/2), tf->position.y + (tf->size.y) + (layout.panel_compact ? layout.small_label_offset : layout.label_offset)},
+        0,
+        tf->name,
+        tf->color
+    );
+}
 
 void trigonometric_function_draw(TrigonometricFunction *tf, Font *font, float radians) {
-    DrawLine(
-        tf->position.x, tf->position.y + (tf->size.y/2),
-        tf->position.x + tf->size.x, tf->position.y + (tf->size.y/2),
+    render_line(
+        (Vector2){tf->position.x, tf->position.y + (tf->size.y/2)},
+        (Vector2){tf->position.x + tf->size.x, tf->position.y + (tf->size.y/2)},
+        LINE_SMALL,
+        MAIN_COL
+    );
+    render_line(
+        (Vector2){tf->position.x, tf->position.y},
+        (Vector2){tf->position.x, tf->position.y + (tf->size.y)},
+        LINE_SMALL,
         MAIN_COL
     );
-    const int vertical_line_count = 5;
-    for (int j = 0; j < vertical_line_count; j++) {
-        const float fract = (tf->size.x/(vertical_line_count-1));
-        float x = tf->position.x + (fract * j);
-        DrawLine(
-            x, tf->position.y,
-            x, tf->position.y + (tf->size.y),
+    render_line(
+        (Vector2){tf->position.x + tf->size.x, tf->position.y},
+        (Vector2){tf->position.x + tf->size.x, tf->position.y + (tf->size.y)},
+        LINE_SMALL,
+        MAIN_COL
+    );
+    int pi_denominator;
+    double step = trigonometric_function_tick_step(tf->domain.max - tf->domain.min, &pi_denominator);
+    double largest = fmax(fabs(tf->domain.min), fabs(tf->domain.max));
+    for (double k = ceil(tf->domain.min / step); k * step <= tf->domain.max; k++) {
+        double value = k * step;
+        float x = trigonometric_function_domain_to_x(tf, value);
+        render_line(
+            (Vector2){x, tf->position.y},
+            (Vector2){x, tf->position.y + (tf->size.y)},
+            LINE_SMALL,
             MAIN_COL
         );
-        Vector2 text_position = {x, tf->position.y - WINSIDE * 0.05};
-        float text_rotation = 315;
-        switch (j) {
-        case 0: draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, "0", MAIN_COL); break;
-        case 1: draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, "pi/2", MAIN_COL); break;
-        case 2: draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, "pi", MAIN_COL); break;
-        case 3: draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, "3pi/2", MAIN_COL); break;
-        case 4: draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, "2pi", MAIN_COL); break;
+        if (layout.panel_compact) {
+            continue;
         }
+        Vector2 text_position = {x, tf->position.y - layout.label_offset};
+        float text_rotation = 315;
+        draw_text_centered(font, TEXT_FLAG_NONE, text_position, text_rotation, trigonometric_function_tick_label(value, step, pi_denominator, largest), MAIN_COL);
+    }
+    if (tf->expression != NULL && tf->expression->relation != EXPRESSION_RELATION_NONE) {
+        trigonometric_function_draw_implicit(tf, font);
+        return;
+    }
+    if (tf->dirty) {
+        trigonometric_function_update_curve(tf);
     }
-    float x_fract = tf->size.x / TRIGONOMETRIC_FUNCTION_RESOLUTION;
-    float y_fract = PI*2/TRIGONOMETRIC_FUNCTION_RESOLUTION;
-    float half_height = (tf->size.y/2);
-    Vector2 prev = {
-        tf->position.x,
-        tf->position.y - (tf->function(0) / (tf->range.max - tf->range.min) * tf->size.y) + half_height,
-    };
     float func_min = tf->position.y;
     float func_max = (tf->position.y + tf->size.y);
-    for (int j = 0; j <= TRIGONOMETRIC_FUNCTION_RESOLUTION; j++) {
-        Vector2 next = {
-            tf->position.x + x_fract*j,
-            tf->position.y - (tf->function(y_fract*j) / (tf->range.max - tf->range.min) * tf->size.y) + half_height,
-        };
-        if (next.y < func_min) {
-            next.y = func_min;
-        } else if (next.y > func_max) {
-            next.y = func_max;
-        }
+    for (int j = 1; j <= tf->curve_count; j++) {
+        Vector2 prev = tf->curve[j-1];
+        Vector2 next = tf->curve[j];
         if ((prev.y != func_min && prev.y != func_max) ||
             (next.y != func_min && next.y != func_max)
         ) {
-            DrawLineEx(prev, next, LINE_BIG, tf->color);
+            render_line(prev, next, LINE_BIG, tf->color);
+        }
+        // Only columns that swing beyond the line get their extent drawn.
+        float top = tf->curve_top[j-1], bottom = tf->curve_bottom[j-1];
+        if (top < fminf(prev.y, next.y) - 1 || bottom > fmaxf(prev.y, next.y) + 1) {
+            float x = (prev.x + next.x) / 2;
+            render_line((Vector2){x, top}, (Vector2){x, bottom}, LINE_BIG, tf->color);
         }
-        prev = next;
     }
 
-    float current_rad_result = tf->function(radians);
+    float current_rad_result = trigonometric_function_evaluate(tf, radians);
     bool inside_bounds = (current_rad_result <= tf->range.max) && (current_rad_result >= tf->range.min);
+    double period = PI*2;
+    double marker_x = radians + (period * ceil((tf->domain.min - radians) / period));
+    bool inside_domain = marker_x <= tf->domain.max;
     Vector2 func_pos;
-    func_pos.x = tf->position.x + (tf->size.x) / PI / 2 * radians;
+    func_pos.x = inside_domain ? trigonometric_function_domain_to_x(tf, marker_x) : tf->position.x;
     if (inside_bounds) {
-        func_pos.y = tf->position.y - (current_rad_result / (tf->range.max - tf->range.min) * tf->size.y) + half_height;
-        DrawCircleV(func_pos, POINT_RADIUS, MAIN_COL);
+        func_pos.y = trigonometric_function_value_to_y(tf, current_rad_result);
+        if (inside_domain) {
+            render_circle(func_pos, POINT_RADIUS, MAIN_COL);
+        }
     } else {
         if (current_rad_result > 0) {
             func_pos.y = func_min;
@@ -68,15 +420,27 @@ void trigonometric_function_draw(TrigonometricFunction *tf, Font *font, float ra
             func_pos.y = func_max;
         }
     }
-    DrawLine(
-        tf->position.x, func_pos.y,
-        func_pos.x, func_pos.y,
+    render_line(
+        (Vector2){tf->position.x, func_pos.y},
+        (Vector2){func_pos.x, func_pos.y},
+        LINE_SMALL,
         MAIN_COL
     );
+    if (layout.panel_compact) {
+        draw_text_centered(
+            font,
+            TEXT_FLAG_NONE,
+            (Vector2){tf->position.x + (tf->size.x/2), tf->position.y + (tf->size.y) + layout.small_label_offset},
+            0,
+            tf->name,
+            tf->color
+        );
+        return;
+    }
     draw_text_centered(
         font,
         TEXT_FLAG_NONE,
-        (Vector2){tf->position.x - (WINSIDE * 0.05), func_pos.y},
+        (Vector2){tf->position.x - layout.label_offset, func_pos.y},
         0,
         inside_bounds ? TextFormat("%.2f", current_rad_result) : "??",
         tf->color
@@ -84,7 +448,7 @@ void trigonometric_function_draw(TrigonometricFunction *tf, Font *font, float ra
     draw_text_centered(
         font,
         TEXT_FLAG_LARGE,
-        (Vector2){tf->position.x + (tf->size.x/2), tf->position.y + (tf->size.y) + WINSIDE * 0.05},
+        (Vector2){tf->position.x + (tf->size.x/2), tf->position.y + (tf->size.y) + layout.label_offset},
         0,
         tf->name,
         tf->color
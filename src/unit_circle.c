@@ -1,19 +1,18 @@
 #include "main.h"
 
-#define QUADRANT_I_OFFSET 0
-#define QUADRANT_II_OFFSET (PI/2)
-#define QUADRANT_III_OFFSET PI
-#define QUADRANT_IV_OFFSET (PI*1.5)
+#define UNIT_CIRCLE_RESOLVE_BATCH 256
 
 void unit_circle_update_towards(UnitCircle *uc, Vector2 position) {
     const float adj = position.x - uc->center.x;
     const float opp = uc->center.y - position.y;
+    const float hyp = sqrtf(adj*adj + opp*opp);
+    // The center has no direction, keep the current angle.
+    if (hyp == 0) {
+        return;
+    }
 
-    const float hyp = sqrtf(powf(adj,2) + powf(opp,2));
-    const float hyp_normalize_factor = 1 / hyp;
-
-    uc->cos = adj * hyp_normalize_factor;
-    uc->sin = opp * hyp_normalize_factor;
+    uc->cos = adj / hyp;
+    uc->sin = opp / hyp;
     uc->tan = uc->sin / uc->cos;
 
     uc->point = (Vector2) {
@@ -21,29 +20,35 @@ void unit_circle_update_towards(UnitCircle *uc, Vector2 position) {
         uc->center.y - (uc->sin * uc->radius),
     };
 
-    const bool right = position.x > uc->center.x;
-    const bool top = position.y < uc->center.y;
+    uc->rad = trig_angle(opp, adj);
+    uc->deg = uc->rad * RAD2DEG;
+}
 
-    if (top) {
-        if (right) {
-            uc->rad = QUADRANT_I_OFFSET + asinf(opp/hyp);
-        } else {
-            uc->rad = QUADRANT_II_OFFSET + acosf(opp/hyp);
+// The angle unit_circle_update_towards would give each position, in
+// [0, 2pi), without touching the circle; the center resolves to 0.
+void unit_circle_resolve_batch(const UnitCircle *uc, const Vector2 *positions, float *rad, int count) {
+    float adj[UNIT_CIRCLE_RESOLVE_BATCH];
+    float opp[UNIT_CIRCLE_RESOLVE_BATCH];
+    for (int done = 0; done < count; done += UNIT_CIRCLE_RESOLVE_BATCH) {
+        int n = (count - done < UNIT_CIRCLE_RESOLVE_BATCH) ? count - done : UNIT_CIRCLE_RESOLVE_BATCH;
+        for (int i = 0; i < n; i++) {
+            adj[i] = positions[done + i].x - uc->center.x;
+            opp[i] = uc->center.y - positions[done + i].y;
         }
-    } else if (!right) {
-        uc->rad = QUADRANT_III_OFFSET + asinf(-(opp/hyp));
-    } else {
-        uc->rad = QUADRANT_IV_OFFSET + acosf(-(opp/hyp));
+        trig_angle_batch(opp, adj, rad + done, n);
     }
-
-    uc->deg = uc->rad * RAD2DEG;
 }
 
 void unit_circle_update_radians(UnitCircle *uc, float rad) {
+    if (rad < 0 || rad > PI*2) {
+        rad = fmodf(rad, PI*2);
+        if (rad < 0) {
+            rad += PI*2;
+        }
+    }
     uc->rad = rad;
-    uc->cos = cosf(rad);
-    uc->sin = sinf(rad);
-    uc->tan = tanf(rad);
+    trig_sincos(rad, &uc->sin, &uc->cos);
+    uc->tan = trig_tan(rad);
 
     uc->point = (Vector2) {
         uc->center.x + (uc->cos * uc->radius),
@@ -53,45 +58,71 @@ void unit_circle_update_radians(UnitCircle *uc, float rad) {
     uc->deg = uc->rad * RAD2DEG;
 }
 
-void unit_circle_draw_base(UnitCircle *uc) {
-    DrawCircleLinesV(uc->center, uc->radius, MAIN_COL);
-    DrawCircleSector(uc->center, uc->radius, 0, -uc->deg, uc->rad / 10, FILL_COL);
-    DrawCircleSectorLines(uc->center, uc->radius * 0.15 * 1.4, 0, -uc->deg, uc->rad / 10, MAIN_COL);
+// Like unit_circle_update_radians, but exact at 0, 30, 45, 60, 90... degrees.
+void unit_circle_update_degrees(UnitCircle *uc, float deg) {
+    deg = fmodf(deg, 360);
+    if (deg < 0) {
+        deg += 360;
+    }
+    uc->deg = deg;
+    uc->rad = deg * DEG2RAD;
+    trig_sincosd(deg, &uc->sin, &uc->cos);
+    uc->tan = trig_tand(deg);
+
+    uc->point = (Vector2) {
+        uc->center.x + (uc->cos * uc->radius),
+        uc->center.y - (uc->sin * uc->radius),
+    };
+}
+
+// The parts of the base that do not depend on the angle: circle and axes.
+void unit_circle_draw_outline(UnitCircle *uc) {
+    render_circle_lines(uc->center, uc->radius, MAIN_COL);
 
     Vector2 vertical_line_start = { uc->position.x, uc->center.y };
     Vector2 vertical_line_end = { uc->position.x + (uc->radius*2), uc->center.y };
-    DrawLineV(vertical_line_start, vertical_line_end, MAIN_COL);
+    render_line(vertical_line_start, vertical_line_end, LINE_SMALL, MAIN_COL);
 
     Vector2 horizontal_line_start = { uc->center.x, uc->position.y };
     Vector2 horizontal_line_end = { uc->center.x, uc->position.y + (uc->radius*2) };
-    DrawLineV(horizontal_line_start, horizontal_line_end, MAIN_COL);
+    render_line(horizontal_line_start, horizontal_line_end, LINE_SMALL, MAIN_COL);
+}
+
+void unit_circle_draw_sector(UnitCircle *uc) {
+    render_circle_sector(uc->center, uc->radius, 0, -uc->deg, uc->rad / 10, FILL_COL);
+    render_circle_sector_lines(uc->center, uc->radius * 0.15 * 1.4, 0, -uc->deg, uc->rad / 10, MAIN_COL);
+}
+
+void unit_circle_draw_base(UnitCircle *uc) {
+    unit_circle_draw_outline(uc);
+    unit_circle_draw_sector(uc);
 }
 
 void unit_circle_draw_triangle(UnitCircle *uc, Font *font) {
     Vector2 sin_corner = {uc->center.x, uc->point.y};
     Vector2 cos_corner = {uc->point.x, uc->center.y};
 
-    DrawLineEx(sin_corner, uc->point, LINE_SMALL, SIN_COL);
-    DrawLineEx(cos_corner, uc->point, LINE_SMALL, COS_COL);
+    render_line(sin_corner, uc->point, LINE_SMALL, SIN_COL);
+    render_line(cos_corner, uc->point, LINE_SMALL, COS_COL);
 
-    DrawLineEx(uc->center, uc->point, LINE_BIG, MAIN_COL);
-    DrawCircleV(uc->point, POINT_RADIUS, MAIN_COL);
+    render_line(uc->center, uc->point, LINE_BIG, MAIN_COL);
+    render_circle(uc->point, POINT_RADIUS, MAIN_COL);
 
-    DrawLineEx(uc->center, sin_corner, LINE_BIG, SIN_COL);
-    DrawCircleV(sin_corner, POINT_RADIUS, SIN_COL);
+    render_line(uc->center, sin_corner, LINE_BIG, SIN_COL);
+    render_circle(sin_corner, POINT_RADIUS, SIN_COL);
 
-    DrawLineEx(uc->center, cos_corner, LINE_BIG, COS_COL);
-    DrawCircleV(cos_corner, POINT_RADIUS, COS_COL);
+    render_line(uc->center, cos_corner, LINE_BIG, COS_COL);
+    render_circle(cos_corner, POINT_RADIUS, COS_COL);
 
-    const float trig_func_text_offset = 0.05f;
+    const float trig_func_text_offset = layout.label_offset;
     Vector2 sin_text_position = {
-        (uc->cos < 0) ? uc->center.x + (WINSIDE*trig_func_text_offset) : uc->center.x - (WINSIDE*trig_func_text_offset),
+        (uc->cos < 0) ? uc->center.x + trig_func_text_offset : uc->center.x - trig_func_text_offset,
         uc->center.y - (uc->sin * uc->radius),
     };
     draw_text_centered(font, TEXT_FLAG_BACKING_RECTANGLE, sin_text_position, 0, TextFormat("%.2f", uc->sin), SIN_COL);
     Vector2 cos_text_position = {
         uc->center.x + (uc->cos * uc->radius),
-        (uc->sin < 0) ? uc->center.y - (WINSIDE*trig_func_text_offset) : uc->center.y + (WINSIDE*trig_func_text_offset),
+        (uc->sin < 0) ? uc->center.y - trig_func_text_offset : uc->center.y + trig_func_text_offset,
     };
     draw_text_centered(font, TEXT_FLAG_BACKING_RECTANGLE, cos_text_position, 0, TextFormat("%.2f", uc->cos), COS_COL);
 }
@@ -100,9 +131,10 @@ void unit_circle_draw_angles_on_circumference(UnitCircle *uc, Font *font, float
     for (int i = 0; i < angle_count; i++) {
         float deg = angles[i];
         Vector2 dir = get_angle_direction(deg);
-        DrawLineV(
+        render_line(
             vec2_in_direction(uc->center, dir, 0.95f * uc->radius),
             vec2_in_direction(uc->center, dir, 1.05f * uc->radius),
+            LINE_SMALL,
             MAIN_COL
         );
         draw_text_centered(
@@ -117,7 +149,7 @@ void unit_circle_draw_angles_on_circumference(UnitCircle *uc, Font *font, float
 }
 
 void unit_circle_draw_quadrants(UnitCircle *uc, Font *font) {
-    float offset = (WINSIDE * 0.05);
+    float offset = layout.label_offset;
     float x = uc->position.x - offset;
     float y = uc->position.y - offset;
     float o = (uc->radius * 2) + (offset * 2);
@@ -134,20 +166,20 @@ void unit_circle_draw_right_angle(UnitCircle *uc) {
     Vector2 right_angle_offset;
     if (uc->deg > low_offset && uc->deg < high_offset) {
         Vector2 v = { uc->point.x - offset, uc->center.y - offset };
-        DrawLine(v.x, v.y, uc->point.x, v.y, MAIN_COL);
-        DrawLine(v.x, v.y, v.x, uc->center.y, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){uc->point.x, v.y}, LINE_SMALL, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){v.x, uc->center.y}, LINE_SMALL, MAIN_COL);
     } else if (uc->deg > (low_offset+90) && uc->deg < (high_offset+90)) {
         Vector2 v = { uc->center.x - offset, uc->point.y + offset };
-        DrawLine(v.x, v.y, uc->center.x, v.y, MAIN_COL);
-        DrawLine(v.x, v.y, v.x, uc->point.y, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){uc->center.x, v.y}, LINE_SMALL, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){v.x, uc->point.y}, LINE_SMALL, MAIN_COL);
     } else if (uc->deg > (180+low_offset) && uc->deg < (180+high_offset)) {
         Vector2 v = { uc->point.x + offset, uc->center.y + offset };
-        DrawLine(v.x, v.y, uc->point.x, v.y, MAIN_COL);
-        DrawLine(v.x, v.y, v.x, uc->center.y, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){uc->point.x, v.y}, LINE_SMALL, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){v.x, uc->center.y}, LINE_SMALL, MAIN_COL);
     } else if (uc->deg > (270+low_offset) && uc->deg < (270+high_offset)) {
         Vector2 v = { uc->center.x + offset, uc->point.y - offset };
-        DrawLine(v.x, v.y, uc->center.x, v.y, MAIN_COL);
-        DrawLine(v.x, v.y, v.x, uc->point.y, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){uc->center.x, v.y}, LINE_SMALL, MAIN_COL);
+        render_line((Vector2){v.x, v.y}, (Vector2){v.x, uc->point.y}, LINE_SMALL, MAIN_COL);
     }
 }
 
@@ -156,11 +188,11 @@ void unit_circle_draw_tan(UnitCircle *uc, Font *font) {
         uc->point.x + (uc->tan * uc->radius * uc->sin),
         uc->center.y
     };
-    DrawLineEx(uc->point, tan_outer_pos, LINE_BIG, TAN_COL);
-    DrawCircleV(tan_outer_pos, POINT_RADIUS, TAN_COL);
+    render_line(uc->point, tan_outer_pos, LINE_BIG, TAN_COL);
+    render_circle(tan_outer_pos, POINT_RADIUS, TAN_COL);
     Vector2 text_pos;
-    const float inner_padding = WINSIDE * 0.1;
-    const float outer_padding = WINSIDE * 0.05;
+    const float inner_padding = layout.tan_inner_padding;
+    const float outer_padding = layout.label_offset;
     if (tan_outer_pos.x < outer_padding) {
         text_pos.x = outer_padding;
     } else if (
@@ -173,12 +205,12 @@ void unit_circle_draw_tan(UnitCircle *uc, Font *font) {
         tan_outer_pos.x < (uc->center.x + uc->radius + inner_padding)
     ) {
         text_pos.x = (uc->center.x + uc->radius + inner_padding);
-    } else if (tan_outer_pos.x > (WINSIDE - outer_padding)) {
-        text_pos.x = (WINSIDE - outer_padding);
+    } else if (tan_outer_pos.x > (layout.width - outer_padding)) {
+        text_pos.x = (layout.width - outer_padding);
     } else {
         text_pos.x = tan_outer_pos.x;
     }
-    const float vertical_padding = WINSIDE * 0.05;
+    const float vertical_padding = layout.label_offset;
     if (uc->deg <= 180) {
         text_pos.y = tan_outer_pos.y + vertical_padding;
     } else {
@@ -192,4 +224,34 @@ void unit_circle_draw_tan(UnitCircle *uc, Font *font) {
         (uc->tan > -100) && (uc->tan < 100) ? TextFormat("%.2f", uc->tan) : "??",
         TAN_COL
     );
-}
\ No newline at end of file
+}
+
+// The micro-rotations of the Q31 CORDIC engine for the current angle, the
+// first `steps` of them: each vector from the center, brighter as they
+// converge on the point, and how far the last one still is off.
+void unit_circle_draw_cordic(UnitCircle *uc, Font *font, int steps) {
+    int32_t trace[CORDIC_Q31_ITERATIONS + 1][2];
+    int count = cordic_trace_q31(cordic_angle_q31_from_radians(uc->rad), steps, trace);
+    float scale = uc->radius / (float)(1 << 30);
+    Vector2 prev = uc->center;
+    for (int i = 0; i <= count; i++) {
+        Vector2 next = {uc->center.x + trace[i][0] * scale, uc->center.y - trace[i][1] * scale};
+        Color color = ColorAlpha(APPROXIMANT_COL, 0.25f + 0.75f * i / count);
+        render_line(uc->center, next, LINE_SMALL, color);
+        if (i > 0) {
+            render_line(prev, next, LINE_SMALL * 2, color);
+        }
+        render_circle(next, POINT_RADIUS / 3.0f, color);
+        prev = next;
+    }
+    double error = atan2((double)trace[count][1], (double)trace[count][0]) - uc->rad;
+    error = fabs(remainder(error, 2 * PI)) * RAD2DEG;
+    draw_text_centered(
+        font,
+        TEXT_FLAG_BACKING_RECTANGLE,
+        (Vector2){uc->center.x, uc->center.y + uc->radius * 1.4f},
+        0,
+        TextFormat("cordic q31 %d/%d: off by %.2g deg", count, CORDIC_Q31_ITERATIONS, error),
+        APPROXIMANT_COL
+    );
+}
@@ -0,0 +1,360 @@
+#include "main.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../raylib/include/rlgl.h"
+
+// Frames are rendered into one render texture and read back through two
+// pixel pack buffers: each frame starts an asynchronous glReadPixels into
+// one buffer and maps the other, filled the frame before, whose transfer has
+// had a whole frame to finish. The pixels are copied into a fixed ring of
+// frame buffers that a writer thread converts and streams, so the render
+// thread never formats or writes pixels itself. Without pixel pack buffers
+// (OpenGL 1.1, ES 2.0) the texture is read back synchronously instead.
+//
+// Every recorded frame is VIDEO_FPS-th of a second of animation, whatever
+// the frame actually took, see video_recorder_frame_time.
+
+#define VIDEO_QUEUE_SIZE 4
+#define VIDEO_FPS 60
+#define VIDEO_GL_PIXEL_PACK_BUFFER 0x88eb
+#define VIDEO_GL_STREAM_READ 0x88e1
+#define VIDEO_GL_READ_ONLY 0x88b8
+#define VIDEO_GL_RGBA 0x1908
+#define VIDEO_GL_UNSIGNED_BYTE 0x1401
+
+#if defined(_WIN32) && !defined(_WIN64)
+    #define VIDEO_GL_API __stdcall
+#else
+    #define VIDEO_GL_API
+#endif
+
+// raylib links GLFW in but does not export the buffer entry points, so they
+// are looked up the way raylib loads its own.
+typedef void (*VideoGlProc)(void);
+VideoGlProc glfwGetProcAddress(const char *name);
+
+typedef struct VideoPixelPack {
+    void (VIDEO_GL_API *gen_buffers)(int count, unsigned int *buffers);
+    void (VIDEO_GL_API *delete_buffers)(int count, const unsigned int *buffers);
+    void (VIDEO_GL_API *bind_buffer)(unsigned int target, unsigned int buffer);
+    void (VIDEO_GL_API *buffer_data)(unsigned int target, ptrdiff_t size, const void *data, unsigned int usage);
+    void (VIDEO_GL_API *read_pixels)(int x, int y, int width, int height, unsigned int format, unsigned int type, void *pixels);
+    void *(VIDEO_GL_API *map_buffer)(unsigned int target, unsigned int access);
+    unsigned char (VIDEO_GL_API *unmap_buffer)(unsigned int target);
+    unsigned int buffers[2]; // 0 when pixel pack buffers are unavailable
+} VideoPixelPack;
+
+typedef enum VideoFormat {
+    VIDEO_FORMAT_Y4M,
+    VIDEO_FORMAT_RGB,
+} VideoFormat;
+
+typedef struct VideoRecorder {
+    bool recording;
+    FILE *out;
+    bool is_pipe;
+    VideoFormat format;
+    int width;
+    int height;
+    float scale;
+    RenderTexture2D target;
+    VideoPixelPack pack;
+    uint64_t frame;
+    uint64_t queued; // frames handed to the writer
+    uint64_t repeated; // frames that could not be read back, written as the one before
+    unsigned char *frames[VIDEO_QUEUE_SIZE]; // rgba, reused; the writer owns the queued ones
+    int queue_head;
+    int queue_count;
+    uint64_t queue_stalls;
+    bool stopping;
+    pthread_t writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    unsigned char *scratch;
+    double start_time;
+} VideoRecorder;
+
+// Render texture rows are stored bottom-up, so rows are flipped while converting.
+static void video_write_frame(VideoRecorder *vr, const unsigned char *rgba) {
+    int w = vr->width;
+    int h = vr->height;
+    if (vr->format == VIDEO_FORMAT_RGB) {
+        for (int y = 0; y < h; y++) {
+            const unsigned char *src = rgba + (size_t)(h - 1 - y) * w * 4;
+            unsigned char *dst = vr->scratch + (size_t)y * w * 3;
+            for (int x = 0; x < w; x++) {
+                dst[x*3+0] = src[x*4+0];
+                dst[x*3+1] = src[x*4+1];
+                dst[x*3+2] = src[x*4+2];
+            }
+        }
+        fwrite(vr->scratch, 1, (size_t)w * h * 3, vr->out);
+        return;
+    }
+
+    // BT.601 limited range, 4:2:0 with chroma averaged over each 2x2 block.
+    unsigned char *plane_y = vr->scratch;
+    unsigned char *plane_u = plane_y + (size_t)w * h;
+    unsigned char *plane_v = plane_u + (size_t)(w/2) * (h/2);
+    for (int y = 0; y < h; y++) {
+        const unsigned char *src = rgba + (size_t)(h - 1 - y) * w * 4;
+        unsigned char *dst = plane_y + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            int r = src[x*4+0], g = src[x*4+1], b = src[x*4+2];
+            dst[x] = (unsigned char)(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+        }
+    }
+    for (int y = 0; y < h/2; y++) {
+        const unsigned char *row0 = rgba + (size_t)(h - 1 - y*2) * w * 4;
+        const unsigned char *row1 = rgba + (size_t)(h - 2 - y*2) * w * 4;
+        for (int x = 0; x < w/2; x++) {
+            int r = row0[x*8+0] + row0[x*8+4] + row1[x*8+0] + row1[x*8+4];
+            int g = row0[x*8+1] + row0[x*8+5] + row1[x*8+1] + row1[x*8+5];
+            int b = row0[x*8+2] + row0[x*8+6] + row1[x*8+2] + row1[x*8+6];
+            plane_u[(size_t)y * (w/2) + x] = (unsigned char)(((-38*r - 74*g + 112*b + 512) >> 10) + 128);
+            plane_v[(size_t)y * (w/2) + x] = (unsigned char)(((112*r - 94*g - 18*b + 512) >> 10) + 128);
+        }
+    }
+    fputs("FRAME\n", vr->out);
+    fwrite(vr->scratch, 1, (size_t)w * h + (size_t)(w/2) * (h/2) * 2, vr->out);
+}
+
+// Frames stay queued while they are written, so the render thread never
+// refills a buffer the writer still reads.
+static void *video_writer(void *arg) {
+    VideoRecorder *vr = arg;
+    pthread_mutex_lock(&vr->mutex);
+    while (true) {
+        while (vr->queue_count == 0 && !vr->stopping) {
+            pthread_cond_wait(&vr->not_empty, &vr->mutex);
+        }
+        if (vr->queue_count == 0) {
+            break;
+        }
+        unsigned char *pixels = vr->frames[vr->queue_head];
+        pthread_mutex_unlock(&vr->mutex);
+
+        video_write_frame(vr, pixels);
+
+        pthread_mutex_lock(&vr->mutex);
+        vr->queue_head = (vr->queue_head + 1) % VIDEO_QUEUE_SIZE;
+        vr->queue_count--;
+        pthread_cond_signal(&vr->not_full);
+    }
+    pthread_mutex_unlock(&vr->mutex);
+    return NULL;
+}
+
+// Copies a frame into the next free buffer of the ring and queues it. A
+// frame that could not be read back (NULL) repeats the one before, so the
+// video keeps its timing.
+static void video_enqueue(VideoRecorder *vr, const unsigned char *pixels) {
+    size_t size = (size_t)vr->width * vr->height * 4;
+    pthread_mutex_lock(&vr->mutex);
+    if (vr->queue_count == VIDEO_QUEUE_SIZE) {
+        vr->queue_stalls++;
+        while (vr->queue_count == VIDEO_QUEUE_SIZE) {
+            pthread_cond_wait(&vr->not_full, &vr->mutex);
+        }
+    }
+    int slot = (vr->queue_head + vr->queue_count) % VIDEO_QUEUE_SIZE;
+    pthread_mutex_unlock(&vr->mutex);
+
+    if (pixels == NULL) {
+        vr->repeated++;
+        if (vr->queued == 0) {
+            return;
+        }
+        // The previous slot is only read by the writer meanwhile.
+        pixels = vr->frames[(slot + VIDEO_QUEUE_SIZE - 1) % VIDEO_QUEUE_SIZE];
+    }
+    memcpy(vr->frames[slot], pixels, size);
+
+    pthread_mutex_lock(&vr->mutex);
+    vr->queue_count++;
+    vr->queued++;
+    pthread_cond_signal(&vr->not_empty);
+    pthread_mutex_unlock(&vr->mutex);
+}
+
+static bool video_pixel_pack_init(VideoPixelPack *pack, size_t size) {
+    memset(pack, 0, sizeof(*pack));
+    int version = rlGetVersion();
+    if (version == RL_OPENGL_11 || version == RL_OPENGL_ES_20) {
+        return false;
+    }
+    pack->gen_buffers = (void (VIDEO_GL_API *)(int, unsigned int *))glfwGetProcAddress("glGenBuffers");
+    pack->delete_buffers = (void (VIDEO_GL_API *)(int, const unsigned int *))glfwGetProcAddress("glDeleteBuffers");
+    pack->bind_buffer = (void (VIDEO_GL_API *)(unsigned int, unsigned int))glfwGetProcAddress("glBindBuffer");
+    pack->buffer_data = (void (VIDEO_GL_API *)(unsigned int, ptrdiff_t, const void *, unsigned int))glfwGetProcAddress("glBufferData");
+    pack->read_pixels = (void (VIDEO_GL_API *)(int, int, int, int, unsigned int, unsigned int, void *))glfwGetProcAddress("glReadPixels");
+    pack->map_buffer = (void *(VIDEO_GL_API *)(unsigned int, unsigned int))glfwGetProcAddress("glMapBuffer");
+    pack->unmap_buffer = (unsigned char (VIDEO_GL_API *)(unsigned int))glfwGetProcAddress("glUnmapBuffer");
+    if (pack->gen_buffers == NULL || pack->delete_buffers == NULL || pack->bind_buffer == NULL || pack->buffer_data == NULL ||
+        pack->read_pixels == NULL || pack->map_buffer == NULL || pack->unmap_buffer == NULL) {
+        return false;
+    }
+    pack->gen_buffers(2, pack->buffers);
+    for (int i = 0; i < 2; i++) {
+        pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, pack->buffers[i]);
+        pack->buffer_data(VIDEO_GL_PIXEL_PACK_BUFFER, (ptrdiff_t)size, NULL, VIDEO_GL_STREAM_READ);
+    }
+    pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+// Queues the pixels pack buffer i received a frame ago.
+static void video_map_pack(VideoRecorder *vr, int i) {
+    VideoPixelPack *pack = &vr->pack;
+    pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, pack->buffers[i]);
+    const unsigned char *pixels = pack->map_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, VIDEO_GL_READ_ONLY);
+    video_enqueue(vr, pixels);
+    if (pixels != NULL) {
+        pack->unmap_buffer(VIDEO_GL_PIXEL_PACK_BUFFER);
+    }
+    pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, 0);
+}
+
+// Starts reading back the frame just drawn and queues the one before.
+static void video_read_back(VideoRecorder *vr) {
+    VideoPixelPack *pack = &vr->pack;
+    if (pack->buffers[0] == 0) {
+        Texture2D texture = vr->target.texture;
+        unsigned char *pixels = rlReadTexturePixels(texture.id, texture.width, texture.height, texture.format);
+        video_enqueue(vr, pixels);
+        RL_FREE(pixels);
+        return;
+    }
+    int current = (int)(vr->frame % 2);
+    rlEnableFramebuffer(vr->target.id);
+    pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, pack->buffers[current]);
+    pack->read_pixels(0, 0, vr->width, vr->height, VIDEO_GL_RGBA, VIDEO_GL_UNSIGNED_BYTE, NULL);
+    pack->bind_buffer(VIDEO_GL_PIXEL_PACK_BUFFER, 0);
+    rlDisableFramebuffer();
+    if (vr->frame > 0) {
+        video_map_pack(vr, 1 - current);
+    }
+}
+
+// Frees whatever video_recorder_start got, the writer already stopped.
+static void video_recorder_release(VideoRecorder *vr) {
+    if (vr->out != NULL) {
+        platform_close_output(vr->out, vr->is_pipe);
+    }
+    if (vr->pack.buffers[0] != 0) {
+        vr->pack.delete_buffers(2, vr->pack.buffers);
+    }
+    if (vr->target.id != 0) {
+        UnloadRenderTexture(vr->target);
+    }
+    for (int i = 0; i < VIDEO_QUEUE_SIZE; i++) {
+        free(vr->frames[i]);
+    }
+    free(vr->scratch);
+    pthread_cond_destroy(&vr->not_full);
+    pthread_cond_destroy(&vr->not_empty);
+    pthread_mutex_destroy(&vr->mutex);
+    memset(vr, 0, sizeof(*vr));
+}
+
+// path ending in ".y4m" records YUV4MPEG2, anything else raw rgb24.
+// A path starting with '|' is a command the frames are piped into.
+bool video_recorder_start(VideoRecorder *vr, const char *path, float scale) {
+    memset(vr, 0, sizeof(*vr));
+    vr->scale = scale;
+    vr->width = ((int)(layout.width * scale)) & ~1;
+    vr->height = ((int)(layout.height * scale)) & ~1;
+    const char *extension = strrchr(path, '.');
+    vr->format = (extension != NULL && strcmp(extension, ".y4m") == 0) ? VIDEO_FORMAT_Y4M : VIDEO_FORMAT_RGB;
+    vr->out = platform_open_output(path, &vr->is_pipe);
+    if (vr->out == NULL) {
+        TraceLog(LOG_WARNING, "VIDEO: Failed to open [%s]", path);
+        return false;
+    }
+    if (vr->format == VIDEO_FORMAT_Y4M) {
+        fprintf(vr->out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", vr->width, vr->height, VIDEO_FPS);
+    }
+    pthread_mutex_init(&vr->mutex, NULL);
+    pthread_cond_init(&vr->not_empty, NULL);
+    pthread_cond_init(&vr->not_full, NULL);
+    size_t frame_size = (size_t)vr->width * vr->height * 4;
+    vr->target = LoadRenderTexture(vr->width, vr->height);
+    vr->scratch = malloc((size_t)vr->width * vr->height * 3);
+    bool allocated = vr->target.id != 0 && vr->scratch != NULL;
+    for (int i = 0; i < VIDEO_QUEUE_SIZE; i++) {
+        vr->frames[i] = malloc(frame_size);
+        allocated = allocated && vr->frames[i] != NULL;
+    }
+    if (!allocated || pthread_create(&vr->writer, NULL, video_writer, vr) != 0) {
+        TraceLog(LOG_WARNING, "VIDEO: Failed to set up %dx%d recording to [%s]", vr->width, vr->height, path);
+        video_recorder_release(vr);
+        return false;
+    }
+    bool packed = video_pixel_pack_init(&vr->pack, frame_size);
+    vr->start_time = GetTime();
+    vr->recording = true;
+    TraceLog(LOG_INFO, "VIDEO: Recording %dx%d to [%s]%s", vr->width, vr->height, path, packed ? "" : ", reading back synchronously");
+    return true;
+}
+
+// How far the animation moves this frame: the frame's own time, or one video
+// frame while recording, so the file plays at the speed of the scene even
+// when rendering it is slower than VIDEO_FPS.
+float video_recorder_frame_time(const VideoRecorder *vr, float frame_time) {
+    return vr->recording ? 1.0f / VIDEO_FPS : frame_time;
+}
+
+void video_recorder_begin_frame(VideoRecorder *vr) {
+    BeginTextureMode(vr->target);
+    ClearBackground(BLACK);
+    BeginMode2D((Camera2D){ .zoom = vr->scale });
+}
+
+void video_recorder_end_frame(VideoRecorder *vr) {
+    EndMode2D();
+    EndTextureMode();
+    video_read_back(vr);
+    vr->frame++;
+}
+
+// Shows the frame just recorded in the window, scaled to fit.
+void video_recorder_draw(VideoRecorder *vr) {
+    Texture2D texture = vr->target.texture;
+    DrawTexturePro(
+        texture,
+        (Rectangle){0, 0, (float)texture.width, -(float)texture.height},
+        (Rectangle){0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()},
+        (Vector2){0, 0},
+        0,
+        WHITE
+    );
+}
+
+void video_recorder_stop(VideoRecorder *vr) {
+    if (!vr->recording) {
+        return;
+    }
+    if (vr->frame > 0 && vr->pack.buffers[0] != 0) {
+        video_map_pack(vr, (int)((vr->frame - 1) % 2));
+    }
+    pthread_mutex_lock(&vr->mutex);
+    vr->stopping = true;
+    pthread_cond_signal(&vr->not_empty);
+    pthread_mutex_unlock(&vr->mutex);
+    pthread_join(vr->writer, NULL);
+
+    double seconds = GetTime() - vr->start_time;
+    TraceLog(
+        LOG_INFO,
+        "VIDEO: %llu frames in %.2fs (%.1f fps), %llu repeated, writer stalled %llu times",
+        (unsigned long long)vr->queued,
+        seconds,
+        vr->frame / seconds,
+        (unsigned long long)vr->repeated,
+        (unsigned long long)vr->queue_stalls
+    );
+    video_recorder_release(vr);
+}
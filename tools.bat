@@ -0,0 +1,39 @@
+@echo off
+setlocal enabledelayedexpansion
+
+rem Builds the headless command line tools into ./build/ and the plugins in
+rem ./plugins/ into ./build/plugins/, where the visualizer loads them from.
+
+if not exist "build\plugins\" (
+    mkdir "build\plugins"
+)
+
+for %%t in (trig_table trig_audit cordic_check angle_bench) do (
+    gcc ^
+        ./src/%%t.c ^
+        -o./build/%%t.exe ^
+        -O2 ^
+        -Wall ^
+        -Wextra ^
+        -lpthread
+    if not !errorlevel! equ 0 (
+        echo compilation of %%t.exe failed
+        goto :end
+    )
+)
+
+for %%p in (plugins\*.c) do (
+    gcc ^
+        %%p ^
+        -o./build/plugins/%%~np.dll ^
+        -shared ^
+        -O2 ^
+        -Wall ^
+        -Wextra
+    if not !errorlevel! equ 0 (
+        echo compilation of %%~np.dll failed
+        goto :end
+    )
+)
+
+:end
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Builds the headless command line tools into ./build/ and the plugins in
+# ./plugins/ into ./build/plugins/, where the visualizer loads them from.
+
+set -e
+
+mkdir -p build/plugins
+
+for TOOL in trig_table trig_audit cordic_check angle_bench; do
+    gcc \
+        ./src/$TOOL.c \
+        -o ./build/$TOOL \
+        -O2 \
+        -Wall \
+        -Wextra \
+        -lm \
+        -lpthread
+done
+
+for PLUGIN in ./plugins/*.c; do
+    gcc \
+        $PLUGIN \
+        -o ./build/plugins/$(basename $PLUGIN .c).so \
+        -shared \
+        -fPIC \
+        -O2 \
+        -Wall \
+        -Wextra \
+        -lm
+done